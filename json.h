@@ -25,6 +25,14 @@ QUICK:
     the query functions
     #define JSON_DELIMITER (character) before including this file
 
+    The structural scanner uses SSE2, AVX2 or NEON when the compiler
+    targets them. To force the portable scalar classifier
+    #define JSON_NO_SIMD before including this file
+
+    `json_load` keeps JSON_PARSER_DEPTH levels of its stack inside the
+    parser and grows it through the arena hooks for deeper documents
+    #define JSON_PARSER_DEPTH (levels) before including this file
+
 USAGE:
     This file behaves differently depending on what symbols you define
     before including it.
@@ -53,6 +61,62 @@ EXAMPLES:*/
     while (json_load(&p, json, len))
         p.toks = realloc(p.toks, (size_t)p.cap * sizeof(struct json_token));
 
+    /* or: take tokens from an arena and reuse them for every message */
+    struct json_parser q;
+    json_parser_init(&q, arena_alloc, arena_grow, &arena);
+    json_load(&q, msg, msg_len);
+    json_parser_reset(&q);
+    json_load(&q, next, next_len);
+
+    /* or: single linear pass without re-scanning nested objects */
+    while (json_load_tape(&p, json, len))
+        p.toks = realloc(p.toks, (size_t)p.cap * sizeof(struct json_token));
+
+    /* or: count tokens first so the token array is allocated exactly once */
+    while (json_load_exact(&p, json, len))
+        p.toks = realloc(p.toks, (size_t)p.cap * sizeof(struct json_token));
+
+    /* or: classify structure with SIMD first and build tokens in one pass */
+    int n = json_index(NULL, 0, json, len);
+    int *idx = malloc((size_t)n * sizeof(int));
+    json_index(idx, n, json, len);
+    while (json_load_index(&p, json, len, idx, n))
+        p.toks = realloc(p.toks, (size_t)p.cap * sizeof(struct json_token));
+
+    /* or: push parser for input arriving in chunks (socket, mmap window) */
+    struct json_stream s;
+    json_stream_begin(&s, on_token, userdata);
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0)
+        if (json_stream_feed(&s, chunk, n)) break;
+    json_stream_end(&s);
+
+    /* or: newline delimited records, each with its own range of tokens */
+    struct json_lines l = {0};
+    while (json_load_lines(&l, json, len)) {
+        l.recs = realloc(l.recs, (size_t)l.cap * sizeof(struct json_record));
+        l.toks = realloc(l.toks, (size_t)l.size * sizeof(struct json_token));
+    }
+    json_query(l.recs[0].toks, l.recs[0].cnt, "map.entity[4]");
+
+    /* or: 16 byte tokens holding offsets, for large documents */
+    struct json_compact c = {0};
+    while (json_load_compact(&c, json, len))
+        c.toks = realloc(c.toks, (size_t)c.cap * sizeof(struct json_ctoken));
+    json_compact_query(&c, c.toks, c.cnt, "map.entity[4]");
+
+    /* or: tokenize one large document on a thread pool */
+    static struct json_chunk parts[8];
+    while (json_load_parallel(&p, json, len, parts, 8, run_on_pool, pool))
+        p.toks = realloc(p.toks, (size_t)p.cap * sizeof(struct json_token));
+
+    /* or: pull a few fields without tokenizing the rest of the document */
+    struct json_cursor cur;
+    struct json_token val;
+    char name[64];
+    json_cursor_begin(&cur, json, len);
+    if (json_cursor_query(&cur, &val, "map.entity[4].name"))
+        json_cpy(name, 64, &val);
+
     /* query token */
     struct json_token *t0 = json_query(p.toks, p.cnt, "map.entity[4].position");
 
@@ -68,6 +132,26 @@ EXAMPLES:*/
     /* query type */
     int type0 = json_query_number(p.toks, p.cnt, "map.soldier[2]");
 
+    /* hashed index for repeated queries on the same document */
+    struct json_map map;
+    int size = json_map_size(p.toks, p.cnt);
+    int *mem = malloc((size_t)size * sizeof(int));
+    json_map_build(&map, p.toks, p.cnt, mem, size);
+    json_map_query_number(&num, &map, "map.entity[4].position.x");
+    struct json_token *pos = json_map_find(&map, t0, "x", 1);
+
+    /* compile a path once and reuse it across documents */
+    struct json_path path;
+    json_path_compile(&path, "map.entity[4].position.x");
+    json_query_compiled_number(&num, p.toks, p.cnt, &path);
+
+    /* resolve many compiled paths in one sweep over the tokens */
+    struct json_path fields[2];
+    struct json_token *values[2];
+    json_path_compile(&fields[0], "map.entity[4].name");
+    json_path_compile(&fields[1], "map.soldier[2].position.x");
+    json_query_many(values, p.toks, p.cnt, fields, 2);
+
     /* sub-queries */
     json_token *entity = json_query(p.toks, p.cnt, "map.entity[4]");
     json_token *position = json_query(entity, entity->sub, "position");
@@ -99,6 +183,30 @@ EXAMPLES:*/
         struct json_token *pos = json_query(ent, ent->sub, "position");
         /*... */
         ent = json_array_next(ent);}
+
+    /* write JSON through a small buffer flushed into a file */
+    char out[4096];
+    struct json_writer w;
+    json_write_begin(&w, out, sizeof(out), write_file, fp);
+    json_write_object(&w);
+    json_write_key(&w, "position", 8);
+    json_write_token(&w, position);
+    json_write_key(&w, "x", 1);
+    json_write_number(&w, num);
+    json_write_close(&w);
+    json_write_end(&w);
+
+    /* decode objects straight into structs */
+    struct soldier {json_int id; char name[32]; int alive;};
+    static const struct json_field fields[] = {
+        {"id", offsetof(struct soldier, id), JSON_FIELD_INT, 0, NULL},
+        {"name", offsetof(struct soldier, name), JSON_FIELD_STRING, 32, NULL},
+        {"alive", offsetof(struct soldier, alive), JSON_FIELD_BOOL, 0, NULL}};
+    struct json_schema schema;
+    struct soldier s = {0};
+    json_schema_build(&schema, fields, 3);
+    struct json_token *obj = json_query(p.toks, p.cnt, "map.soldier[2]");
+    json_decode_struct(&s, &schema, obj, obj->sub + 1);
     }
 #endif
 
@@ -124,6 +232,21 @@ extern "C" {
                                 INTERNAL
   -------------------------------------------------------------------------*/
 typedef double json_number;
+/* 64-bit integers, JSON_INT64/JSON_UINT64 can name the platform's own
+ types. long long is an extension in C89 and marked as one for gcc */
+#if defined(JSON_INT64) && defined(JSON_UINT64)
+typedef JSON_INT64 json_int;
+typedef JSON_UINT64 json_uint;
+#elif defined(_MSC_VER)
+typedef __int64 json_int;
+typedef unsigned __int64 json_uint;
+#elif defined(__GNUC__)
+__extension__ typedef long long json_int;
+__extension__ typedef unsigned long long json_uint;
+#else
+typedef long long json_int;
+typedef unsigned long long json_uint;
+#endif
 enum json_token_type {
     JSON_NONE,      /* invalid token */
     JSON_OBJECT,    /* sub-object */
@@ -161,7 +284,12 @@ JSON_API struct json_iter   json_parse(struct json_pair*, const struct json_iter
 /* utility */
 JSON_API int                json_cmp(const struct json_token*, const char*);
 JSON_API int                json_cpy(char*, int, const struct json_token*);
+/* decodes string escapes to UTF-8 (returns the full length, -1 if malformed) */
+JSON_API int                json_unescape(char*, int max, const struct json_token*);
 JSON_API int                json_convert(json_number *, const struct json_token*);
+/* exact integer conversion (JSON_NONE for fractions, exponents and overflow) */
+JSON_API int                json_convert_i64(json_int*, const struct json_token*);
+JSON_API int                json_convert_u64(json_uint*, const struct json_token*);
 
 /*-------------------------------------------------------------------------
                                 API
@@ -178,28 +306,62 @@ JSON_API int                json_convert(json_number *, const struct json_token*
 #define JSON_MAX_DEPTH 512
 #endif
 
+#ifndef JSON_PARSER_DEPTH
+#define JSON_PARSER_DEPTH 16
+#endif
+
+/* optional arena: `alloc` returns a new block of `size` bytes and `grow`
+ resizes a block it returned before while keeping its content (may be
+ null to allocate and copy instead). Both return null if exhausted. */
+typedef void*(*json_alloc_callback)(void *usr, int size);
+typedef void*(*json_grow_callback)(void *usr, void *mem, int size, int new_size);
+
 enum json_status {
     JSON_OK = 0,
     JSON_INVAL,
     JSON_OUT_OF_TOKEN,
     JSON_STACK_OVERFLOW,
-    JSON_PARSING_ERROR
+    JSON_PARSING_ERROR,
+    JSON_BUFFER_OVERFLOW,
+    JSON_ABORTED
 };
 struct json_parser {
     enum json_status err;
     struct json_token *toks;
     int cnt, cap;
 
+    /* arena hooks, with them set tokens are never requested from the caller */
+    json_alloc_callback alloc;
+    json_grow_callback grow;
+    void *usr;
+
     /* internal */
+    int size;                   /* tokens in the block taken from the arena */
+    int depth;                  /* levels in stk, grown on demand */
+    int deep;                   /* too deep without arena, loaded by json_load_tape */
     struct json_iter *iter;
-    struct json_iter stk[JSON_MAX_DEPTH];
+    struct json_iter *stk;
+    struct json_iter base[JSON_PARSER_DEPTH];
     struct json_token tok;
 };
 
+/* arena setup and reuse of tokens and stack across documents */
+JSON_API void               json_parser_init(struct json_parser*, json_alloc_callback, json_grow_callback, void *usr);
+JSON_API void               json_parser_reset(struct json_parser*);
+
 /* parse JSON into token array tree */
 JSON_API int                json_num(const char *json, int length);
 JSON_API int                json_load(struct json_parser *p, const char *str, int len);
 
+/* single pass loading (no nested re-scanning), optionally from a structural index */
+JSON_API int                json_index(int *idx, int cap, const char *json, int length);
+JSON_API int                json_load_index(struct json_parser *p, const char *str, int len, const int *idx, int cnt);
+JSON_API int                json_load_tape(struct json_parser *p, const char *str, int len);
+
+/* exact token count and loading with a single allocation */
+JSON_API int                json_count(const char *json, int length);
+JSON_API int                json_load_exact(struct json_parser *p, const char *str, int len);
+
 /* iterate over array/object content */
 JSON_API struct json_token* json_array_begin(struct json_token *tok);
 JSON_API struct json_token* json_array_next(struct json_token *tok);
@@ -210,9 +372,374 @@ JSON_API struct json_token* json_obj_next(struct json_token *toks);
 /* access nodes inside token array */
 JSON_API struct json_token *json_query(struct json_token *toks, int count, const char *path);
 JSON_API int                json_query_number(json_number*, struct json_token *toks, int count, const char *path);
+JSON_API int                json_query_int(json_int*, struct json_token *toks, int count, const char *path);
 JSON_API int                json_query_string(char*, int max, int *size, struct json_token*, int count, const char *path);
 JSON_API int                json_query_type(struct json_token *toks, int count, const char *path);
 
+/* hashed lookup index over a loaded token array */
+struct json_map {
+    struct json_token *toks;
+    int cnt;
+    int root; /* offset of the root key table inside slots or -1 */
+    int *slots; /* per token table offsets followed by key and element tables */
+};
+JSON_API int                json_map_size(const struct json_token *toks, int count);
+JSON_API int                json_map_build(struct json_map*, struct json_token *toks, int count, int *mem, int size);
+JSON_API struct json_token* json_map_find(const struct json_map*, const struct json_token *obj, const char *key, int len);
+JSON_API struct json_token* json_map_at(const struct json_map*, const struct json_token *array, int index);
+JSON_API const int*         json_map_elements(const struct json_map*, const struct json_token *array, int *count);
+/* array element tables only, objects are searched linearly */
+JSON_API int                json_map_arrays_size(const struct json_token *toks, int count);
+JSON_API int                json_map_build_arrays(struct json_map*, struct json_token *toks, int count, int *mem, int size);
+JSON_API struct json_token* json_map_query(const struct json_map*, const char *path);
+JSON_API int                json_map_query_number(json_number*, const struct json_map*, const char *path);
+
+/* precompiled query paths (segments reference the path string) */
+#ifndef JSON_PATH_MAX
+#define JSON_PATH_MAX 16
+#endif
+struct json_path_segment {
+    unsigned hash;
+    const char *key;
+    int len;    /* key length or 0 for an array index */
+    int index;  /* array index or -1 for a key */
+};
+struct json_path {
+    int cnt;
+    struct json_path_segment seg[JSON_PATH_MAX];
+};
+JSON_API int                json_path_compile(struct json_path*, const char *path);
+JSON_API struct json_token* json_query_compiled(struct json_token *toks, int count, const struct json_path*);
+JSON_API int                json_query_compiled_number(json_number*, struct json_token *toks, int count, const struct json_path*);
+JSON_API int                json_query_compiled_string(char*, int max, int *size, struct json_token*, int count, const struct json_path*);
+JSON_API struct json_token* json_map_query_compiled(const struct json_map*, const struct json_path*);
+JSON_API int                json_query_many(struct json_token **out, struct json_token *toks, int count, const struct json_path*, int num);
+
+/* compact 16 byte tokens: offsets into the document instead of pointers */
+struct json_ctoken {
+    int off;    /* offset of the token text inside the document */
+    int len;
+    int info;   /* token type in the lowest four bits, children above */
+    int sub;    /* total number of subtokens (note: not pairs) */
+};
+struct json_compact {
+    enum json_status err;
+    const char *src;
+    struct json_ctoken *toks;
+    int cnt, cap;
+};
+JSON_API int                json_load_compact(struct json_compact*, const char *str, int len);
+JSON_API struct json_token  json_compact_token(const struct json_compact*, const struct json_ctoken*);
+JSON_API enum json_token_type json_compact_type(const struct json_ctoken*);
+JSON_API int                json_compact_children(const struct json_ctoken*);
+JSON_API struct json_ctoken* json_compact_array_begin(struct json_ctoken*);
+JSON_API struct json_ctoken* json_compact_array_next(struct json_ctoken*);
+JSON_API struct json_ctoken* json_compact_obj_begin(struct json_ctoken*);
+JSON_API struct json_ctoken* json_compact_obj_next(struct json_ctoken*);
+JSON_API struct json_ctoken* json_compact_query(const struct json_compact*, struct json_ctoken *toks, int count, const char *path);
+JSON_API struct json_ctoken* json_compact_query_compiled(const struct json_compact*, struct json_ctoken *toks, int count, const struct json_path*);
+JSON_API int                json_compact_query_number(json_number*, const struct json_compact*, struct json_ctoken *toks, int count, const char *path);
+JSON_API int                json_compact_query_string(char*, int max, int *size, const struct json_compact*, struct json_ctoken *toks, int count, const char *path);
+
+/* streaming push parser: input is fed in arbitrary chunks and completed
+ tokens are passed to a callback. Tokens spanning chunk boundaries are
+ copied into the stream buffer, so memory use is constant */
+#ifndef JSON_STREAM_BUFFER
+#define JSON_STREAM_BUFFER 4096
+#endif
+enum json_stream_event {
+    JSON_STREAM_BEGIN,  /* object or array opened */
+    JSON_STREAM_END,    /* object or array closed */
+    JSON_STREAM_KEY,    /* object member name */
+    JSON_STREAM_VALUE   /* string, number or literal */
+};
+typedef int(*json_stream_callback)(void *usr, enum json_stream_event,
+    const struct json_token*, int depth);
+struct json_stream {
+    enum json_status err;
+    json_stream_callback cb;
+    void *usr;
+
+    /* internal */
+    const char *go;     /* tokenizer state at the end of the last chunk */
+    int utf8;           /* remaining UTF-8 continuation bytes */
+    int depth;
+    int key;            /* next token inside an object is a member name */
+    int len;            /* bytes of the unfinished token in buf */
+    char buf[JSON_STREAM_BUFFER];
+    char stk[JSON_MAX_DEPTH];
+};
+JSON_API void               json_stream_begin(struct json_stream*, json_stream_callback, void *usr);
+JSON_API int                json_stream_feed(struct json_stream*, const char *chunk, int len);
+JSON_API int                json_stream_end(struct json_stream*);
+
+/* newline delimited JSON: one document per line, each parsed into its own
+ token range inside a shared token arena */
+struct json_record {
+    const char *str;            /* record text without the newline */
+    int len;
+    struct json_token *toks;    /* tokens of the record inside the arena */
+    int cnt;
+    enum json_status err;
+};
+struct json_lines {
+    enum json_status err;
+    struct json_record *recs;
+    int cnt, cap;               /* records */
+    struct json_token *toks;
+    int used, size;             /* tokens of the shared arena */
+};
+JSON_API int                json_lines_split(int *cuts, int parts, const char *str, int len);
+JSON_API int                json_load_lines(struct json_lines*, const char *str, int len);
+
+/* parallel loading of one large document: the input is cut into parts
+ which are tokenized concurrently straight into the token array. Parts
+ are handed out through the run callback so any thread pool can drive
+ them: it has to call task(arg, i) for every i in [0,cnt) and return once
+ all of them finished (without a callback they run one after another).
+ Like json_load_exact the first call without tokens only counts them. */
+typedef void(*json_task)(void *arg, int index);
+typedef void(*json_run_callback)(void *usr, json_task, void *arg, int cnt);
+struct json_chunk {
+    /* internal */
+    const char *str;
+    int len;
+    enum json_status err;
+    int string;                 /* part starts inside a string */
+    int guess;                  /* start state assumed while counting */
+    int escaped;                /* first byte is escaped */
+    int end;                    /* input ends inside the part ('\0') */
+    int quotes, values, opened; /* structurals */
+    int depth, low, roots;      /* net depth, lowest depth and opens at it */
+    int outer;                  /* containers still open at the start */
+    int off, cnt;               /* tokens of the part */
+    int quote;                  /* quote ending a string of an earlier part */
+    int tail;                   /* string continued by the next part or -1 */
+    int closes;                 /* containers of earlier parts closed */
+    int close[JSON_MAX_DEPTH];  /* ... at these offsets */
+    int count[JSON_MAX_DEPTH];  /* ... after this many tokens of the part */
+    int kids[JSON_MAX_DEPTH+1]; /* children added to each outer container */
+    int pending;                /* containers left open */
+    int stk[JSON_MAX_DEPTH];
+};
+JSON_API int                json_load_parallel(struct json_parser*, const char *str, int len, struct json_chunk *parts, int cnt, json_run_callback, void *usr);
+
+/* incremental reload: `del` bytes at offset `at` of the text `old` the
+ tokens were loaded from were replaced by `ins` bytes, giving `str`. Only
+ the innermost object/array around the edit is tokenized again, all other
+ tokens are shifted. Tokens in front of the edit stay untouched if the
+ text was edited in place (old == str). */
+JSON_API int                json_reload(struct json_parser*, const char *old, const char *str, int len, int at, int del, int ins);
+
+/* on-demand cursor: walks the document in place without building tokens.
+ Containers are only entered on request, everything else is skipped by
+ balancing brackets with the structural scanner. Container values are
+ returned with only their opening bracket (len 1) and no child counts. */
+struct json_cursor {
+    enum json_status err;
+    const char *src;            /* document */
+    const char *cur;            /* next unread byte */
+    const char *end;
+    const char *open;           /* container value returned but not entered */
+    int depth;
+    char stk[JSON_MAX_DEPTH];   /* '{', '[' or 0 for an implicit root object */
+};
+JSON_API int                json_cursor_begin(struct json_cursor*, const char *str, int len);
+JSON_API int                json_cursor_next(struct json_cursor*, struct json_token *key, struct json_token *val);
+JSON_API int                json_cursor_find(struct json_cursor*, struct json_token *val, const char *key, int len);
+JSON_API int                json_cursor_at(struct json_cursor*, struct json_token *val, int index);
+JSON_API int                json_cursor_enter(struct json_cursor*);
+JSON_API int                json_cursor_leave(struct json_cursor*);
+JSON_API int                json_cursor_skip(struct json_cursor*, struct json_token *val);
+JSON_API int                json_cursor_query(struct json_cursor*, struct json_token *val, const char *path);
+/* streaming writer: output is formatted into a caller provided buffer which
+ is handed to the flush callback whenever it fills up. Without a callback
+ the buffer has to hold the whole document. Consecutive values at the
+ root are separated by newlines. */
+typedef int(*json_write_callback)(void *usr, const char *buf, int len);
+struct json_writer {
+    enum json_status err;
+    char *buf;
+    int len, cap;
+    json_write_callback flush;
+    void *usr;
+    int depth;
+    int first;                  /* nothing written yet at this level */
+    int key;                    /* key written, its value comes next */
+    char stk[JSON_MAX_DEPTH];
+};
+JSON_API void               json_write_begin(struct json_writer*, char *buf, int cap, json_write_callback, void *usr);
+JSON_API int                json_write_end(struct json_writer*);
+JSON_API int                json_write_object(struct json_writer*);
+JSON_API int                json_write_array(struct json_writer*);
+JSON_API int                json_write_close(struct json_writer*);
+JSON_API int                json_write_key(struct json_writer*, const char *key, int len);
+JSON_API int                json_write_string(struct json_writer*, const char *str, int len);
+JSON_API int                json_write_int(struct json_writer*, json_int);
+JSON_API int                json_write_number(struct json_writer*, json_number);
+JSON_API int                json_write_bool(struct json_writer*, int);
+JSON_API int                json_write_null(struct json_writer*);
+/* re-emits a token (with its whole subtree) as it appears in the source */
+JSON_API int                json_write_token(struct json_writer*, const struct json_token*);
+
+/* schema bound decoding: object values are converted straight into the
+ members of a C struct described by a table of fields. The schema is
+ prepared once, after which keys are dispatched by a perfect hash. */
+#ifndef JSON_SCHEMA_MAX_FIELDS
+#define JSON_SCHEMA_MAX_FIELDS 64
+#endif
+#if JSON_SCHEMA_MAX_FIELDS > 255
+#error "JSON_SCHEMA_MAX_FIELDS must fit below the empty slot marker 0xFF"
+#endif
+enum json_field_type {
+    JSON_FIELD_INT,     /* json_int */
+    JSON_FIELD_UINT,    /* json_uint */
+    JSON_FIELD_INT32,   /* int */
+    JSON_FIELD_NUMBER,  /* json_number */
+    JSON_FIELD_FLOAT,   /* float */
+    JSON_FIELD_BOOL,    /* int set to 0 or 1 */
+    JSON_FIELD_STRING,  /* char[size], unescaped and always terminated */
+    JSON_FIELD_TOKEN,   /* struct json_token, any value as is */
+    JSON_FIELD_OBJECT   /* nested struct described by `sub` */
+};
+struct json_schema;
+struct json_dict;
+struct json_field {
+    const char *name;   /* key as it appears in the source */
+    int offset;         /* offsetof the member */
+    enum json_field_type type;
+    int size;           /* JSON_FIELD_STRING: capacity of the array */
+    const struct json_schema *sub;
+};
+struct json_schema {
+    const struct json_field *fields;
+    int cnt;
+    /* internal */
+    unsigned seed;
+    int shift;
+    int full;       /* keys are hashed in full instead of a few bytes */
+    int probe;      /* no perfect table fit, slots are linearly probed */
+    unsigned hash[JSON_SCHEMA_MAX_FIELDS];
+    unsigned char len[JSON_SCHEMA_MAX_FIELDS];
+    unsigned char slot[JSON_SCHEMA_MAX_FIELDS * 4];
+    /* key ids once bound to a dictionary */
+    const struct json_dict *dict;
+    unsigned idseed;
+    int idshift;
+    int idprobe;
+    int id[JSON_SCHEMA_MAX_FIELDS];
+    unsigned char idslot[JSON_SCHEMA_MAX_FIELDS * 4];
+};
+JSON_API int                json_schema_build(struct json_schema*, const struct json_field*, int cnt);
+JSON_API int                json_decode_struct(void *dst, const struct json_schema*, const struct json_token *toks, int count);
+
+/* columnar extraction: one field of every object in an array into a
+ contiguous typed output array per column */
+#ifndef JSON_COLUMN_MAX_DEPTH
+#define JSON_COLUMN_MAX_DEPTH 8
+#endif
+enum json_column_type {
+    JSON_COLUMN_NUMBER, /* json_number */
+    JSON_COLUMN_INT,    /* json_int, exact integers only */
+    JSON_COLUMN_SPAN    /* struct json_span of a string, escapes kept */
+};
+struct json_span {
+    const char *str;
+    int len;
+};
+struct json_column {
+    const char *path;   /* keys inside each element separated by JSON_DELIMITER */
+    enum json_column_type type;
+    void *out;          /* one value per element, missing ones stay untouched */
+    int found;          /* elements that had a value of the column's type */
+    /* internal */
+    int depth;
+    const char *key[JSON_COLUMN_MAX_DEPTH];
+    int len[JSON_COLUMN_MAX_DEPTH];
+    int hint[JSON_COLUMN_MAX_DEPTH]; /* pair index of the key in the last element */
+};
+JSON_API int                json_columns(struct json_column*, int cnt, const struct json_token *array);
+
+/* token image: compact tokens of a loaded document behind a small header,
+ saved next to the source and mapped back in later without parsing */
+#define JSON_IMAGE_MAGIC 0x4A53494Du /* 'JSIM' in native byte order */
+#define JSON_IMAGE_VERSION 1
+struct json_image_header {
+    unsigned magic;
+    unsigned version;
+    int token_size; /* sizeof(struct json_ctoken) */
+    int cnt;        /* number of tokens following the header */
+    int len;        /* source length in bytes */
+    unsigned sum;   /* checksum of the source */
+};
+JSON_API int                json_image_write(void *mem, int size, const struct json_token *toks, int count, const char *src, int len);
+JSON_API int                json_image_open(struct json_compact*, const void *mem, int size, const char *src, int len);
+
+/* key dictionary: interns object keys to small integer ids which stay the
+ same across documents, so lookups and dispatch compare ids instead of
+ bytes. Ids live in an array parallel to the tokens, -1 for non keys. */
+struct json_dict {
+    int cnt, max;       /* keys interned and maximum number of keys */
+    int used, space;    /* bytes of key text stored and available */
+    int frozen;         /* set to stop adding keys, unknown ones get -1 */
+    /* internal */
+    int mask;
+    int *slots;         /* open addressed table of ids or -1 */
+    int *keys;          /* hash, text offset and length per id */
+    char *text;
+};
+JSON_API int                json_dict_size(int keys, int text);
+JSON_API int                json_dict_init(struct json_dict*, int *mem, int size, int keys, int text);
+JSON_API int                json_dict_add(struct json_dict*, const char *key, int len);
+JSON_API int                json_dict_find(const struct json_dict*, const char *key, int len);
+JSON_API const char*        json_dict_key(const struct json_dict*, int id, int *len);
+JSON_API int                json_intern(struct json_dict*, int *ids, const struct json_token *toks, int count, int root);
+JSON_API struct json_token* json_find_id(struct json_token *toks, const int *ids, int count, int id);
+JSON_API int                json_schema_bind(struct json_schema*, struct json_dict*);
+JSON_API int                json_decode_ids(void *dst, const struct json_schema*, const struct json_token *toks, const int *ids, int count);
+
+/* selection queries: paths extended by `*` and `[*]` for every child, `..`
+ for any depth below and `[?key op value]` filters on children, e.g.
+ `entities[?type=="npc"].name` or `..[?hp<10]`. `@` in a filter stands for
+ the child itself, op is one of == != < <= > >= or left out to test if the
+ key exists. Matches are passed to a callback in document order. */
+enum json_step_type {
+    JSON_STEP_KEY,
+    JSON_STEP_ANY,
+    JSON_STEP_INDEX,
+    JSON_STEP_FILTER
+};
+enum json_step_op {
+    JSON_OP_EXISTS,
+    JSON_OP_EQ,
+    JSON_OP_NE,
+    JSON_OP_LT,
+    JSON_OP_LE,
+    JSON_OP_GT,
+    JSON_OP_GE
+};
+struct json_select_step {
+    enum json_step_type type;
+    int deep;                   /* also matched at any depth below */
+    const char *key;            /* key or filter member, null for `@` */
+    int len;
+    int index;
+    /* filter */
+    enum json_step_op op;
+    struct json_token value;    /* literal compared against */
+    json_number num;
+};
+struct json_select {
+    int cnt;
+    struct json_select_step step[JSON_PATH_MAX];
+};
+typedef int(*json_select_callback)(void *usr, struct json_token*);
+JSON_API int                json_select_compile(struct json_select*, const char *query);
+JSON_API int                json_select(struct json_token *toks, int count, const struct json_select*, json_select_callback, void *usr);
+
+/* strict RFC 8259 check of a whole document without producing tokens */
+JSON_API int                json_validate(const char *str, int len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -248,6 +775,33 @@ JSON_API int                json_query_type(struct json_token *toks, int count,
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #endif
 
+/* vector instruction set used by the structural scanner. Define
+ JSON_NO_SIMD to always use the portable scalar classifier. */
+#ifndef JSON_NO_SIMD
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define JSON_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) ||\
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define JSON_SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #include <arm_neon.h>
+  #define JSON_SIMD_NEON
+#else
+  #define JSON_NO_SIMD
+#endif
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* one bit per byte of a 64 byte scanner block */
+typedef json_uint json_mask;
+/* 64-bit constant from its 32-bit halves, C89 has no long long literals */
+#define JSON_U64(hi, lo) (((json_uint)(hi) << 32) | (json_uint)(lo))
+#define JSON_EVEN_BITS JSON_U64(0x55555555, 0x55555555)
+
 /* Main token parsing function states */
 enum json_parser_states {
     JSON_STATE_FAILED,
@@ -703,49 +1257,12 @@ json_deq(struct json_token *tok)
     if (tok->str[0] == '\"' && tok->len >= 2)
         tok->str++; tok->len-=2;
 }
-JSON_INTERN json_number
-json_ipow(int base, unsigned exp)
-{
-    /* simple power function for json exponent numbers */
-    long res = 1;
-    while (exp) {
-        if (exp & 1)
-            res *= base;
-        exp >>= 1;
-        base *= base;
-    } return (json_number)res;
-}
-JSON_INTERN json_number
-json_stoi(int *neg, struct json_token *tok)
-{
-    /* converts a token containing a integer value into a number */
-    json_number n = 0;
-    int i = 0;
-    int off;
-    if (!tok->str || !tok->len)
-        return 0;
-
-    off = (tok->str[0] == '-' || tok->str[0] == '+') ? 1 : 0;
-    *neg = (tok->str[0] == '-') ? 1 : 0;
-    for (i = off; i < tok->len; i++) {
-        if ((tok->str[i] >= '0') && (tok->str[i] <= '9'))
-            n = (n * 10) + tok->str[i]  - '0';
-    } return (*neg) ? -n : n;
-}
-JSON_INTERN json_number
-json_stof(struct json_token *tok)
+JSON_INTERN int
+json_memeq(const char *a, const char *b, int len)
 {
-    /* converts a token containing a real value into a floating point number */
-    int i = 0;
-    json_number n = 0;
-    json_number f = 0.1;
-    if (!tok->str || !tok->len) return 0;
-    for (i = 0; i < tok->len; i++) {
-        if ((tok->str[i] >= '0') && (tok->str[i] <= '9')) {
-            n = n + (tok->str[i] - '0') * f;
-            f *= 0.1;
-        }
-    } return n;
+    while (len-- > 0)
+        if (*a++ != *b++) return 0;
+    return 1;
 }
 JSON_INTERN int
 json_lcmp(const struct json_token* tok, const char* str, int len)
@@ -761,127 +1278,1413 @@ json_lcmp(const struct json_token* tok, const char* str, int len)
             return 1;
     } return 0;
 }
+JSON_INTERN int
+json_ctz(json_mask m)
+{
+    /* index of the lowest set bit (m must not be zero) */
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long r = 0;
+    _BitScanForward64(&r, m);
+    return (int)r;
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(m);
+#else
+    int n = 0;
+    while (!(m & 1)) {m >>= 1; n++;}
+    return n;
+#endif
+}
+JSON_INTERN int
+json_popcnt(json_mask m)
+{
+    /* number of set bits */
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(m);
+#else
+    m = m - ((m >> 1) & JSON_U64(0x55555555, 0x55555555));
+    m = (m & JSON_U64(0x33333333, 0x33333333)) + ((m >> 2) & JSON_U64(0x33333333, 0x33333333));
+    m = (m + (m >> 4)) & JSON_U64(0x0F0F0F0F, 0x0F0F0F0F);
+    return (int)((m * JSON_U64(0x01010101, 0x01010101)) >> 56);
+#endif
+}
+JSON_INTERN json_mask
+json_prefix_xor(json_mask m)
+{
+    /* each bit becomes the xor of itself and all lower bits, which turns
+     a mask of quotes into a mask of bytes between quote pairs */
+    m ^= m << 1;
+    m ^= m << 2;
+    m ^= m << 4;
+    m ^= m << 8;
+    m ^= m << 16;
+    m ^= m << 32;
+    return m;
+}
 /*--------------------------------------------------------------------------
-                                UTILITY
+                                NUMBER
   -------------------------------------------------------------------------*/
-JSON_API int
-json_convert(json_number *num, const struct json_token *tok)
+/* decimal number split into (up to) 19 significant digits and a power of ten */
+struct json_decimal {
+    json_mask w;        /* significant digits, value = w * 10^q */
+    int q;              /* decimal exponent of w */
+    int neg;            /* sign */
+    int many;           /* non-zero digits dropped after the 19th */
+    int exp;            /* explicit exponent after 'e' */
+    const char *digits; /* mantissa including the '.' for the slow path */
+    const char *end;
+};
+/* exact double powers of ten for the fast path */
+static const double json_pow10[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+/* 128-bit powers of five 5^q for q in [-342,341] truncated to their highest
+ 128 bits with the top bit set (high word first). Parsing only needs up to
+ 308, the rest covers scaling subnormals when printing */
+static const json_mask json_pow5[1368] = {
+    JSON_U64(0xeef453d6, 0x923bd65a), JSON_U64(0x113faa29, 0x06a13b3f),
+    JSON_U64(0x9558b466, 0x1b6565f8), JSON_U64(0x4ac7ca59, 0xa424c507),
+    JSON_U64(0xbaaee17f, 0xa23ebf76), JSON_U64(0x5d79bcf0, 0x0d2df649),
+    JSON_U64(0xe95a99df, 0x8ace6f53), JSON_U64(0xf4d82c2c, 0x107973dc),
+    JSON_U64(0x91d8a02b, 0xb6c10594), JSON_U64(0x79071b9b, 0x8a4be869),
+    JSON_U64(0xb64ec836, 0xa47146f9), JSON_U64(0x9748e282, 0x6cdee284),
+    JSON_U64(0xe3e27a44, 0x4d8d98b7), JSON_U64(0xfd1b1b23, 0x08169b25),
+    JSON_U64(0x8e6d8c6a, 0xb0787f72), JSON_U64(0xfe30f0f5, 0xe50e20f7),
+    JSON_U64(0xb208ef85, 0x5c969f4f), JSON_U64(0xbdbd2d33, 0x5e51a935),
+    JSON_U64(0xde8b2b66, 0xb3bc4723), JSON_U64(0xad2c7880, 0x35e61382),
+    JSON_U64(0x8b16fb20, 0x3055ac76), JSON_U64(0x4c3bcb50, 0x21afcc31),
+    JSON_U64(0xaddcb9e8, 0x3c6b1793), JSON_U64(0xdf4abe24, 0x2a1bbf3d),
+    JSON_U64(0xd953e862, 0x4b85dd78), JSON_U64(0xd71d6dad, 0x34a2af0d),
+    JSON_U64(0x87d4713d, 0x6f33aa6b), JSON_U64(0x8672648c, 0x40e5ad68),
+    JSON_U64(0xa9c98d8c, 0xcb009506), JSON_U64(0x680efdaf, 0x511f18c2),
+    JSON_U64(0xd43bf0ef, 0xfdc0ba48), JSON_U64(0x0212bd1b, 0x2566def2),
+    JSON_U64(0x84a57695, 0xfe98746d), JSON_U64(0x014bb630, 0xf7604b57),
+    JSON_U64(0xa5ced43b, 0x7e3e9188), JSON_U64(0x419ea3bd, 0x35385e2d),
+    JSON_U64(0xcf42894a, 0x5dce35ea), JSON_U64(0x52064cac, 0x828675b9),
+    JSON_U64(0x818995ce, 0x7aa0e1b2), JSON_U64(0x7343efeb, 0xd1940993),
+    JSON_U64(0xa1ebfb42, 0x19491a1f), JSON_U64(0x1014ebe6, 0xc5f90bf8),
+    JSON_U64(0xca66fa12, 0x9f9b60a6), JSON_U64(0xd41a26e0, 0x77774ef6),
+    JSON_U64(0xfd00b897, 0x478238d0), JSON_U64(0x8920b098, 0x955522b4),
+    JSON_U64(0x9e20735e, 0x8cb16382), JSON_U64(0x55b46e5f, 0x5d5535b0),
+    JSON_U64(0xc5a89036, 0x2fddbc62), JSON_U64(0xeb2189f7, 0x34aa831d),
+    JSON_U64(0xf712b443, 0xbbd52b7b), JSON_U64(0xa5e9ec75, 0x01d523e4),
+    JSON_U64(0x9a6bb0aa, 0x55653b2d), JSON_U64(0x47b233c9, 0x2125366e),
+    JSON_U64(0xc1069cd4, 0xeabe89f8), JSON_U64(0x999ec0bb, 0x696e840a),
+    JSON_U64(0xf148440a, 0x256e2c76), JSON_U64(0xc00670ea, 0x43ca250d),
+    JSON_U64(0x96cd2a86, 0x5764dbca), JSON_U64(0x38040692, 0x6a5e5728),
+    JSON_U64(0xbc807527, 0xed3e12bc), JSON_U64(0xc6050837, 0x04f5ecf2),
+    JSON_U64(0xeba09271, 0xe88d976b), JSON_U64(0xf7864a44, 0xc633682e),
+    JSON_U64(0x93445b87, 0x31587ea3), JSON_U64(0x7ab3ee6a, 0xfbe0211d),
+    JSON_U64(0xb8157268, 0xfdae9e4c), JSON_U64(0x5960ea05, 0xbad82964),
+    JSON_U64(0xe61acf03, 0x3d1a45df), JSON_U64(0x6fb92487, 0x298e33bd),
+    JSON_U64(0x8fd0c162, 0x06306bab), JSON_U64(0xa5d3b6d4, 0x79f8e056),
+    JSON_U64(0xb3c4f1ba, 0x87bc8696), JSON_U64(0x8f48a489, 0x9877186c),
+    JSON_U64(0xe0b62e29, 0x29aba83c), JSON_U64(0x331acdab, 0xfe94de87),
+    JSON_U64(0x8c71dcd9, 0xba0b4925), JSON_U64(0x9ff0c08b, 0x7f1d0b14),
+    JSON_U64(0xaf8e5410, 0x288e1b6f), JSON_U64(0x07ecf0ae, 0x5ee44dd9),
+    JSON_U64(0xdb71e914, 0x32b1a24a), JSON_U64(0xc9e82cd9, 0xf69d6150),
+    JSON_U64(0x892731ac, 0x9faf056e), JSON_U64(0xbe311c08, 0x3a225cd2),
+    JSON_U64(0xab70fe17, 0xc79ac6ca), JSON_U64(0x6dbd630a, 0x48aaf406),
+    JSON_U64(0xd64d3d9d, 0xb981787d), JSON_U64(0x092cbbcc, 0xdad5b108),
+    JSON_U64(0x85f04682, 0x93f0eb4e), JSON_U64(0x25bbf560, 0x08c58ea5),
+    JSON_U64(0xa76c5823, 0x38ed2621), JSON_U64(0xaf2af2b8, 0x0af6f24e),
+    JSON_U64(0xd1476e2c, 0x07286faa), JSON_U64(0x1af5af66, 0x0db4aee1),
+    JSON_U64(0x82cca4db, 0x847945ca), JSON_U64(0x50d98d9f, 0xc890ed4d),
+    JSON_U64(0xa37fce12, 0x6597973c), JSON_U64(0xe50ff107, 0xbab528a0),
+    JSON_U64(0xcc5fc196, 0xfefd7d0c), JSON_U64(0x1e53ed49, 0xa96272c8),
+    JSON_U64(0xff77b1fc, 0xbebcdc4f), JSON_U64(0x25e8e89c, 0x13bb0f7a),
+    JSON_U64(0x9faacf3d, 0xf73609b1), JSON_U64(0x77b19161, 0x8c54e9ac),
+    JSON_U64(0xc795830d, 0x75038c1d), JSON_U64(0xd59df5b9, 0xef6a2417),
+    JSON_U64(0xf97ae3d0, 0xd2446f25), JSON_U64(0x4b057328, 0x6b44ad1d),
+    JSON_U64(0x9becce62, 0x836ac577), JSON_U64(0x4ee367f9, 0x430aec32),
+    JSON_U64(0xc2e801fb, 0x244576d5), JSON_U64(0x229c41f7, 0x93cda73f),
+    JSON_U64(0xf3a20279, 0xed56d48a), JSON_U64(0x6b435275, 0x78c1110f),
+    JSON_U64(0x9845418c, 0x345644d6), JSON_U64(0x830a1389, 0x6b78aaa9),
+    JSON_U64(0xbe5691ef, 0x416bd60c), JSON_U64(0x23cc986b, 0xc656d553),
+    JSON_U64(0xedec366b, 0x11c6cb8f), JSON_U64(0x2cbfbe86, 0xb7ec8aa8),
+    JSON_U64(0x94b3a202, 0xeb1c3f39), JSON_U64(0x7bf7d714, 0x32f3d6a9),
+    JSON_U64(0xb9e08a83, 0xa5e34f07), JSON_U64(0xdaf5ccd9, 0x3fb0cc53),
+    JSON_U64(0xe858ad24, 0x8f5c22c9), JSON_U64(0xd1b3400f, 0x8f9cff68),
+    JSON_U64(0x91376c36, 0xd99995be), JSON_U64(0x23100809, 0xb9c21fa1),
+    JSON_U64(0xb5854744, 0x8ffffb2d), JSON_U64(0xabd40a0c, 0x2832a78a),
+    JSON_U64(0xe2e69915, 0xb3fff9f9), JSON_U64(0x16c90c8f, 0x323f516c),
+    JSON_U64(0x8dd01fad, 0x907ffc3b), JSON_U64(0xae3da7d9, 0x7f6792e3),
+    JSON_U64(0xb1442798, 0xf49ffb4a), JSON_U64(0x99cd11cf, 0xdf41779c),
+    JSON_U64(0xdd95317f, 0x31c7fa1d), JSON_U64(0x40405643, 0xd711d583),
+    JSON_U64(0x8a7d3eef, 0x7f1cfc52), JSON_U64(0x482835ea, 0x666b2572),
+    JSON_U64(0xad1c8eab, 0x5ee43b66), JSON_U64(0xda324365, 0x0005eecf),
+    JSON_U64(0xd863b256, 0x369d4a40), JSON_U64(0x90bed43e, 0x40076a82),
+    JSON_U64(0x873e4f75, 0xe2224e68), JSON_U64(0x5a7744a6, 0xe804a291),
+    JSON_U64(0xa90de353, 0x5aaae202), JSON_U64(0x711515d0, 0xa205cb36),
+    JSON_U64(0xd3515c28, 0x31559a83), JSON_U64(0x0d5a5b44, 0xca873e03),
+    JSON_U64(0x8412d999, 0x1ed58091), JSON_U64(0xe858790a, 0xfe9486c2),
+    JSON_U64(0xa5178fff, 0x668ae0b6), JSON_U64(0x626e974d, 0xbe39a872),
+    JSON_U64(0xce5d73ff, 0x402d98e3), JSON_U64(0xfb0a3d21, 0x2dc8128f),
+    JSON_U64(0x80fa687f, 0x881c7f8e), JSON_U64(0x7ce66634, 0xbc9d0b99),
+    JSON_U64(0xa139029f, 0x6a239f72), JSON_U64(0x1c1fffc1, 0xebc44e80),
+    JSON_U64(0xc9874347, 0x44ac874e), JSON_U64(0xa327ffb2, 0x66b56220),
+    JSON_U64(0xfbe91419, 0x15d7a922), JSON_U64(0x4bf1ff9f, 0x0062baa8),
+    JSON_U64(0x9d71ac8f, 0xada6c9b5), JSON_U64(0x6f773fc3, 0x603db4a9),
+    JSON_U64(0xc4ce17b3, 0x99107c22), JSON_U64(0xcb550fb4, 0x384d21d3),
+    JSON_U64(0xf6019da0, 0x7f549b2b), JSON_U64(0x7e2a53a1, 0x46606a48),
+    JSON_U64(0x99c10284, 0x4f94e0fb), JSON_U64(0x2eda7444, 0xcbfc426d),
+    JSON_U64(0xc0314325, 0x637a1939), JSON_U64(0xfa911155, 0xfefb5308),
+    JSON_U64(0xf03d93ee, 0xbc589f88), JSON_U64(0x793555ab, 0x7eba27ca),
+    JSON_U64(0x96267c75, 0x35b763b5), JSON_U64(0x4bc1558b, 0x2f3458de),
+    JSON_U64(0xbbb01b92, 0x83253ca2), JSON_U64(0x9eb1aaed, 0xfb016f16),
+    JSON_U64(0xea9c2277, 0x23ee8bcb), JSON_U64(0x465e15a9, 0x79c1cadc),
+    JSON_U64(0x92a1958a, 0x7675175f), JSON_U64(0x0bfacd89, 0xec191ec9),
+    JSON_U64(0xb749faed, 0x14125d36), JSON_U64(0xcef980ec, 0x671f667b),
+    JSON_U64(0xe51c79a8, 0x5916f484), JSON_U64(0x82b7e127, 0x80e7401a),
+    JSON_U64(0x8f31cc09, 0x37ae58d2), JSON_U64(0xd1b2ecb8, 0xb0908810),
+    JSON_U64(0xb2fe3f0b, 0x8599ef07), JSON_U64(0x861fa7e6, 0xdcb4aa15),
+    JSON_U64(0xdfbdcece, 0x67006ac9), JSON_U64(0x67a791e0, 0x93e1d49a),
+    JSON_U64(0x8bd6a141, 0x006042bd), JSON_U64(0xe0c8bb2c, 0x5c6d24e0),
+    JSON_U64(0xaecc4991, 0x4078536d), JSON_U64(0x58fae9f7, 0x73886e18),
+    JSON_U64(0xda7f5bf5, 0x90966848), JSON_U64(0xaf39a475, 0x506a899e),
+    JSON_U64(0x888f9979, 0x7a5e012d), JSON_U64(0x6d8406c9, 0x52429603),
+    JSON_U64(0xaab37fd7, 0xd8f58178), JSON_U64(0xc8e5087b, 0xa6d33b83),
+    JSON_U64(0xd5605fcd, 0xcf32e1d6), JSON_U64(0xfb1e4a9a, 0x90880a64),
+    JSON_U64(0x855c3be0, 0xa17fcd26), JSON_U64(0x5cf2eea0, 0x9a55067f),
+    JSON_U64(0xa6b34ad8, 0xc9dfc06f), JSON_U64(0xf42faa48, 0xc0ea481e),
+    JSON_U64(0xd0601d8e, 0xfc57b08b), JSON_U64(0xf13b94da, 0xf124da26),
+    JSON_U64(0x823c1279, 0x5db6ce57), JSON_U64(0x76c53d08, 0xd6b70858),
+    JSON_U64(0xa2cb1717, 0xb52481ed), JSON_U64(0x54768c4b, 0x0c64ca6e),
+    JSON_U64(0xcb7ddcdd, 0xa26da268), JSON_U64(0xa9942f5d, 0xcf7dfd09),
+    JSON_U64(0xfe5d5415, 0x0b090b02), JSON_U64(0xd3f93b35, 0x435d7c4c),
+    JSON_U64(0x9efa548d, 0x26e5a6e1), JSON_U64(0xc47bc501, 0x4a1a6daf),
+    JSON_U64(0xc6b8e9b0, 0x709f109a), JSON_U64(0x359ab641, 0x9ca1091b),
+    JSON_U64(0xf867241c, 0x8cc6d4c0), JSON_U64(0xc30163d2, 0x03c94b62),
+    JSON_U64(0x9b407691, 0xd7fc44f8), JSON_U64(0x79e0de63, 0x425dcf1d),
+    JSON_U64(0xc2109436, 0x4dfb5636), JSON_U64(0x985915fc, 0x12f542e4),
+    JSON_U64(0xf294b943, 0xe17a2bc4), JSON_U64(0x3e6f5b7b, 0x17b2939d),
+    JSON_U64(0x979cf3ca, 0x6cec5b5a), JSON_U64(0xa705992c, 0xeecf9c42),
+    JSON_U64(0xbd8430bd, 0x08277231), JSON_U64(0x50c6ff78, 0x2a838353),
+    JSON_U64(0xece53cec, 0x4a314ebd), JSON_U64(0xa4f8bf56, 0x35246428),
+    JSON_U64(0x940f4613, 0xae5ed136), JSON_U64(0x871b7795, 0xe136be99),
+    JSON_U64(0xb9131798, 0x99f68584), JSON_U64(0x28e2557b, 0x59846e3f),
+    JSON_U64(0xe757dd7e, 0xc07426e5), JSON_U64(0x331aeada, 0x2fe589cf),
+    JSON_U64(0x9096ea6f, 0x3848984f), JSON_U64(0x3ff0d2c8, 0x5def7621),
+    JSON_U64(0xb4bca50b, 0x065abe63), JSON_U64(0x0fed077a, 0x756b53a9),
+    JSON_U64(0xe1ebce4d, 0xc7f16dfb), JSON_U64(0xd3e84959, 0x12c62894),
+    JSON_U64(0x8d3360f0, 0x9cf6e4bd), JSON_U64(0x64712dd7, 0xabbbd95c),
+    JSON_U64(0xb080392c, 0xc4349dec), JSON_U64(0xbd8d794d, 0x96aacfb3),
+    JSON_U64(0xdca04777, 0xf541c567), JSON_U64(0xecf0d7a0, 0xfc5583a0),
+    JSON_U64(0x89e42caa, 0xf9491b60), JSON_U64(0xf41686c4, 0x9db57244),
+    JSON_U64(0xac5d37d5, 0xb79b6239), JSON_U64(0x311c2875, 0xc522ced5),
+    JSON_U64(0xd77485cb, 0x25823ac7), JSON_U64(0x7d633293, 0x366b828b),
+    JSON_U64(0x86a8d39e, 0xf77164bc), JSON_U64(0xae5dff9c, 0x02033197),
+    JSON_U64(0xa8530886, 0xb54dbdeb), JSON_U64(0xd9f57f83, 0x0283fdfc),
+    JSON_U64(0xd267caa8, 0x62a12d66), JSON_U64(0xd072df63, 0xc324fd7b),
+    JSON_U64(0x8380dea9, 0x3da4bc60), JSON_U64(0x4247cb9e, 0x59f71e6d),
+    JSON_U64(0xa4611653, 0x8d0deb78), JSON_U64(0x52d9be85, 0xf074e608),
+    JSON_U64(0xcd795be8, 0x70516656), JSON_U64(0x67902e27, 0x6c921f8b),
+    JSON_U64(0x806bd971, 0x4632dff6), JSON_U64(0x00ba1cd8, 0xa3db53b6),
+    JSON_U64(0xa086cfcd, 0x97bf97f3), JSON_U64(0x80e8a40e, 0xccd228a4),
+    JSON_U64(0xc8a883c0, 0xfdaf7df0), JSON_U64(0x6122cd12, 0x8006b2cd),
+    JSON_U64(0xfad2a4b1, 0x3d1b5d6c), JSON_U64(0x796b8057, 0x20085f81),
+    JSON_U64(0x9cc3a6ee, 0xc6311a63), JSON_U64(0xcbe33036, 0x74053bb0),
+    JSON_U64(0xc3f490aa, 0x77bd60fc), JSON_U64(0xbedbfc44, 0x11068a9c),
+    JSON_U64(0xf4f1b4d5, 0x15acb93b), JSON_U64(0xee92fb55, 0x15482d44),
+    JSON_U64(0x99171105, 0x2d8bf3c5), JSON_U64(0x751bdd15, 0x2d4d1c4a),
+    JSON_U64(0xbf5cd546, 0x78eef0b6), JSON_U64(0xd262d45a, 0x78a0635d),
+    JSON_U64(0xef340a98, 0x172aace4), JSON_U64(0x86fb8971, 0x16c87c34),
+    JSON_U64(0x9580869f, 0x0e7aac0e), JSON_U64(0xd45d35e6, 0xae3d4da0),
+    JSON_U64(0xbae0a846, 0xd2195712), JSON_U64(0x89748360, 0x59cca109),
+    JSON_U64(0xe998d258, 0x869facd7), JSON_U64(0x2bd1a438, 0x703fc94b),
+    JSON_U64(0x91ff8377, 0x5423cc06), JSON_U64(0x7b6306a3, 0x4627ddcf),
+    JSON_U64(0xb67f6455, 0x292cbf08), JSON_U64(0x1a3bc84c, 0x17b1d542),
+    JSON_U64(0xe41f3d6a, 0x7377eeca), JSON_U64(0x20caba5f, 0x1d9e4a93),
+    JSON_U64(0x8e938662, 0x882af53e), JSON_U64(0x547eb47b, 0x7282ee9c),
+    JSON_U64(0xb23867fb, 0x2a35b28d), JSON_U64(0xe99e619a, 0x4f23aa43),
+    JSON_U64(0xdec681f9, 0xf4c31f31), JSON_U64(0x6405fa00, 0xe2ec94d4),
+    JSON_U64(0x8b3c113c, 0x38f9f37e), JSON_U64(0xde83bc40, 0x8dd3dd04),
+    JSON_U64(0xae0b158b, 0x4738705e), JSON_U64(0x9624ab50, 0xb148d445),
+    JSON_U64(0xd98ddaee, 0x19068c76), JSON_U64(0x3badd624, 0xdd9b0957),
+    JSON_U64(0x87f8a8d4, 0xcfa417c9), JSON_U64(0xe54ca5d7, 0x0a80e5d6),
+    JSON_U64(0xa9f6d30a, 0x038d1dbc), JSON_U64(0x5e9fcf4c, 0xcd211f4c),
+    JSON_U64(0xd47487cc, 0x8470652b), JSON_U64(0x7647c320, 0x0069671f),
+    JSON_U64(0x84c8d4df, 0xd2c63f3b), JSON_U64(0x29ecd9f4, 0x0041e073),
+    JSON_U64(0xa5fb0a17, 0xc777cf09), JSON_U64(0xf4681071, 0x00525890),
+    JSON_U64(0xcf79cc9d, 0xb955c2cc), JSON_U64(0x7182148d, 0x4066eeb4),
+    JSON_U64(0x81ac1fe2, 0x93d599bf), JSON_U64(0xc6f14cd8, 0x48405530),
+    JSON_U64(0xa21727db, 0x38cb002f), JSON_U64(0xb8ada00e, 0x5a506a7c),
+    JSON_U64(0xca9cf1d2, 0x06fdc03b), JSON_U64(0xa6d90811, 0xf0e4851c),
+    JSON_U64(0xfd442e46, 0x88bd304a), JSON_U64(0x908f4a16, 0x6d1da663),
+    JSON_U64(0x9e4a9cec, 0x15763e2e), JSON_U64(0x9a598e4e, 0x043287fe),
+    JSON_U64(0xc5dd4427, 0x1ad3cdba), JSON_U64(0x40eff1e1, 0x853f29fd),
+    JSON_U64(0xf7549530, 0xe188c128), JSON_U64(0xd12bee59, 0xe68ef47c),
+    JSON_U64(0x9a94dd3e, 0x8cf578b9), JSON_U64(0x82bb74f8, 0x301958ce),
+    JSON_U64(0xc13a148e, 0x3032d6e7), JSON_U64(0xe36a5236, 0x3c1faf01),
+    JSON_U64(0xf18899b1, 0xbc3f8ca1), JSON_U64(0xdc44e6c3, 0xcb279ac1),
+    JSON_U64(0x96f5600f, 0x15a7b7e5), JSON_U64(0x29ab103a, 0x5ef8c0b9),
+    JSON_U64(0xbcb2b812, 0xdb11a5de), JSON_U64(0x7415d448, 0xf6b6f0e7),
+    JSON_U64(0xebdf6617, 0x91d60f56), JSON_U64(0x111b495b, 0x3464ad21),
+    JSON_U64(0x936b9fce, 0xbb25c995), JSON_U64(0xcab10dd9, 0x00beec34),
+    JSON_U64(0xb84687c2, 0x69ef3bfb), JSON_U64(0x3d5d514f, 0x40eea742),
+    JSON_U64(0xe65829b3, 0x046b0afa), JSON_U64(0x0cb4a5a3, 0x112a5112),
+    JSON_U64(0x8ff71a0f, 0xe2c2e6dc), JSON_U64(0x47f0e785, 0xeaba72ab),
+    JSON_U64(0xb3f4e093, 0xdb73a093), JSON_U64(0x59ed2167, 0x65690f56),
+    JSON_U64(0xe0f218b8, 0xd25088b8), JSON_U64(0x306869c1, 0x3ec3532c),
+    JSON_U64(0x8c974f73, 0x83725573), JSON_U64(0x1e414218, 0xc73a13fb),
+    JSON_U64(0xafbd2350, 0x644eeacf), JSON_U64(0xe5d1929e, 0xf90898fa),
+    JSON_U64(0xdbac6c24, 0x7d62a583), JSON_U64(0xdf45f746, 0xb74abf39),
+    JSON_U64(0x894bc396, 0xce5da772), JSON_U64(0x6b8bba8c, 0x328eb783),
+    JSON_U64(0xab9eb47c, 0x81f5114f), JSON_U64(0x066ea92f, 0x3f326564),
+    JSON_U64(0xd686619b, 0xa27255a2), JSON_U64(0xc80a537b, 0x0efefebd),
+    JSON_U64(0x8613fd01, 0x45877585), JSON_U64(0xbd06742c, 0xe95f5f36),
+    JSON_U64(0xa798fc41, 0x96e952e7), JSON_U64(0x2c481138, 0x23b73704),
+    JSON_U64(0xd17f3b51, 0xfca3a7a0), JSON_U64(0xf75a1586, 0x2ca504c5),
+    JSON_U64(0x82ef8513, 0x3de648c4), JSON_U64(0x9a984d73, 0xdbe722fb),
+    JSON_U64(0xa3ab6658, 0x0d5fdaf5), JSON_U64(0xc13e60d0, 0xd2e0ebba),
+    JSON_U64(0xcc963fee, 0x10b7d1b3), JSON_U64(0x318df905, 0x079926a8),
+    JSON_U64(0xffbbcfe9, 0x94e5c61f), JSON_U64(0xfdf17746, 0x497f7052),
+    JSON_U64(0x9fd561f1, 0xfd0f9bd3), JSON_U64(0xfeb6ea8b, 0xedefa633),
+    JSON_U64(0xc7caba6e, 0x7c5382c8), JSON_U64(0xfe64a52e, 0xe96b8fc0),
+    JSON_U64(0xf9bd690a, 0x1b68637b), JSON_U64(0x3dfdce7a, 0xa3c673b0),
+    JSON_U64(0x9c1661a6, 0x51213e2d), JSON_U64(0x06bea10c, 0xa65c084e),
+    JSON_U64(0xc31bfa0f, 0xe5698db8), JSON_U64(0x486e494f, 0xcff30a62),
+    JSON_U64(0xf3e2f893, 0xdec3f126), JSON_U64(0x5a89dba3, 0xc3efccfa),
+    JSON_U64(0x986ddb5c, 0x6b3a76b7), JSON_U64(0xf8962946, 0x5a75e01c),
+    JSON_U64(0xbe895233, 0x86091465), JSON_U64(0xf6bbb397, 0xf1135823),
+    JSON_U64(0xee2ba6c0, 0x678b597f), JSON_U64(0x746aa07d, 0xed582e2c),
+    JSON_U64(0x94db4838, 0x40b717ef), JSON_U64(0xa8c2a44e, 0xb4571cdc),
+    JSON_U64(0xba121a46, 0x50e4ddeb), JSON_U64(0x92f34d62, 0x616ce413),
+    JSON_U64(0xe896a0d7, 0xe51e1566), JSON_U64(0x77b020ba, 0xf9c81d17),
+    JSON_U64(0x915e2486, 0xef32cd60), JSON_U64(0x0ace1474, 0xdc1d122e),
+    JSON_U64(0xb5b5ada8, 0xaaff80b8), JSON_U64(0x0d819992, 0x132456ba),
+    JSON_U64(0xe3231912, 0xd5bf60e6), JSON_U64(0x10e1fff6, 0x97ed6c69),
+    JSON_U64(0x8df5efab, 0xc5979c8f), JSON_U64(0xca8d3ffa, 0x1ef463c1),
+    JSON_U64(0xb1736b96, 0xb6fd83b3), JSON_U64(0xbd308ff8, 0xa6b17cb2),
+    JSON_U64(0xddd0467c, 0x64bce4a0), JSON_U64(0xac7cb3f6, 0xd05ddbde),
+    JSON_U64(0x8aa22c0d, 0xbef60ee4), JSON_U64(0x6bcdf07a, 0x423aa96b),
+    JSON_U64(0xad4ab711, 0x2eb3929d), JSON_U64(0x86c16c98, 0xd2c953c6),
+    JSON_U64(0xd89d64d5, 0x7a607744), JSON_U64(0xe871c7bf, 0x077ba8b7),
+    JSON_U64(0x87625f05, 0x6c7c4a8b), JSON_U64(0x11471cd7, 0x64ad4972),
+    JSON_U64(0xa93af6c6, 0xc79b5d2d), JSON_U64(0xd598e40d, 0x3dd89bcf),
+    JSON_U64(0xd389b478, 0x79823479), JSON_U64(0x4aff1d10, 0x8d4ec2c3),
+    JSON_U64(0x843610cb, 0x4bf160cb), JSON_U64(0xcedf722a, 0x585139ba),
+    JSON_U64(0xa54394fe, 0x1eedb8fe), JSON_U64(0xc2974eb4, 0xee658828),
+    JSON_U64(0xce947a3d, 0xa6a9273e), JSON_U64(0x733d2262, 0x29feea32),
+    JSON_U64(0x811ccc66, 0x8829b887), JSON_U64(0x0806357d, 0x5a3f525f),
+    JSON_U64(0xa163ff80, 0x2a3426a8), JSON_U64(0xca07c2dc, 0xb0cf26f7),
+    JSON_U64(0xc9bcff60, 0x34c13052), JSON_U64(0xfc89b393, 0xdd02f0b5),
+    JSON_U64(0xfc2c3f38, 0x41f17c67), JSON_U64(0xbbac2078, 0xd443ace2),
+    JSON_U64(0x9d9ba783, 0x2936edc0), JSON_U64(0xd54b944b, 0x84aa4c0d),
+    JSON_U64(0xc5029163, 0xf384a931), JSON_U64(0x0a9e795e, 0x65d4df11),
+    JSON_U64(0xf64335bc, 0xf065d37d), JSON_U64(0x4d4617b5, 0xff4a16d5),
+    JSON_U64(0x99ea0196, 0x163fa42e), JSON_U64(0x504bced1, 0xbf8e4e45),
+    JSON_U64(0xc06481fb, 0x9bcf8d39), JSON_U64(0xe45ec286, 0x2f71e1d6),
+    JSON_U64(0xf07da27a, 0x82c37088), JSON_U64(0x5d767327, 0xbb4e5a4c),
+    JSON_U64(0x964e858c, 0x91ba2655), JSON_U64(0x3a6a07f8, 0xd510f86f),
+    JSON_U64(0xbbe226ef, 0xb628afea), JSON_U64(0x890489f7, 0x0a55368b),
+    JSON_U64(0xeadab0ab, 0xa3b2dbe5), JSON_U64(0x2b45ac74, 0xccea842e),
+    JSON_U64(0x92c8ae6b, 0x464fc96f), JSON_U64(0x3b0b8bc9, 0x0012929d),
+    JSON_U64(0xb77ada06, 0x17e3bbcb), JSON_U64(0x09ce6ebb, 0x40173744),
+    JSON_U64(0xe5599087, 0x9ddcaabd), JSON_U64(0xcc420a6a, 0x101d0515),
+    JSON_U64(0x8f57fa54, 0xc2a9eab6), JSON_U64(0x9fa94682, 0x4a12232d),
+    JSON_U64(0xb32df8e9, 0xf3546564), JSON_U64(0x47939822, 0xdc96abf9),
+    JSON_U64(0xdff97724, 0x70297ebd), JSON_U64(0x59787e2b, 0x93bc56f7),
+    JSON_U64(0x8bfbea76, 0xc619ef36), JSON_U64(0x57eb4edb, 0x3c55b65a),
+    JSON_U64(0xaefae514, 0x77a06b03), JSON_U64(0xede62292, 0x0b6b23f1),
+    JSON_U64(0xdab99e59, 0x958885c4), JSON_U64(0xe95fab36, 0x8e45eced),
+    JSON_U64(0x88b402f7, 0xfd75539b), JSON_U64(0x11dbcb02, 0x18ebb414),
+    JSON_U64(0xaae103b5, 0xfcd2a881), JSON_U64(0xd652bdc2, 0x9f26a119),
+    JSON_U64(0xd59944a3, 0x7c0752a2), JSON_U64(0x4be76d33, 0x46f0495f),
+    JSON_U64(0x857fcae6, 0x2d8493a5), JSON_U64(0x6f70a440, 0x0c562ddb),
+    JSON_U64(0xa6dfbd9f, 0xb8e5b88e), JSON_U64(0xcb4ccd50, 0x0f6bb952),
+    JSON_U64(0xd097ad07, 0xa71f26b2), JSON_U64(0x7e2000a4, 0x1346a7a7),
+    JSON_U64(0x825ecc24, 0xc873782f), JSON_U64(0x8ed40066, 0x8c0c28c8),
+    JSON_U64(0xa2f67f2d, 0xfa90563b), JSON_U64(0x72890080, 0x2f0f32fa),
+    JSON_U64(0xcbb41ef9, 0x79346bca), JSON_U64(0x4f2b40a0, 0x3ad2ffb9),
+    JSON_U64(0xfea126b7, 0xd78186bc), JSON_U64(0xe2f610c8, 0x4987bfa8),
+    JSON_U64(0x9f24b832, 0xe6b0f436), JSON_U64(0x0dd9ca7d, 0x2df4d7c9),
+    JSON_U64(0xc6ede63f, 0xa05d3143), JSON_U64(0x91503d1c, 0x79720dbb),
+    JSON_U64(0xf8a95fcf, 0x88747d94), JSON_U64(0x75a44c63, 0x97ce912a),
+    JSON_U64(0x9b69dbe1, 0xb548ce7c), JSON_U64(0xc986afbe, 0x3ee11aba),
+    JSON_U64(0xc24452da, 0x229b021b), JSON_U64(0xfbe85bad, 0xce996168),
+    JSON_U64(0xf2d56790, 0xab41c2a2), JSON_U64(0xfae27299, 0x423fb9c3),
+    JSON_U64(0x97c560ba, 0x6b0919a5), JSON_U64(0xdccd879f, 0xc967d41a),
+    JSON_U64(0xbdb6b8e9, 0x05cb600f), JSON_U64(0x5400e987, 0xbbc1c920),
+    JSON_U64(0xed246723, 0x473e3813), JSON_U64(0x290123e9, 0xaab23b68),
+    JSON_U64(0x9436c076, 0x0c86e30b), JSON_U64(0xf9a0b672, 0x0aaf6521),
+    JSON_U64(0xb9447093, 0x8fa89bce), JSON_U64(0xf808e40e, 0x8d5b3e69),
+    JSON_U64(0xe7958cb8, 0x7392c2c2), JSON_U64(0xb60b1d12, 0x30b20e04),
+    JSON_U64(0x90bd77f3, 0x483bb9b9), JSON_U64(0xb1c6f22b, 0x5e6f48c2),
+    JSON_U64(0xb4ecd5f0, 0x1a4aa828), JSON_U64(0x1e38aeb6, 0x360b1af3),
+    JSON_U64(0xe2280b6c, 0x20dd5232), JSON_U64(0x25c6da63, 0xc38de1b0),
+    JSON_U64(0x8d590723, 0x948a535f), JSON_U64(0x579c487e, 0x5a38ad0e),
+    JSON_U64(0xb0af48ec, 0x79ace837), JSON_U64(0x2d835a9d, 0xf0c6d851),
+    JSON_U64(0xdcdb1b27, 0x98182244), JSON_U64(0xf8e43145, 0x6cf88e65),
+    JSON_U64(0x8a08f0f8, 0xbf0f156b), JSON_U64(0x1b8e9ecb, 0x641b58ff),
+    JSON_U64(0xac8b2d36, 0xeed2dac5), JSON_U64(0xe272467e, 0x3d222f3f),
+    JSON_U64(0xd7adf884, 0xaa879177), JSON_U64(0x5b0ed81d, 0xcc6abb0f),
+    JSON_U64(0x86ccbb52, 0xea94baea), JSON_U64(0x98e94712, 0x9fc2b4e9),
+    JSON_U64(0xa87fea27, 0xa539e9a5), JSON_U64(0x3f2398d7, 0x47b36224),
+    JSON_U64(0xd29fe4b1, 0x8e88640e), JSON_U64(0x8eec7f0d, 0x19a03aad),
+    JSON_U64(0x83a3eeee, 0xf9153e89), JSON_U64(0x1953cf68, 0x300424ac),
+    JSON_U64(0xa48ceaaa, 0xb75a8e2b), JSON_U64(0x5fa8c342, 0x3c052dd7),
+    JSON_U64(0xcdb02555, 0x653131b6), JSON_U64(0x3792f412, 0xcb06794d),
+    JSON_U64(0x808e1755, 0x5f3ebf11), JSON_U64(0xe2bbd88b, 0xbee40bd0),
+    JSON_U64(0xa0b19d2a, 0xb70e6ed6), JSON_U64(0x5b6aceae, 0xae9d0ec4),
+    JSON_U64(0xc8de0475, 0x64d20a8b), JSON_U64(0xf245825a, 0x5a445275),
+    JSON_U64(0xfb158592, 0xbe068d2e), JSON_U64(0xeed6e2f0, 0xf0d56712),
+    JSON_U64(0x9ced737b, 0xb6c4183d), JSON_U64(0x55464dd6, 0x9685606b),
+    JSON_U64(0xc428d05a, 0xa4751e4c), JSON_U64(0xaa97e14c, 0x3c26b886),
+    JSON_U64(0xf5330471, 0x4d9265df), JSON_U64(0xd53dd99f, 0x4b3066a8),
+    JSON_U64(0x993fe2c6, 0xd07b7fab), JSON_U64(0xe546a803, 0x8efe4029),
+    JSON_U64(0xbf8fdb78, 0x849a5f96), JSON_U64(0xde985204, 0x72bdd033),
+    JSON_U64(0xef73d256, 0xa5c0f77c), JSON_U64(0x963e6685, 0x8f6d4440),
+    JSON_U64(0x95a86376, 0x27989aad), JSON_U64(0xdde70013, 0x79a44aa8),
+    JSON_U64(0xbb127c53, 0xb17ec159), JSON_U64(0x5560c018, 0x580d5d52),
+    JSON_U64(0xe9d71b68, 0x9dde71af), JSON_U64(0xaab8f01e, 0x6e10b4a6),
+    JSON_U64(0x92267121, 0x62ab070d), JSON_U64(0xcab39613, 0x04ca70e8),
+    JSON_U64(0xb6b00d69, 0xbb55c8d1), JSON_U64(0x3d607b97, 0xc5fd0d22),
+    JSON_U64(0xe45c10c4, 0x2a2b3b05), JSON_U64(0x8cb89a7d, 0xb77c506a),
+    JSON_U64(0x8eb98a7a, 0x9a5b04e3), JSON_U64(0x77f3608e, 0x92adb242),
+    JSON_U64(0xb267ed19, 0x40f1c61c), JSON_U64(0x55f038b2, 0x37591ed3),
+    JSON_U64(0xdf01e85f, 0x912e37a3), JSON_U64(0x6b6c46de, 0xc52f6688),
+    JSON_U64(0x8b61313b, 0xbabce2c6), JSON_U64(0x2323ac4b, 0x3b3da015),
+    JSON_U64(0xae397d8a, 0xa96c1b77), JSON_U64(0xabec975e, 0x0a0d081a),
+    JSON_U64(0xd9c7dced, 0x53c72255), JSON_U64(0x96e7bd35, 0x8c904a21),
+    JSON_U64(0x881cea14, 0x545c7575), JSON_U64(0x7e50d641, 0x77da2e54),
+    JSON_U64(0xaa242499, 0x697392d2), JSON_U64(0xdde50bd1, 0xd5d0b9e9),
+    JSON_U64(0xd4ad2dbf, 0xc3d07787), JSON_U64(0x955e4ec6, 0x4b44e864),
+    JSON_U64(0x84ec3c97, 0xda624ab4), JSON_U64(0xbd5af13b, 0xef0b113e),
+    JSON_U64(0xa6274bbd, 0xd0fadd61), JSON_U64(0xecb1ad8a, 0xeacdd58e),
+    JSON_U64(0xcfb11ead, 0x453994ba), JSON_U64(0x67de18ed, 0xa5814af2),
+    JSON_U64(0x81ceb32c, 0x4b43fcf4), JSON_U64(0x80eacf94, 0x8770ced7),
+    JSON_U64(0xa2425ff7, 0x5e14fc31), JSON_U64(0xa1258379, 0xa94d028d),
+    JSON_U64(0xcad2f7f5, 0x359a3b3e), JSON_U64(0x096ee458, 0x13a04330),
+    JSON_U64(0xfd87b5f2, 0x8300ca0d), JSON_U64(0x8bca9d6e, 0x188853fc),
+    JSON_U64(0x9e74d1b7, 0x91e07e48), JSON_U64(0x775ea264, 0xcf55347e),
+    JSON_U64(0xc6120625, 0x76589dda), JSON_U64(0x95364afe, 0x032a819e),
+    JSON_U64(0xf79687ae, 0xd3eec551), JSON_U64(0x3a83ddbd, 0x83f52205),
+    JSON_U64(0x9abe14cd, 0x44753b52), JSON_U64(0xc4926a96, 0x72793543),
+    JSON_U64(0xc16d9a00, 0x95928a27), JSON_U64(0x75b7053c, 0x0f178294),
+    JSON_U64(0xf1c90080, 0xbaf72cb1), JSON_U64(0x5324c68b, 0x12dd6339),
+    JSON_U64(0x971da050, 0x74da7bee), JSON_U64(0xd3f6fc16, 0xebca5e04),
+    JSON_U64(0xbce50864, 0x92111aea), JSON_U64(0x88f4bb1c, 0xa6bcf585),
+    JSON_U64(0xec1e4a7d, 0xb69561a5), JSON_U64(0x2b31e9e3, 0xd06c32e6),
+    JSON_U64(0x9392ee8e, 0x921d5d07), JSON_U64(0x3aff322e, 0x62439fd0),
+    JSON_U64(0xb877aa32, 0x36a4b449), JSON_U64(0x09befeb9, 0xfad487c3),
+    JSON_U64(0xe69594be, 0xc44de15b), JSON_U64(0x4c2ebe68, 0x7989a9b4),
+    JSON_U64(0x901d7cf7, 0x3ab0acd9), JSON_U64(0x0f9d3701, 0x4bf60a11),
+    JSON_U64(0xb424dc35, 0x095cd80f), JSON_U64(0x538484c1, 0x9ef38c95),
+    JSON_U64(0xe12e1342, 0x4bb40e13), JSON_U64(0x2865a5f2, 0x06b06fba),
+    JSON_U64(0x8cbccc09, 0x6f5088cb), JSON_U64(0xf93f87b7, 0x442e45d4),
+    JSON_U64(0xafebff0b, 0xcb24aafe), JSON_U64(0xf78f69a5, 0x1539d749),
+    JSON_U64(0xdbe6fece, 0xbdedd5be), JSON_U64(0xb573440e, 0x5a884d1c),
+    JSON_U64(0x89705f41, 0x36b4a597), JSON_U64(0x31680a88, 0xf8953031),
+    JSON_U64(0xabcc7711, 0x8461cefc), JSON_U64(0xfdc20d2b, 0x36ba7c3e),
+    JSON_U64(0xd6bf94d5, 0xe57a42bc), JSON_U64(0x3d329076, 0x04691b4d),
+    JSON_U64(0x8637bd05, 0xaf6c69b5), JSON_U64(0xa63f9a49, 0xc2c1b110),
+    JSON_U64(0xa7c5ac47, 0x1b478423), JSON_U64(0x0fcf80dc, 0x33721d54),
+    JSON_U64(0xd1b71758, 0xe219652b), JSON_U64(0xd3c36113, 0x404ea4a9),
+    JSON_U64(0x83126e97, 0x8d4fdf3b), JSON_U64(0x645a1cac, 0x083126ea),
+    JSON_U64(0xa3d70a3d, 0x70a3d70a), JSON_U64(0x3d70a3d7, 0x0a3d70a4),
+    JSON_U64(0xcccccccc, 0xcccccccc), JSON_U64(0xcccccccc, 0xcccccccd),
+    JSON_U64(0x80000000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xa0000000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xc8000000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xfa000000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x9c400000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xc3500000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xf4240000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x98968000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xbebc2000, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xee6b2800, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x9502f900, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xba43b740, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xe8d4a510, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x9184e72a, 0x00000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xb5e620f4, 0x80000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xe35fa931, 0xa0000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x8e1bc9bf, 0x04000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xb1a2bc2e, 0xc5000000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xde0b6b3a, 0x76400000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x8ac72304, 0x89e80000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xad78ebc5, 0xac620000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xd8d726b7, 0x177a8000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x87867832, 0x6eac9000), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xa968163f, 0x0a57b400), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xd3c21bce, 0xcceda100), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x84595161, 0x401484a0), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xa56fa5b9, 0x9019a5c8), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0xcecb8f27, 0xf4200f3a), JSON_U64(0x00000000, 0x00000000),
+    JSON_U64(0x813f3978, 0xf8940984), JSON_U64(0x40000000, 0x00000000),
+    JSON_U64(0xa18f07d7, 0x36b90be5), JSON_U64(0x50000000, 0x00000000),
+    JSON_U64(0xc9f2c9cd, 0x04674ede), JSON_U64(0xa4000000, 0x00000000),
+    JSON_U64(0xfc6f7c40, 0x45812296), JSON_U64(0x4d000000, 0x00000000),
+    JSON_U64(0x9dc5ada8, 0x2b70b59d), JSON_U64(0xf0200000, 0x00000000),
+    JSON_U64(0xc5371912, 0x364ce305), JSON_U64(0x6c280000, 0x00000000),
+    JSON_U64(0xf684df56, 0xc3e01bc6), JSON_U64(0xc7320000, 0x00000000),
+    JSON_U64(0x9a130b96, 0x3a6c115c), JSON_U64(0x3c7f4000, 0x00000000),
+    JSON_U64(0xc097ce7b, 0xc90715b3), JSON_U64(0x4b9f1000, 0x00000000),
+    JSON_U64(0xf0bdc21a, 0xbb48db20), JSON_U64(0x1e86d400, 0x00000000),
+    JSON_U64(0x96769950, 0xb50d88f4), JSON_U64(0x13144480, 0x00000000),
+    JSON_U64(0xbc143fa4, 0xe250eb31), JSON_U64(0x17d955a0, 0x00000000),
+    JSON_U64(0xeb194f8e, 0x1ae525fd), JSON_U64(0x5dcfab08, 0x00000000),
+    JSON_U64(0x92efd1b8, 0xd0cf37be), JSON_U64(0x5aa1cae5, 0x00000000),
+    JSON_U64(0xb7abc627, 0x050305ad), JSON_U64(0xf14a3d9e, 0x40000000),
+    JSON_U64(0xe596b7b0, 0xc643c719), JSON_U64(0x6d9ccd05, 0xd0000000),
+    JSON_U64(0x8f7e32ce, 0x7bea5c6f), JSON_U64(0xe4820023, 0xa2000000),
+    JSON_U64(0xb35dbf82, 0x1ae4f38b), JSON_U64(0xdda2802c, 0x8a800000),
+    JSON_U64(0xe0352f62, 0xa19e306e), JSON_U64(0xd50b2037, 0xad200000),
+    JSON_U64(0x8c213d9d, 0xa502de45), JSON_U64(0x4526f422, 0xcc340000),
+    JSON_U64(0xaf298d05, 0x0e4395d6), JSON_U64(0x9670b12b, 0x7f410000),
+    JSON_U64(0xdaf3f046, 0x51d47b4c), JSON_U64(0x3c0cdd76, 0x5f114000),
+    JSON_U64(0x88d8762b, 0xf324cd0f), JSON_U64(0xa5880a69, 0xfb6ac800),
+    JSON_U64(0xab0e93b6, 0xefee0053), JSON_U64(0x8eea0d04, 0x7a457a00),
+    JSON_U64(0xd5d238a4, 0xabe98068), JSON_U64(0x72a49045, 0x98d6d880),
+    JSON_U64(0x85a36366, 0xeb71f041), JSON_U64(0x47a6da2b, 0x7f864750),
+    JSON_U64(0xa70c3c40, 0xa64e6c51), JSON_U64(0x999090b6, 0x5f67d924),
+    JSON_U64(0xd0cf4b50, 0xcfe20765), JSON_U64(0xfff4b4e3, 0xf741cf6d),
+    JSON_U64(0x82818f12, 0x81ed449f), JSON_U64(0xbff8f10e, 0x7a8921a4),
+    JSON_U64(0xa321f2d7, 0x226895c7), JSON_U64(0xaff72d52, 0x192b6a0d),
+    JSON_U64(0xcbea6f8c, 0xeb02bb39), JSON_U64(0x9bf4f8a6, 0x9f764490),
+    JSON_U64(0xfee50b70, 0x25c36a08), JSON_U64(0x02f236d0, 0x4753d5b4),
+    JSON_U64(0x9f4f2726, 0x179a2245), JSON_U64(0x01d76242, 0x2c946590),
+    JSON_U64(0xc722f0ef, 0x9d80aad6), JSON_U64(0x424d3ad2, 0xb7b97ef5),
+    JSON_U64(0xf8ebad2b, 0x84e0d58b), JSON_U64(0xd2e08987, 0x65a7deb2),
+    JSON_U64(0x9b934c3b, 0x330c8577), JSON_U64(0x63cc55f4, 0x9f88eb2f),
+    JSON_U64(0xc2781f49, 0xffcfa6d5), JSON_U64(0x3cbf6b71, 0xc76b25fb),
+    JSON_U64(0xf316271c, 0x7fc3908a), JSON_U64(0x8bef464e, 0x3945ef7a),
+    JSON_U64(0x97edd871, 0xcfda3a56), JSON_U64(0x97758bf0, 0xe3cbb5ac),
+    JSON_U64(0xbde94e8e, 0x43d0c8ec), JSON_U64(0x3d52eeed, 0x1cbea317),
+    JSON_U64(0xed63a231, 0xd4c4fb27), JSON_U64(0x4ca7aaa8, 0x63ee4bdd),
+    JSON_U64(0x945e455f, 0x24fb1cf8), JSON_U64(0x8fe8caa9, 0x3e74ef6a),
+    JSON_U64(0xb975d6b6, 0xee39e436), JSON_U64(0xb3e2fd53, 0x8e122b44),
+    JSON_U64(0xe7d34c64, 0xa9c85d44), JSON_U64(0x60dbbca8, 0x7196b616),
+    JSON_U64(0x90e40fbe, 0xea1d3a4a), JSON_U64(0xbc8955e9, 0x46fe31cd),
+    JSON_U64(0xb51d13ae, 0xa4a488dd), JSON_U64(0x6babab63, 0x98bdbe41),
+    JSON_U64(0xe264589a, 0x4dcdab14), JSON_U64(0xc696963c, 0x7eed2dd1),
+    JSON_U64(0x8d7eb760, 0x70a08aec), JSON_U64(0xfc1e1de5, 0xcf543ca2),
+    JSON_U64(0xb0de6538, 0x8cc8ada8), JSON_U64(0x3b25a55f, 0x43294bcb),
+    JSON_U64(0xdd15fe86, 0xaffad912), JSON_U64(0x49ef0eb7, 0x13f39ebe),
+    JSON_U64(0x8a2dbf14, 0x2dfcc7ab), JSON_U64(0x6e356932, 0x6c784337),
+    JSON_U64(0xacb92ed9, 0x397bf996), JSON_U64(0x49c2c37f, 0x07965404),
+    JSON_U64(0xd7e77a8f, 0x87daf7fb), JSON_U64(0xdc33745e, 0xc97be906),
+    JSON_U64(0x86f0ac99, 0xb4e8dafd), JSON_U64(0x69a028bb, 0x3ded71a3),
+    JSON_U64(0xa8acd7c0, 0x222311bc), JSON_U64(0xc40832ea, 0x0d68ce0c),
+    JSON_U64(0xd2d80db0, 0x2aabd62b), JSON_U64(0xf50a3fa4, 0x90c30190),
+    JSON_U64(0x83c7088e, 0x1aab65db), JSON_U64(0x792667c6, 0xda79e0fa),
+    JSON_U64(0xa4b8cab1, 0xa1563f52), JSON_U64(0x577001b8, 0x91185938),
+    JSON_U64(0xcde6fd5e, 0x09abcf26), JSON_U64(0xed4c0226, 0xb55e6f86),
+    JSON_U64(0x80b05e5a, 0xc60b6178), JSON_U64(0x544f8158, 0x315b05b4),
+    JSON_U64(0xa0dc75f1, 0x778e39d6), JSON_U64(0x696361ae, 0x3db1c721),
+    JSON_U64(0xc913936d, 0xd571c84c), JSON_U64(0x03bc3a19, 0xcd1e38e9),
+    JSON_U64(0xfb587849, 0x4ace3a5f), JSON_U64(0x04ab48a0, 0x4065c723),
+    JSON_U64(0x9d174b2d, 0xcec0e47b), JSON_U64(0x62eb0d64, 0x283f9c76),
+    JSON_U64(0xc45d1df9, 0x42711d9a), JSON_U64(0x3ba5d0bd, 0x324f8394),
+    JSON_U64(0xf5746577, 0x930d6500), JSON_U64(0xca8f44ec, 0x7ee36479),
+    JSON_U64(0x9968bf6a, 0xbbe85f20), JSON_U64(0x7e998b13, 0xcf4e1ecb),
+    JSON_U64(0xbfc2ef45, 0x6ae276e8), JSON_U64(0x9e3fedd8, 0xc321a67e),
+    JSON_U64(0xefb3ab16, 0xc59b14a2), JSON_U64(0xc5cfe94e, 0xf3ea101e),
+    JSON_U64(0x95d04aee, 0x3b80ece5), JSON_U64(0xbba1f1d1, 0x58724a12),
+    JSON_U64(0xbb445da9, 0xca61281f), JSON_U64(0x2a8a6e45, 0xae8edc97),
+    JSON_U64(0xea157514, 0x3cf97226), JSON_U64(0xf52d09d7, 0x1a3293bd),
+    JSON_U64(0x924d692c, 0xa61be758), JSON_U64(0x593c2626, 0x705f9c56),
+    JSON_U64(0xb6e0c377, 0xcfa2e12e), JSON_U64(0x6f8b2fb0, 0x0c77836c),
+    JSON_U64(0xe498f455, 0xc38b997a), JSON_U64(0x0b6dfb9c, 0x0f956447),
+    JSON_U64(0x8edf98b5, 0x9a373fec), JSON_U64(0x4724bd41, 0x89bd5eac),
+    JSON_U64(0xb2977ee3, 0x00c50fe7), JSON_U64(0x58edec91, 0xec2cb657),
+    JSON_U64(0xdf3d5e9b, 0xc0f653e1), JSON_U64(0x2f2967b6, 0x6737e3ed),
+    JSON_U64(0x8b865b21, 0x5899f46c), JSON_U64(0xbd79e0d2, 0x0082ee74),
+    JSON_U64(0xae67f1e9, 0xaec07187), JSON_U64(0xecd85906, 0x80a3aa11),
+    JSON_U64(0xda01ee64, 0x1a708de9), JSON_U64(0xe80e6f48, 0x20cc9495),
+    JSON_U64(0x884134fe, 0x908658b2), JSON_U64(0x3109058d, 0x147fdcdd),
+    JSON_U64(0xaa51823e, 0x34a7eede), JSON_U64(0xbd4b46f0, 0x599fd415),
+    JSON_U64(0xd4e5e2cd, 0xc1d1ea96), JSON_U64(0x6c9e18ac, 0x7007c91a),
+    JSON_U64(0x850fadc0, 0x9923329e), JSON_U64(0x03e2cf6b, 0xc604ddb0),
+    JSON_U64(0xa6539930, 0xbf6bff45), JSON_U64(0x84db8346, 0xb786151c),
+    JSON_U64(0xcfe87f7c, 0xef46ff16), JSON_U64(0xe6126418, 0x65679a63),
+    JSON_U64(0x81f14fae, 0x158c5f6e), JSON_U64(0x4fcb7e8f, 0x3f60c07e),
+    JSON_U64(0xa26da399, 0x9aef7749), JSON_U64(0xe3be5e33, 0x0f38f09d),
+    JSON_U64(0xcb090c80, 0x01ab551c), JSON_U64(0x5cadf5bf, 0xd3072cc5),
+    JSON_U64(0xfdcb4fa0, 0x02162a63), JSON_U64(0x73d9732f, 0xc7c8f7f6),
+    JSON_U64(0x9e9f11c4, 0x014dda7e), JSON_U64(0x2867e7fd, 0xdcdd9afa),
+    JSON_U64(0xc646d635, 0x01a1511d), JSON_U64(0xb281e1fd, 0x541501b8),
+    JSON_U64(0xf7d88bc2, 0x4209a565), JSON_U64(0x1f225a7c, 0xa91a4226),
+    JSON_U64(0x9ae75759, 0x6946075f), JSON_U64(0x3375788d, 0xe9b06958),
+    JSON_U64(0xc1a12d2f, 0xc3978937), JSON_U64(0x0052d6b1, 0x641c83ae),
+    JSON_U64(0xf209787b, 0xb47d6b84), JSON_U64(0xc0678c5d, 0xbd23a49a),
+    JSON_U64(0x9745eb4d, 0x50ce6332), JSON_U64(0xf840b7ba, 0x963646e0),
+    JSON_U64(0xbd176620, 0xa501fbff), JSON_U64(0xb650e5a9, 0x3bc3d898),
+    JSON_U64(0xec5d3fa8, 0xce427aff), JSON_U64(0xa3e51f13, 0x8ab4cebe),
+    JSON_U64(0x93ba47c9, 0x80e98cdf), JSON_U64(0xc66f336c, 0x36b10137),
+    JSON_U64(0xb8a8d9bb, 0xe123f017), JSON_U64(0xb80b0047, 0x445d4184),
+    JSON_U64(0xe6d3102a, 0xd96cec1d), JSON_U64(0xa60dc059, 0x157491e5),
+    JSON_U64(0x9043ea1a, 0xc7e41392), JSON_U64(0x87c89837, 0xad68db2f),
+    JSON_U64(0xb454e4a1, 0x79dd1877), JSON_U64(0x29babe45, 0x98c311fb),
+    JSON_U64(0xe16a1dc9, 0xd8545e94), JSON_U64(0xf4296dd6, 0xfef3d67a),
+    JSON_U64(0x8ce2529e, 0x2734bb1d), JSON_U64(0x1899e4a6, 0x5f58660c),
+    JSON_U64(0xb01ae745, 0xb101e9e4), JSON_U64(0x5ec05dcf, 0xf72e7f8f),
+    JSON_U64(0xdc21a117, 0x1d42645d), JSON_U64(0x76707543, 0xf4fa1f73),
+    JSON_U64(0x899504ae, 0x72497eba), JSON_U64(0x6a06494a, 0x791c53a8),
+    JSON_U64(0xabfa45da, 0x0edbde69), JSON_U64(0x0487db9d, 0x17636892),
+    JSON_U64(0xd6f8d750, 0x9292d603), JSON_U64(0x45a9d284, 0x5d3c42b6),
+    JSON_U64(0x865b8692, 0x5b9bc5c2), JSON_U64(0x0b8a2392, 0xba45a9b2),
+    JSON_U64(0xa7f26836, 0xf282b732), JSON_U64(0x8e6cac77, 0x68d7141e),
+    JSON_U64(0xd1ef0244, 0xaf2364ff), JSON_U64(0x3207d795, 0x430cd926),
+    JSON_U64(0x8335616a, 0xed761f1f), JSON_U64(0x7f44e6bd, 0x49e807b8),
+    JSON_U64(0xa402b9c5, 0xa8d3a6e7), JSON_U64(0x5f16206c, 0x9c6209a6),
+    JSON_U64(0xcd036837, 0x130890a1), JSON_U64(0x36dba887, 0xc37a8c0f),
+    JSON_U64(0x80222122, 0x6be55a64), JSON_U64(0xc2494954, 0xda2c9789),
+    JSON_U64(0xa02aa96b, 0x06deb0fd), JSON_U64(0xf2db9baa, 0x10b7bd6c),
+    JSON_U64(0xc83553c5, 0xc8965d3d), JSON_U64(0x6f928294, 0x94e5acc7),
+    JSON_U64(0xfa42a8b7, 0x3abbf48c), JSON_U64(0xcb772339, 0xba1f17f9),
+    JSON_U64(0x9c69a972, 0x84b578d7), JSON_U64(0xff2a7604, 0x14536efb),
+    JSON_U64(0xc38413cf, 0x25e2d70d), JSON_U64(0xfef51385, 0x19684aba),
+    JSON_U64(0xf46518c2, 0xef5b8cd1), JSON_U64(0x7eb25866, 0x5fc25d69),
+    JSON_U64(0x98bf2f79, 0xd5993802), JSON_U64(0xef2f773f, 0xfbd97a61),
+    JSON_U64(0xbeeefb58, 0x4aff8603), JSON_U64(0xaafb550f, 0xfacfd8fa),
+    JSON_U64(0xeeaaba2e, 0x5dbf6784), JSON_U64(0x95ba2a53, 0xf983cf38),
+    JSON_U64(0x952ab45c, 0xfa97a0b2), JSON_U64(0xdd945a74, 0x7bf26183),
+    JSON_U64(0xba756174, 0x393d88df), JSON_U64(0x94f97111, 0x9aeef9e4),
+    JSON_U64(0xe912b9d1, 0x478ceb17), JSON_U64(0x7a37cd56, 0x01aab85d),
+    JSON_U64(0x91abb422, 0xccb812ee), JSON_U64(0xac62e055, 0xc10ab33a),
+    JSON_U64(0xb616a12b, 0x7fe617aa), JSON_U64(0x577b986b, 0x314d6009),
+    JSON_U64(0xe39c4976, 0x5fdf9d94), JSON_U64(0xed5a7e85, 0xfda0b80b),
+    JSON_U64(0x8e41ade9, 0xfbebc27d), JSON_U64(0x14588f13, 0xbe847307),
+    JSON_U64(0xb1d21964, 0x7ae6b31c), JSON_U64(0x596eb2d8, 0xae258fc8),
+    JSON_U64(0xde469fbd, 0x99a05fe3), JSON_U64(0x6fca5f8e, 0xd9aef3bb),
+    JSON_U64(0x8aec23d6, 0x80043bee), JSON_U64(0x25de7bb9, 0x480d5854),
+    JSON_U64(0xada72ccc, 0x20054ae9), JSON_U64(0xaf561aa7, 0x9a10ae6a),
+    JSON_U64(0xd910f7ff, 0x28069da4), JSON_U64(0x1b2ba151, 0x8094da04),
+    JSON_U64(0x87aa9aff, 0x79042286), JSON_U64(0x90fb44d2, 0xf05d0842),
+    JSON_U64(0xa99541bf, 0x57452b28), JSON_U64(0x353a1607, 0xac744a53),
+    JSON_U64(0xd3fa922f, 0x2d1675f2), JSON_U64(0x42889b89, 0x97915ce8),
+    JSON_U64(0x847c9b5d, 0x7c2e09b7), JSON_U64(0x69956135, 0xfebada11),
+    JSON_U64(0xa59bc234, 0xdb398c25), JSON_U64(0x43fab983, 0x7e699095),
+    JSON_U64(0xcf02b2c2, 0x1207ef2e), JSON_U64(0x94f967e4, 0x5e03f4bb),
+    JSON_U64(0x8161afb9, 0x4b44f57d), JSON_U64(0x1d1be0ee, 0xbac278f5),
+    JSON_U64(0xa1ba1ba7, 0x9e1632dc), JSON_U64(0x6462d92a, 0x69731732),
+    JSON_U64(0xca28a291, 0x859bbf93), JSON_U64(0x7d7b8f75, 0x03cfdcfe),
+    JSON_U64(0xfcb2cb35, 0xe702af78), JSON_U64(0x5cda7352, 0x44c3d43e),
+    JSON_U64(0x9defbf01, 0xb061adab), JSON_U64(0x3a088813, 0x6afa64a7),
+    JSON_U64(0xc56baec2, 0x1c7a1916), JSON_U64(0x088aaa18, 0x45b8fdd0),
+    JSON_U64(0xf6c69a72, 0xa3989f5b), JSON_U64(0x8aad549e, 0x57273d45),
+    JSON_U64(0x9a3c2087, 0xa63f6399), JSON_U64(0x36ac54e2, 0xf678864b),
+    JSON_U64(0xc0cb28a9, 0x8fcf3c7f), JSON_U64(0x84576a1b, 0xb416a7dd),
+    JSON_U64(0xf0fdf2d3, 0xf3c30b9f), JSON_U64(0x656d44a2, 0xa11c51d5),
+    JSON_U64(0x969eb7c4, 0x7859e743), JSON_U64(0x9f644ae5, 0xa4b1b325),
+    JSON_U64(0xbc4665b5, 0x96706114), JSON_U64(0x873d5d9f, 0x0dde1fee),
+    JSON_U64(0xeb57ff22, 0xfc0c7959), JSON_U64(0xa90cb506, 0xd155a7ea),
+    JSON_U64(0x9316ff75, 0xdd87cbd8), JSON_U64(0x09a7f124, 0x42d588f2),
+    JSON_U64(0xb7dcbf53, 0x54e9bece), JSON_U64(0x0c11ed6d, 0x538aeb2f),
+    JSON_U64(0xe5d3ef28, 0x2a242e81), JSON_U64(0x8f1668c8, 0xa86da5fa),
+    JSON_U64(0x8fa47579, 0x1a569d10), JSON_U64(0xf96e017d, 0x694487bc),
+    JSON_U64(0xb38d92d7, 0x60ec4455), JSON_U64(0x37c981dc, 0xc395a9ac),
+    JSON_U64(0xe070f78d, 0x3927556a), JSON_U64(0x85bbe253, 0xf47b1417),
+    JSON_U64(0x8c469ab8, 0x43b89562), JSON_U64(0x93956d74, 0x78ccec8e),
+    JSON_U64(0xaf584166, 0x54a6babb), JSON_U64(0x387ac8d1, 0x970027b2),
+    JSON_U64(0xdb2e51bf, 0xe9d0696a), JSON_U64(0x06997b05, 0xfcc0319e),
+    JSON_U64(0x88fcf317, 0xf22241e2), JSON_U64(0x441fece3, 0xbdf81f03),
+    JSON_U64(0xab3c2fdd, 0xeeaad25a), JSON_U64(0xd527e81c, 0xad7626c3),
+    JSON_U64(0xd60b3bd5, 0x6a5586f1), JSON_U64(0x8a71e223, 0xd8d3b074),
+    JSON_U64(0x85c70565, 0x62757456), JSON_U64(0xf6872d56, 0x67844e49),
+    JSON_U64(0xa738c6be, 0xbb12d16c), JSON_U64(0xb428f8ac, 0x016561db),
+    JSON_U64(0xd106f86e, 0x69d785c7), JSON_U64(0xe13336d7, 0x01beba52),
+    JSON_U64(0x82a45b45, 0x0226b39c), JSON_U64(0xecc00246, 0x61173473),
+    JSON_U64(0xa34d7216, 0x42b06084), JSON_U64(0x27f002d7, 0xf95d0190),
+    JSON_U64(0xcc20ce9b, 0xd35c78a5), JSON_U64(0x31ec038d, 0xf7b441f4),
+    JSON_U64(0xff290242, 0xc83396ce), JSON_U64(0x7e670471, 0x75a15271),
+    JSON_U64(0x9f79a169, 0xbd203e41), JSON_U64(0x0f0062c6, 0xe984d386),
+    JSON_U64(0xc75809c4, 0x2c684dd1), JSON_U64(0x52c07b78, 0xa3e60868),
+    JSON_U64(0xf92e0c35, 0x37826145), JSON_U64(0xa7709a56, 0xccdf8a82),
+    JSON_U64(0x9bbcc7a1, 0x42b17ccb), JSON_U64(0x88a66076, 0x400bb691),
+    JSON_U64(0xc2abf989, 0x935ddbfe), JSON_U64(0x6acff893, 0xd00ea435),
+    JSON_U64(0xf356f7eb, 0xf83552fe), JSON_U64(0x0583f6b8, 0xc4124d43),
+    JSON_U64(0x98165af3, 0x7b2153de), JSON_U64(0xc3727a33, 0x7a8b704a),
+    JSON_U64(0xbe1bf1b0, 0x59e9a8d6), JSON_U64(0x744f18c0, 0x592e4c5c),
+    JSON_U64(0xeda2ee1c, 0x7064130c), JSON_U64(0x1162def0, 0x6f79df73),
+    JSON_U64(0x9485d4d1, 0xc63e8be7), JSON_U64(0x8addcb56, 0x45ac2ba8),
+    JSON_U64(0xb9a74a06, 0x37ce2ee1), JSON_U64(0x6d953e2b, 0xd7173692),
+    JSON_U64(0xe8111c87, 0xc5c1ba99), JSON_U64(0xc8fa8db6, 0xccdd0437),
+    JSON_U64(0x910ab1d4, 0xdb9914a0), JSON_U64(0x1d9c9892, 0x400a22a2),
+    JSON_U64(0xb54d5e4a, 0x127f59c8), JSON_U64(0x2503beb6, 0xd00cab4b),
+    JSON_U64(0xe2a0b5dc, 0x971f303a), JSON_U64(0x2e44ae64, 0x840fd61d),
+    JSON_U64(0x8da471a9, 0xde737e24), JSON_U64(0x5ceaecfe, 0xd289e5d2),
+    JSON_U64(0xb10d8e14, 0x56105dad), JSON_U64(0x7425a83e, 0x872c5f47),
+    JSON_U64(0xdd50f199, 0x6b947518), JSON_U64(0xd12f124e, 0x28f77719),
+    JSON_U64(0x8a5296ff, 0xe33cc92f), JSON_U64(0x82bd6b70, 0xd99aaa6f),
+    JSON_U64(0xace73cbf, 0xdc0bfb7b), JSON_U64(0x636cc64d, 0x1001550b),
+    JSON_U64(0xd8210bef, 0xd30efa5a), JSON_U64(0x3c47f7e0, 0x5401aa4e),
+    JSON_U64(0x8714a775, 0xe3e95c78), JSON_U64(0x65acfaec, 0x34810a71),
+    JSON_U64(0xa8d9d153, 0x5ce3b396), JSON_U64(0x7f1839a7, 0x41a14d0d),
+    JSON_U64(0xd31045a8, 0x341ca07c), JSON_U64(0x1ede4811, 0x1209a050),
+    JSON_U64(0x83ea2b89, 0x2091e44d), JSON_U64(0x934aed0a, 0xab460432),
+    JSON_U64(0xa4e4b66b, 0x68b65d60), JSON_U64(0xf81da84d, 0x5617853f),
+    JSON_U64(0xce1de406, 0x42e3f4b9), JSON_U64(0x36251260, 0xab9d668e),
+    JSON_U64(0x80d2ae83, 0xe9ce78f3), JSON_U64(0xc1d72b7c, 0x6b426019),
+    JSON_U64(0xa1075a24, 0xe4421730), JSON_U64(0xb24cf65b, 0x8612f81f),
+    JSON_U64(0xc94930ae, 0x1d529cfc), JSON_U64(0xdee033f2, 0x6797b627),
+    JSON_U64(0xfb9b7cd9, 0xa4a7443c), JSON_U64(0x169840ef, 0x017da3b1),
+    JSON_U64(0x9d412e08, 0x06e88aa5), JSON_U64(0x8e1f2895, 0x60ee864e),
+    JSON_U64(0xc491798a, 0x08a2ad4e), JSON_U64(0xf1a6f2ba, 0xb92a27e2),
+    JSON_U64(0xf5b5d7ec, 0x8acb58a2), JSON_U64(0xae10af69, 0x6774b1db),
+    JSON_U64(0x9991a6f3, 0xd6bf1765), JSON_U64(0xacca6da1, 0xe0a8ef29),
+    JSON_U64(0xbff610b0, 0xcc6edd3f), JSON_U64(0x17fd090a, 0x58d32af3),
+    JSON_U64(0xeff394dc, 0xff8a948e), JSON_U64(0xddfc4b4c, 0xef07f5b0),
+    JSON_U64(0x95f83d0a, 0x1fb69cd9), JSON_U64(0x4abdaf10, 0x1564f98e),
+    JSON_U64(0xbb764c4c, 0xa7a4440f), JSON_U64(0x9d6d1ad4, 0x1abe37f1),
+    JSON_U64(0xea53df5f, 0xd18d5513), JSON_U64(0x84c86189, 0x216dc5ed),
+    JSON_U64(0x92746b9b, 0xe2f8552c), JSON_U64(0x32fd3cf5, 0xb4e49bb4),
+    JSON_U64(0xb7118682, 0xdbb66a77), JSON_U64(0x3fbc8c33, 0x221dc2a1),
+    JSON_U64(0xe4d5e823, 0x92a40515), JSON_U64(0x0fabaf3f, 0xeaa5334a),
+    JSON_U64(0x8f05b116, 0x3ba6832d), JSON_U64(0x29cb4d87, 0xf2a7400e),
+    JSON_U64(0xb2c71d5b, 0xca9023f8), JSON_U64(0x743e20e9, 0xef511012),
+    JSON_U64(0xdf78e4b2, 0xbd342cf6), JSON_U64(0x914da924, 0x6b255416),
+    JSON_U64(0x8bab8eef, 0xb6409c1a), JSON_U64(0x1ad089b6, 0xc2f7548e),
+    JSON_U64(0xae9672ab, 0xa3d0c320), JSON_U64(0xa184ac24, 0x73b529b1),
+    JSON_U64(0xda3c0f56, 0x8cc4f3e8), JSON_U64(0xc9e5d72d, 0x90a2741e),
+    JSON_U64(0x88658996, 0x17fb1871), JSON_U64(0x7e2fa67c, 0x7a658892),
+    JSON_U64(0xaa7eebfb, 0x9df9de8d), JSON_U64(0xddbb901b, 0x98feeab7),
+    JSON_U64(0xd51ea6fa, 0x85785631), JSON_U64(0x552a7422, 0x7f3ea565),
+    JSON_U64(0x8533285c, 0x936b35de), JSON_U64(0xd53a8895, 0x8f87275f),
+    JSON_U64(0xa67ff273, 0xb8460356), JSON_U64(0x8a892aba, 0xf368f137),
+    JSON_U64(0xd01fef10, 0xa657842c), JSON_U64(0x2d2b7569, 0xb0432d85),
+    JSON_U64(0x8213f56a, 0x67f6b29b), JSON_U64(0x9c3b2962, 0x0e29fc73),
+    JSON_U64(0xa298f2c5, 0x01f45f42), JSON_U64(0x8349f3ba, 0x91b47b8f),
+    JSON_U64(0xcb3f2f76, 0x42717713), JSON_U64(0x241c70a9, 0x36219a73),
+    JSON_U64(0xfe0efb53, 0xd30dd4d7), JSON_U64(0xed238cd3, 0x83aa0110),
+    JSON_U64(0x9ec95d14, 0x63e8a506), JSON_U64(0xf4363804, 0x324a40aa),
+    JSON_U64(0xc67bb459, 0x7ce2ce48), JSON_U64(0xb143c605, 0x3edcd0d5),
+    JSON_U64(0xf81aa16f, 0xdc1b81da), JSON_U64(0xdd94b786, 0x8e94050a),
+    JSON_U64(0x9b10a4e5, 0xe9913128), JSON_U64(0xca7cf2b4, 0x191c8326),
+    JSON_U64(0xc1d4ce1f, 0x63f57d72), JSON_U64(0xfd1c2f61, 0x1f63a3f0),
+    JSON_U64(0xf24a01a7, 0x3cf2dccf), JSON_U64(0xbc633b39, 0x673c8cec),
+    JSON_U64(0x976e4108, 0x8617ca01), JSON_U64(0xd5be0503, 0xe085d813),
+    JSON_U64(0xbd49d14a, 0xa79dbc82), JSON_U64(0x4b2d8644, 0xd8a74e18),
+    JSON_U64(0xec9c459d, 0x51852ba2), JSON_U64(0xddf8e7d6, 0x0ed1219e),
+    JSON_U64(0x93e1ab82, 0x52f33b45), JSON_U64(0xcabb90e5, 0xc942b503),
+    JSON_U64(0xb8da1662, 0xe7b00a17), JSON_U64(0x3d6a751f, 0x3b936243),
+    JSON_U64(0xe7109bfb, 0xa19c0c9d), JSON_U64(0x0cc51267, 0x0a783ad4),
+    JSON_U64(0x906a617d, 0x450187e2), JSON_U64(0x27fb2b80, 0x668b24c5),
+    JSON_U64(0xb484f9dc, 0x9641e9da), JSON_U64(0xb1f9f660, 0x802dedf6),
+    JSON_U64(0xe1a63853, 0xbbd26451), JSON_U64(0x5e7873f8, 0xa0396973),
+    JSON_U64(0x8d07e334, 0x55637eb2), JSON_U64(0xdb0b487b, 0x6423e1e8),
+    JSON_U64(0xb049dc01, 0x6abc5e5f), JSON_U64(0x91ce1a9a, 0x3d2cda62),
+    JSON_U64(0xdc5c5301, 0xc56b75f7), JSON_U64(0x7641a140, 0xcc7810fb),
+    JSON_U64(0x89b9b3e1, 0x1b6329ba), JSON_U64(0xa9e904c8, 0x7fcb0a9d),
+    JSON_U64(0xac2820d9, 0x623bf429), JSON_U64(0x546345fa, 0x9fbdcd44),
+    JSON_U64(0xd732290f, 0xbacaf133), JSON_U64(0xa97c1779, 0x47ad4095),
+    JSON_U64(0x867f59a9, 0xd4bed6c0), JSON_U64(0x49ed8eab, 0xcccc485d),
+    JSON_U64(0xa81f3014, 0x49ee8c70), JSON_U64(0x5c68f256, 0xbfff5a74),
+    JSON_U64(0xd226fc19, 0x5c6a2f8c), JSON_U64(0x73832eec, 0x6fff3111),
+    JSON_U64(0x83585d8f, 0xd9c25db7), JSON_U64(0xc831fd53, 0xc5ff7eab),
+    JSON_U64(0xa42e74f3, 0xd032f525), JSON_U64(0xba3e7ca8, 0xb77f5e55),
+    JSON_U64(0xcd3a1230, 0xc43fb26f), JSON_U64(0x28ce1bd2, 0xe55f35eb),
+    JSON_U64(0x80444b5e, 0x7aa7cf85), JSON_U64(0x7980d163, 0xcf5b81b3),
+    JSON_U64(0xa0555e36, 0x1951c366), JSON_U64(0xd7e105bc, 0xc332621f),
+    JSON_U64(0xc86ab5c3, 0x9fa63440), JSON_U64(0x8dd9472b, 0xf3fefaa7),
+    JSON_U64(0xfa856334, 0x878fc150), JSON_U64(0xb14f98f6, 0xf0feb951),
+    JSON_U64(0x9c935e00, 0xd4b9d8d2), JSON_U64(0x6ed1bf9a, 0x569f33d3),
+    JSON_U64(0xc3b83581, 0x09e84f07), JSON_U64(0x0a862f80, 0xec4700c8),
+    JSON_U64(0xf4a642e1, 0x4c6262c8), JSON_U64(0xcd27bb61, 0x2758c0fa),
+    JSON_U64(0x98e7e9cc, 0xcfbd7dbd), JSON_U64(0x8038d51c, 0xb897789c),
+    JSON_U64(0xbf21e440, 0x03acdd2c), JSON_U64(0xe0470a63, 0xe6bd56c3),
+    JSON_U64(0xeeea5d50, 0x04981478), JSON_U64(0x1858ccfc, 0xe06cac74),
+    JSON_U64(0x95527a52, 0x02df0ccb), JSON_U64(0x0f37801e, 0x0c43ebc8),
+    JSON_U64(0xbaa718e6, 0x8396cffd), JSON_U64(0xd3056025, 0x8f54e6ba),
+    JSON_U64(0xe950df20, 0x247c83fd), JSON_U64(0x47c6b82e, 0xf32a2069),
+    JSON_U64(0x91d28b74, 0x16cdd27e), JSON_U64(0x4cdc331d, 0x57fa5441),
+    JSON_U64(0xb6472e51, 0x1c81471d), JSON_U64(0xe0133fe4, 0xadf8e952),
+    JSON_U64(0xe3d8f9e5, 0x63a198e5), JSON_U64(0x58180fdd, 0xd97723a6),
+    JSON_U64(0x8e679c2f, 0x5e44ff8f), JSON_U64(0x570f09ea, 0xa7ea7648),
+    JSON_U64(0xb201833b, 0x35d63f73), JSON_U64(0x2cd2cc65, 0x51e513da),
+    JSON_U64(0xde81e40a, 0x034bcf4f), JSON_U64(0xf8077f7e, 0xa65e58d1),
+    JSON_U64(0x8b112e86, 0x420f6191), JSON_U64(0xfb04afaf, 0x27faf782),
+    JSON_U64(0xadd57a27, 0xd29339f6), JSON_U64(0x79c5db9a, 0xf1f9b563),
+    JSON_U64(0xd94ad8b1, 0xc7380874), JSON_U64(0x18375281, 0xae7822bc),
+    JSON_U64(0x87cec76f, 0x1c830548), JSON_U64(0x8f229391, 0x0d0b15b5),
+    JSON_U64(0xa9c2794a, 0xe3a3c69a), JSON_U64(0xb2eb3875, 0x504ddb22),
+    JSON_U64(0xd433179d, 0x9c8cb841), JSON_U64(0x5fa60692, 0xa46151eb),
+    JSON_U64(0x849feec2, 0x81d7f328), JSON_U64(0xdbc7c41b, 0xa6bcd333),
+    JSON_U64(0xa5c7ea73, 0x224deff3), JSON_U64(0x12b9b522, 0x906c0800),
+    JSON_U64(0xcf39e50f, 0xeae16bef), JSON_U64(0xd768226b, 0x34870a00),
+    JSON_U64(0x81842f29, 0xf2cce375), JSON_U64(0xe6a11583, 0x00d46640),
+    JSON_U64(0xa1e53af4, 0x6f801c53), JSON_U64(0x60495ae3, 0xc1097fd0),
+    JSON_U64(0xca5e89b1, 0x8b602368), JSON_U64(0x385bb19c, 0xb14bdfc4),
+    JSON_U64(0xfcf62c1d, 0xee382c42), JSON_U64(0x46729e03, 0xdd9ed7b5),
+    JSON_U64(0x9e19db92, 0xb4e31ba9), JSON_U64(0x6c07a2c2, 0x6a8346d1),
+    JSON_U64(0xc5a05277, 0x621be293), JSON_U64(0xc7098b73, 0x05241885),
+    JSON_U64(0xf7086715, 0x3aa2db38), JSON_U64(0xb8cbee4f, 0xc66d1ea7),
+    JSON_U64(0x9a65406d, 0x44a5c903), JSON_U64(0x737f74f1, 0xdc043328),
+    JSON_U64(0xc0fe9088, 0x95cf3b44), JSON_U64(0x505f522e, 0x53053ff2),
+    JSON_U64(0xf13e34aa, 0xbb430a15), JSON_U64(0x647726b9, 0xe7c68fef),
+    JSON_U64(0x96c6e0ea, 0xb509e64d), JSON_U64(0x5eca7834, 0x30dc19f5),
+    JSON_U64(0xbc789925, 0x624c5fe0), JSON_U64(0xb67d1641, 0x3d132072),
+    JSON_U64(0xeb96bf6e, 0xbadf77d8), JSON_U64(0xe41c5bd1, 0x8c57e88f),
+    JSON_U64(0x933e37a5, 0x34cbaae7), JSON_U64(0x8e91b962, 0xf7b6f159),
+    JSON_U64(0xb80dc58e, 0x81fe95a1), JSON_U64(0x723627bb, 0xb5a4adb0),
+    JSON_U64(0xe61136f2, 0x227e3b09), JSON_U64(0xcec3b1aa, 0xa30dd91c),
+    JSON_U64(0x8fcac257, 0x558ee4e6), JSON_U64(0x213a4f0a, 0xa5e8a7b1),
+    JSON_U64(0xb3bd72ed, 0x2af29e1f), JSON_U64(0xa988e2cd, 0x4f62d19d),
+    JSON_U64(0xe0accfa8, 0x75af45a7), JSON_U64(0x93eb1b80, 0xa33b8605),
+    JSON_U64(0x8c6c01c9, 0x498d8b88), JSON_U64(0xbc72f130, 0x660533c3),
+    JSON_U64(0xaf87023b, 0x9bf0ee6a), JSON_U64(0xeb8fad7c, 0x7f8680b4),
+    JSON_U64(0xdb68c2ca, 0x82ed2a05), JSON_U64(0xa67398db, 0x9f6820e1)};
+JSON_INTERN int
+json_clz(json_mask m)
 {
-    int ineg, eneg, len;
-    const char *cur;
-    json_number i, f, e, p;
-    enum {INT, FLT, EXP, TOKS};
-    struct json_token nums[TOKS];
-    struct json_token *write = &nums[INT];
-
-    JSON_ASSERT(num);
-    JSON_ASSERT(tok);
-    if (!num || !tok || !tok->str || !tok->len)
-        return JSON_NONE;
-
-    nums[INT] = JSON_TOKEN_NULL;
-    nums[FLT] = JSON_TOKEN_NULL;
-    nums[EXP] = JSON_TOKEN_NULL;
-    len = tok->len;
-    write->str = tok->str;
-
-    for (cur = tok->str; len; cur++, len--) {
-        char state =  json_go_num[*(const unsigned char*)cur];
-        switch (state) {
-            case JSON_STATE_NUM_FAILED:
-                return JSON_NONE;
-            case JSON_STATE_NUM_FLT: {
-                write->len = (int)(cur - write->str);
-                write = &nums[FLT];
-                write->str = cur + 1;
-            } break;
-            case JSON_STATE_NUM_EXP: {
-                write->len = (int)(cur - write->str);
-                write = &nums[EXP];
-                write->str = cur + 1;
-            } break;
-            case JSON_STATE_NUM_BREAK: {len = 1;} break;
-            default: break;
-        }
-    } write->len = (int)(cur - write->str);
-
-    i = json_stoi(&ineg, &nums[INT]);
-    f = json_stof(&nums[FLT]);
-    e = json_stoi(&eneg, &nums[EXP]);
-    p = json_ipow(10, (unsigned)(eneg ? -e : e));
-    if (eneg) p = (1 / p);
-    *num = (i + (ineg ? -f : f)) * p;
-    return JSON_NUMBER;
+    /* index of the highest set bit counted from the top (m must not be zero) */
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long r = 0;
+    _BitScanReverse64(&r, m);
+    return 63 - (int)r;
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(m);
+#else
+    int n = 0;
+    while (!(m & JSON_U64(0x80000000, 0x00000000))) {m <<= 1; n++;}
+    return n;
+#endif
 }
-JSON_API int
-json_cpy(char *dst, int max, const struct json_token* tok)
+JSON_INTERN json_mask
+json_mul128(json_mask a, json_mask b, json_mask *hi)
 {
-    int i = 0;
-    int ret;
-    int siz;
+    /* full 64x64 bit multiplication returning the low and storing the high half */
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (json_mask)(r >> 64);
+    return (json_mask)r;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, hi);
+#else
+    json_mask al = a & 0xFFFFFFFF, ah = a >> 32;
+    json_mask bl = b & 0xFFFFFFFF, bh = b >> 32;
+    json_mask ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    json_mask mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | (ll & 0xFFFFFFFF);
+#endif
+}
+JSON_INTERN double
+json_bits_to_double(json_mask bits, int neg)
+{
+    union {json_mask u; double d;} v;
+    v.u = bits | ((json_mask)(neg != 0) << 63);
+    return v.d;
+}
+JSON_INTERN json_mask
+json_load8(const char *s)
+{
+    /* little endian load of eight bytes (folds into a single load) */
+    const unsigned char *p = (const unsigned char*)s;
+    return (json_mask)p[0] | ((json_mask)p[1] << 8) | ((json_mask)p[2] << 16) |
+        ((json_mask)p[3] << 24) | ((json_mask)p[4] << 32) | ((json_mask)p[5] << 40) |
+        ((json_mask)p[6] << 48) | ((json_mask)p[7] << 56);
+}
+JSON_INTERN int
+json_is_digits8(json_mask v)
+{
+    /* all eight bytes are in '0'..'9' */
+    return !(((v + JSON_U64(0x46464646, 0x46464646)) | (v - JSON_U64(0x30303030, 0x30303030))) &
+        JSON_U64(0x80808080, 0x80808080));
+}
+JSON_INTERN json_mask
+json_digits8(json_mask v)
+{
+    /* eight ascii digits to their value: pairs, then quads, then the result */
+    v -= JSON_U64(0x30303030, 0x30303030);
+    v = (v * 10) + (v >> 8);
+    v = (((v & JSON_U64(0x000000FF, 0x000000FF)) * JSON_U64(0x000F4240, 0x00000064)) +
+        (((v >> 16) & JSON_U64(0x000000FF, 0x000000FF)) * JSON_U64(0x00002710, 0x00000001))) >> 32;
+    return v & 0xFFFFFFFF;
+}
+JSON_INTERN const char*
+json_parse_u64(json_mask *res, const char *s, const char *end)
+{
+    /* parses decimal digits eight at a time into a 64-bit integer. Returns the
+     end of the digits or NULL if the value does not fit */
+    const char *b;
+    json_mask v = 0;
+    while (s < end && *s == '0') s++;
+    for (b = s; end - s >= 8 && s - b < 16 && json_is_digits8(json_load8(s)); s += 8)
+        v = v * 100000000 + json_digits8(json_load8(s));
+    for (; s < end && *s >= '0' && *s <= '9'; ++s) {
+        unsigned d = (unsigned)(*s - '0');
+        if (s - b >= 19 && (s - b > 19 || v > (JSON_U64(0xFFFFFFFF, 0xFFFFFFFF) - d) / 10))
+            return 0;
+        v = v * 10 + d;
+    }
+    *res = v;
+    return s;
+}
+JSON_INTERN int
+json_parse_int(json_mask *res, int *neg, const struct json_token *tok)
+{
+    /* integer token without fraction or exponent into magnitude and sign */
+    const char *s = tok->str, *end = tok->str + tok->len, *e;
+    *neg = (s < end && *s == '-');
+    s += *neg;
+    if (s == end || *s < '0' || *s > '9')
+        return 0;
+    if (!(e = json_parse_u64(res, s, end)))
+        return 0;
+    return e == end || json_go_num[*(const unsigned char*)e] == JSON_STATE_NUM_BREAK;
+}
+JSON_INTERN const char*
+json_parse_digits(struct json_decimal *d, int *nd, const char *s,
+    const char *end, int frac)
+{
+    /* accumulates a run of digits into at most 19 significant ones, eight at
+     a time when possible. Fraction digits lower the exponent, dropped
+     integer digits raise it */
+    json_mask v;
+    for (; !d->w && s < end && *s == '0'; ++s)
+        d->q -= frac;
+    for (; *nd <= 11 && end - s >= 8 && json_is_digits8(v = json_load8(s)); s += 8) {
+        d->w = d->w * 100000000 + json_digits8(v);
+        *nd += 8, d->q -= 8 * frac;
+    }
+    for (; s < end && *s >= '0' && *s <= '9'; ++s) {
+        if (*nd < 19) {
+            d->w = d->w * 10 + (json_mask)(*s - '0');
+            *nd += 1, d->q -= frac;
+        } else d->q += !frac, d->many |= (*s != '0');
+    } return s;
+}
+JSON_INTERN int
+json_parse_decimal(struct json_decimal *d, const char *s, int len)
+{
+    /* splits a number token into significant digits and exponent. Whitespace
+     terminates the number like before */
+    const char *end = s + len, *b;
+    int nd = 0, any = 0, e = 0, eneg = 0;
+    d->w = 0, d->q = 0, d->neg = 0;
+    d->many = 0, d->exp = 0;
+    if (s < end && (*s == '-' || *s == '+'))
+        d->neg = (*s++ == '-');
 
-    JSON_ASSERT(dst);
-    JSON_ASSERT(tok);
-    if (!dst || !max || !tok)
+    d->digits = s;
+    s = json_parse_digits(d, &nd, b = s, end, 0);
+    any = (s != b);
+    if (s < end && *s == '.') {
+        s = json_parse_digits(d, &nd, b = s + 1, end, 1);
+        any |= (s != b);
+    }
+    d->end = s;
+    if (!any) return 0;
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        if (++s < end && (*s == '-' || *s == '+'))
+            eneg = (*s++ == '-');
+        if (s == end || *s < '0' || *s > '9')
+            return 0;
+        for (; s < end && *s >= '0' && *s <= '9'; ++s)
+            if (e < 100000) e = e * 10 + (*s - '0');
+        d->exp = eneg ? -e : e;
+        d->q += d->exp;
+    }
+    if (s < end && json_go_num[*(const unsigned char*)s] != JSON_STATE_NUM_BREAK)
         return 0;
+    return 1;
+}
+JSON_INTERN json_mask
+json_lemire(json_mask w, int q)
+{
+    /* Eisel-Lemire: rounds w * 10^q for w with at most 19 digits to the
+     nearest double and returns its bit pattern. Multiplies by a truncated
+     128-bit power of five which was proven sufficient for this input range */
+    json_mask lo, hi, hi2, m;
+    int lz, up, shift, p2;
+    if (!w || q < -342) return 0;
+    if (q > 308) return JSON_U64(0x7FF00000, 0x00000000);
 
-    ret = (max < (tok->len + 1)) ? max : tok->len;
-    siz = (max < (tok->len + 1)) ? max-1 : tok->len;
-    for (i = 0; i < siz; i++)
-        dst[i] = tok->str[i];
-    dst[siz] = '\0';
-    return ret;
+    lz = json_clz(w);
+    w <<= lz;
+    lo = json_mul128(w, json_pow5[2*(q+342)], &hi);
+    if ((hi & 0x1FF) == 0x1FF) {
+        json_mul128(w, json_pow5[2*(q+342)+1], &hi2);
+        lo += hi2;
+        if (hi2 > lo) hi++;
+    }
+    up = (int)(hi >> 63);
+    shift = up + 9;
+    m = hi >> shift;
+    p2 = (((152170 + 65536) * q) >> 16) + 63 + up - lz + 1023;
+    if (p2 <= 0) {
+        /* subnormal: a carry into bit 52 gives the smallest normal */
+        if (-p2 + 1 >= 64) return 0;
+        m >>= -p2 + 1;
+        m += m & 1;
+        return m >> 1;
+    }
+    /* exactly halfway between two doubles: round to even */
+    if (lo <= 1 && q >= -4 && q <= 23 && (m & 3) == 1 && (m << shift) == hi)
+        m &= ~(json_uint)1;
+    m += m & 1;
+    m >>= 1;
+    if (m >= ((json_uint)2 << 52)) {
+        m = (json_uint)1 << 52;
+        p2++;
+    }
+    m &= ~((json_uint)1 << 52);
+    if (p2 >= 0x7FF) return JSON_U64(0x7FF00000, 0x00000000);
+    return m | ((json_mask)p2 << 52);
 }
-JSON_API int
-json_cmp(const struct json_token* tok, const char* str)
+/* big integer for the slow path (768 digits scaled down to the smallest
+ subnormal need about 3630 bits) */
+#define JSON_BIG_LIMBS 140
+struct json_big {int n; unsigned d[JSON_BIG_LIMBS];};
+
+JSON_INTERN void
+json_big_muladd(struct json_big *b, unsigned mul, unsigned add)
 {
     int i;
-    JSON_ASSERT(tok);
-    JSON_ASSERT(str);
-    if (!tok || !str) return 1;
-    for (i = 0; (i < tok->len); i++, str++){
-        if (tok->str[i] != *str)
-            return 1;
-    } return *str == '\0' ? 0 : 1;
+    json_mask c = add;
+    for (i = 0; i < b->n; ++i) {
+        c += (json_mask)b->d[i] * mul;
+        b->d[i] = (unsigned)c;
+        c >>= 32;
+    }
+    if (c && b->n < JSON_BIG_LIMBS)
+        b->d[b->n++] = (unsigned)c;
 }
-/*--------------------------------------------------------------------------
-                                TOKENIZER
-  -------------------------------------------------------------------------*/
-JSON_API struct json_iter
-json_begin(const char *str, int len)
+JSON_INTERN void
+json_big_pow5(struct json_big *b, int n)
 {
-    struct json_iter iter = JSON_ITER_NULL;
-    iter.src = str; iter.len = len;
-    return iter;
+    static const unsigned p5[14] = {1,5,25,125,625,3125,15625,78125,390625,
+        1953125,9765625,48828125,244140625,1220703125};
+    for (; n >= 13; n -= 13)
+        json_big_muladd(b, p5[13], 0);
+    if (n) json_big_muladd(b, p5[n], 0);
 }
-JSON_API struct json_iter
-json_read(struct json_token *obj, const struct json_iter* prev)
+JSON_INTERN void
+json_big_shl(struct json_big *b, int n)
 {
-    int len;
-    const char *cur;
-    unsigned char c = 0;
-    int utf8_remain = 0;
-    struct json_iter iter;
-
-    JSON_ASSERT(obj);
-    JSON_ASSERT(prev);
-    if (!prev || !obj || !prev->src || !prev->len || prev->err) {
-        /* case either invalid iterator or eof  */
-        struct json_iter it = JSON_ITER_NULL;
-        *obj = JSON_TOKEN_NULL;
-        it.err = 1;
-        return it;
+    int i, w = n >> 5, s = n & 31;
+    if (!b->n || !n || b->n + w + 1 > JSON_BIG_LIMBS)
+        return;
+    if (s) {
+        b->d[b->n] = 0;
+        for (i = b->n; i > 0; --i)
+            b->d[i] = (b->d[i] << s) | (b->d[i-1] >> (32 - s));
+        b->d[0] <<= s;
+        b->n += (b->d[b->n] != 0);
     }
-    iter = *prev;
-    *obj = JSON_TOKEN_NULL;
-    iter.err = 0;
-    if (!iter.go) /* begin of parsing process */
-        iter.go = json_go_struct;
+    for (i = b->n - 1; i >= 0 && w; --i)
+        b->d[i + w] = b->d[i];
+    for (i = 0; i < w; ++i)
+        b->d[i] = 0;
+    b->n += w;
+}
+JSON_INTERN int
+json_big_cmp(const struct json_big *a, const struct json_big *b)
+{
+    int i;
+    if (a->n != b->n)
+        return a->n < b->n ? -1 : 1;
+    for (i = a->n - 1; i >= 0; --i)
+        if (a->d[i] != b->d[i])
+            return a->d[i] < b->d[i] ? -1 : 1;
+    return 0;
+}
+JSON_INTERN int
+json_big_digits(struct json_big *b, const struct json_decimal *d)
+{
+    /* loads up to 768 significant digits (enough to tell any two halfway points
+     apart) plus a sticky digit for the rest and returns the decimal exponent */
+    const char *s;
+    int nd = 0, frac = 0, e = d->exp, k = 0, sticky = 0;
+    unsigned acc = 0;
+    b->n = 0;
+    for (s = d->digits; s < d->end; ++s) {
+        if (*s == '.') {frac = 1; continue;}
+        if (!nd && *s == '0') {e -= frac; continue;}
+        if (nd < 768) {
+            acc = acc * 10 + (unsigned)(*s - '0');
+            nd++, e -= frac;
+            if (++k == 9) {
+                json_big_muladd(b, 1000000000u, acc);
+                acc = 0, k = 0;
+            }
+        } else e += !frac, sticky |= (*s != '0');
+    }
+    if (sticky) acc = acc * 10 + 1, k++, e--;
+    if (k) json_big_muladd(b, (unsigned)json_pow10[k], acc);
+    return e;
+}
+JSON_INTERN int
+json_big_halfway(const struct json_big *digits, int e, json_mask bits)
+{
+    /* compares digits * 10^e against the midpoint between bits and bits+1 */
+    struct json_big a = *digits, h;
+    int ex = (int)(bits >> 52);
+    json_mask m = bits & (((json_uint)1 << 52) - 1);
+    int k;
+    if (ex) m |= (json_uint)1 << 52;
+    m = 2 * m + 1;
+    k = (ex ? ex : 1) - 1076;
 
-    len = iter.len;
-    for (cur = iter.src; len; cur++, len--) {
-        const unsigned char *tbl = (const unsigned char*)iter.go;
-        c = (unsigned char)*cur;
+    h.d[0] = (unsigned)m;
+    h.d[1] = (unsigned)(m >> 32);
+    h.n = h.d[1] ? 2 : 1;
+    if (e >= 0) json_big_pow5(&a, e);
+    else json_big_pow5(&h, -e);
+    if (e - k > 0) json_big_shl(&a, e - k);
+    else json_big_shl(&h, k - e);
+    return json_big_cmp(&a, &h);
+}
+JSON_INTERN json_mask
+json_slow_float(const struct json_decimal *d, json_mask bits)
+{
+    /* correct rounding for more than 19 digits: moves the close estimate one
+     double at a time by comparing against exact halfway points */
+    struct json_big digits;
+    int c, e = json_big_digits(&digits, d);
+    for (;;) {
+        if (bits < JSON_U64(0x7FF00000, 0x00000000)) {
+            c = json_big_halfway(&digits, e, bits);
+            if (c > 0 || (c == 0 && (bits & 1))) {bits++; continue;}
+        }
+        if (bits > 0) {
+            c = json_big_halfway(&digits, e, bits - 1);
+            if (c < 0 || (c == 0 && (bits & 1))) {bits--; continue;}
+        } break;
+    } return bits;
+}
+JSON_INTERN double
+json_decimal_to_double(const struct json_decimal *d)
+{
+    json_mask bits;
+    if (!d->many) {
+        /* integers convert exactly (correctly rounded above 2^53) and short
+         decimals are exact in a single operation */
+        double v = (double)d->w;
+        if (d->q == 0) return d->neg ? -v : v;
+#if !defined(__FLT_EVAL_METHOD__) || __FLT_EVAL_METHOD__ == 0
+        if (d->q < 0 && d->q >= -22 && d->w <= ((json_uint)1 << 53)) {
+            v = v / json_pow10[-d->q];
+            return d->neg ? -v : v;
+        } else if (d->q > 0 && d->q <= 22 && d->w <= ((json_uint)1 << 53)) {
+            v = v * json_pow10[d->q];
+            return d->neg ? -v : v;
+        }
+#endif
+    }
+
+    bits = json_lemire(d->w, d->q);
+    if (d->many && bits != json_lemire(d->w + 1, d->q))
+        bits = json_slow_float(d, bits);
+    return json_bits_to_double(bits, d->neg);
+}
+/*--------------------------------------------------------------------------
+                                UTILITY
+  -------------------------------------------------------------------------*/
+JSON_INTERN int
+json_string_run(const char *str, int len)
+{
+    /* length of the leading run of plain string bytes: printable ASCII
+     without quote and backslash, which the string table only loops over */
+    int i = 0;
+#if defined(JSON_SIMD_AVX2)
+    const __m256i c1f = _mm256_set1_epi8(0x1F);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(str + i));
+        __m256i x = _mm256_or_si256(_mm256_cmpeq_epi8(v, del),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, bslash)));
+        unsigned m = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, c1f)) |
+            (unsigned)_mm256_movemask_epi8(x);
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_SSE2)
+    const __m128i c1f = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(str + i));
+        __m128i x = _mm_or_si128(_mm_cmpeq_epi8(v, del),
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)));
+        unsigned m = (~(unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, c1f)) & 0xFFFF) |
+            (unsigned)_mm_movemask_epi8(x);
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_NEON)
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8((const unsigned char*)str + i);
+        uint8x16_t x = vorrq_u8(vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)),
+            vcgeq_u8(v, vdupq_n_u8(0x7F))), vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')),
+            vceqq_u8(v, vdupq_n_u8('\\'))));
+        json_mask m = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(x), 4)), 0);
+        if (m) return i + (json_ctz(m) >> 2);
+    }
+#else
+    for (; i + 8 <= len; i += 8) {
+        /* control bytes, bytes >= 0x7F, quotes and backslashes */
+        const json_mask ones = JSON_U64(0x01010101, 0x01010101);
+        const json_mask high = JSON_U64(0x80808080, 0x80808080);
+        json_mask v = json_load8(str + i);
+        json_mask q = v ^ JSON_U64(0x22222222, 0x22222222);
+        json_mask b = v ^ JSON_U64(0x5C5C5C5C, 0x5C5C5C5C);
+        json_mask z = ((v - JSON_U64(0x20202020, 0x20202020)) & ~v) |
+            (((v & ~high) + ones) | v) |
+            ((q - ones) & ~q) | ((b - ones) & ~b);
+        z &= high;
+        if (z) return i + (json_ctz(z) >> 3);
+    }
+#endif
+    for (; i < len; ++i)
+        if (json_go_string[(unsigned char)str[i]] != JSON_STATE_LOOP) break;
+    return i;
+}
+JSON_INTERN int
+json_unescape_run(char *dst, int room, const char *str, int len)
+{
+    /* length of the run up to the next backslash. Bytes of the run are
+     copied into dst while searching as long as they fit into room */
+    int i = 0;
+#if defined(JSON_SIMD_AVX2)
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    for (; i + 32 <= len && i + 32 <= room; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(str + i));
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, bslash));
+        _mm256_storeu_si256((__m256i*)(void*)(dst + i), v);
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_SSE2)
+    const __m128i bslash = _mm_set1_epi8('\\');
+    for (; i + 16 <= len && i + 16 <= room; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(str + i));
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash));
+        _mm_storeu_si128((__m128i*)(void*)(dst + i), v);
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_NEON)
+    for (; i + 16 <= len && i + 16 <= room; i += 16) {
+        uint8x16_t v = vld1q_u8((const unsigned char*)str + i);
+        uint8x16_t eq = vceqq_u8(v, vdupq_n_u8('\\'));
+        json_mask m = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        vst1q_u8((unsigned char*)dst + i, v);
+        if (m) return i + (json_ctz(m) >> 2);
+    }
+#else
+    for (; i + 8 <= len && i + 8 <= room; i += 8) {
+        json_mask v = json_load8(str + i);
+        json_mask b = v ^ JSON_U64(0x5C5C5C5C, 0x5C5C5C5C);
+        json_mask z = (b - JSON_U64(0x01010101, 0x01010101)) & ~b &
+            JSON_U64(0x80808080, 0x80808080);
+        int k = z ? (json_ctz(z) >> 3) : 8, j;
+        for (j = 0; j < k; ++j)
+            dst[i + j] = str[i + j];
+        if (z) return i + k;
+    }
+#endif
+    for (; i < len && str[i] != '\\'; ++i)
+        if (i < room) dst[i] = str[i];
+    return i;
+}
+JSON_INTERN long
+json_hex4(const char *s)
+{
+    /* value of four hex digits or -1 */
+    long v = 0;
+    int i;
+    for (i = 0; i < 4; ++i) {
+        char c = s[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    } return v;
+}
+JSON_API int
+json_convert(json_number *num, const struct json_token *tok)
+{
+    struct json_decimal d;
+    JSON_ASSERT(num);
+    JSON_ASSERT(tok);
+    if (!num || !tok || !tok->str || !tok->len)
+        return JSON_NONE;
+    if (!json_parse_decimal(&d, tok->str, tok->len))
+        return JSON_NONE;
+    *num = (json_number)json_decimal_to_double(&d);
+    return JSON_NUMBER;
+}
+JSON_API int
+json_convert_i64(json_int *num, const struct json_token *tok)
+{
+    int neg;
+    json_mask v;
+    JSON_ASSERT(num);
+    JSON_ASSERT(tok);
+    if (!num || !tok || !tok->str || !tok->len)
+        return JSON_NONE;
+    if (!json_parse_int(&v, &neg, tok))
+        return JSON_NONE;
+    if (v > JSON_U64(0x7FFFFFFF, 0xFFFFFFFF) + (json_mask)neg)
+        return JSON_NONE;
+    *num = neg ? (v ? -(json_int)(v - 1) - 1 : 0) : (json_int)v;
+    return JSON_NUMBER;
+}
+JSON_API int
+json_convert_u64(json_uint *num, const struct json_token *tok)
+{
+    int neg;
+    json_mask v;
+    JSON_ASSERT(num);
+    JSON_ASSERT(tok);
+    if (!num || !tok || !tok->str || !tok->len)
+        return JSON_NONE;
+    if (!json_parse_int(&v, &neg, tok) || (neg && v))
+        return JSON_NONE;
+    *num = (json_uint)v;
+    return JSON_NUMBER;
+}
+JSON_API int
+json_cpy(char *dst, int max, const struct json_token* tok)
+{
+    int i = 0;
+    int ret;
+    int siz;
+
+    JSON_ASSERT(dst);
+    JSON_ASSERT(tok);
+    if (!dst || !max || !tok)
+        return 0;
+
+    ret = (max < (tok->len + 1)) ? max : tok->len;
+    siz = (max < (tok->len + 1)) ? max-1 : tok->len;
+    for (i = 0; i < siz; i++)
+        dst[i] = tok->str[i];
+    dst[siz] = '\0';
+    return ret;
+}
+JSON_API int
+json_unescape(char *dst, int max, const struct json_token *tok)
+{
+    /* decodes the escapes of a string token into UTF-8. Returns the length
+     of the decoded string even if it had to be truncated to fit max, or -1
+     for malformed escapes. Unpaired surrogates decode to U+FFFD */
+    const char *s, *end;
+    int n = 0, room;
+
+    JSON_ASSERT(tok);
+    if (!tok || (!dst && max > 0)) return -1;
+    room = (max > 0) ? max - 1 : 0;
+    s = tok->str;
+    end = s + tok->len;
+    while (s < end) {
+        unsigned char buf[4];
+        int i, k = 1;
+        long cp;
+
+        /* copy clean runs in bulk */
+        int run = json_unescape_run((n < room) ? dst + n : NULL,
+            room - n, s, (int)(end - s));
+        n += run, s += run;
+        if (s >= end) break;
+        if (end - s < 2) return -1;
+        switch (s[1]) {
+        case '"': buf[0] = '"'; break;
+        case '\\': buf[0] = '\\'; break;
+        case '/': buf[0] = '/'; break;
+        case 'b': buf[0] = '\b'; break;
+        case 'f': buf[0] = '\f'; break;
+        case 'n': buf[0] = '\n'; break;
+        case 'r': buf[0] = '\r'; break;
+        case 't': buf[0] = '\t'; break;
+        case 'u': {
+            if (end - s < 6 || (cp = json_hex4(s + 2)) < 0)
+                return -1;
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - s >= 12 &&
+                s[6] == '\\' && s[7] == 'u') {
+                /* surrogate pair */
+                long lo = json_hex4(s + 8);
+                if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    s += 6;
+                }
+            }
+            if (cp >= 0xD800 && cp <= 0xDFFF)
+                cp = 0xFFFD;
+            if (cp < 0x80) {
+                buf[0] = (unsigned char)cp;
+            } else if (cp < 0x800) {
+                buf[0] = (unsigned char)(0xC0 | (cp >> 6));
+                buf[1] = (unsigned char)(0x80 | (cp & 0x3F));
+                k = 2;
+            } else if (cp < 0x10000) {
+                buf[0] = (unsigned char)(0xE0 | (cp >> 12));
+                buf[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+                buf[2] = (unsigned char)(0x80 | (cp & 0x3F));
+                k = 3;
+            } else {
+                buf[0] = (unsigned char)(0xF0 | (cp >> 18));
+                buf[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+                buf[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+                buf[3] = (unsigned char)(0x80 | (cp & 0x3F));
+                k = 4;
+            } s += 4;
+        } break;
+        default: return -1;
+        }
+        for (i = 0; i < k; ++i, ++n)
+            if (n < room) dst[n] = (char)buf[i];
+        s += 2;
+    }
+    if (max > 0)
+        dst[(n < room) ? n : room] = '\0';
+    return n;
+}
+JSON_API int
+json_cmp(const struct json_token* tok, const char* str)
+{
+    int i;
+    JSON_ASSERT(tok);
+    JSON_ASSERT(str);
+    if (!tok || !str) return 1;
+    for (i = 0; (i < tok->len); i++, str++){
+        if (tok->str[i] != *str)
+            return 1;
+    } return *str == '\0' ? 0 : 1;
+}
+/*--------------------------------------------------------------------------
+                                TOKENIZER
+  -------------------------------------------------------------------------*/
+JSON_API struct json_iter
+json_begin(const char *str, int len)
+{
+    struct json_iter iter = JSON_ITER_NULL;
+    iter.src = str; iter.len = len;
+    return iter;
+}
+JSON_API struct json_iter
+json_read(struct json_token *obj, const struct json_iter* prev)
+{
+    int len, run;
+    const char *cur;
+    unsigned char c = 0;
+    int utf8_remain = 0;
+    struct json_iter iter;
+
+    JSON_ASSERT(obj);
+    JSON_ASSERT(prev);
+    if (!prev || !obj || !prev->src || !prev->len || prev->err) {
+        /* case either invalid iterator or eof  */
+        struct json_iter it = JSON_ITER_NULL;
+        *obj = JSON_TOKEN_NULL;
+        it.err = 1;
+        return it;
+    }
+    iter = *prev;
+    *obj = JSON_TOKEN_NULL;
+    iter.err = 0;
+    if (!iter.go) /* begin of parsing process */
+        iter.go = json_go_struct;
+
+    len = iter.len;
+    for (cur = iter.src; len; cur++, len--) {
+        const unsigned char *tbl = (const unsigned char*)iter.go;
+        c = (unsigned char)*cur;
         if (c == '\0') goto l_end;
         if (iter.depth == 1 && (c == '}' || (c == ']')) && len == 1 && !obj->str) {
             iter.len = iter.depth = 0;
@@ -923,6 +2726,9 @@ json_read(struct json_token *obj, const struct json_iter* prev)
                     obj->children++;
                 obj->sub++;
             }
+            /* skip plain string bytes in bulk */
+            run = json_string_run(cur + 1, len - 1);
+            cur += run, len -= run;
         } break;
         case JSON_STATE_QDOWN: {
             iter.go = json_go_struct;
@@ -938,6 +2744,8 @@ json_read(struct json_token *obj, const struct json_iter* prev)
         } break;
         case JSON_STATE_UNESC: {
             iter.go = json_go_string;
+            run = json_string_run(cur + 1, len - 1);
+            cur += run, len -= run;
         } break;
         case JSON_STATE_BARE: {
             if (iter.depth <= 1) {
@@ -1009,6 +2817,364 @@ json_parse(struct json_pair *p, const struct json_iter* it)
     if (next.err) return next;
     return json_read(&p->value, &next);
 }
+/*--------------------------------------------------------------------------
+                                SCANNER
+  -------------------------------------------------------------------------*/
+/* Stage one of the one-pass loader: classifies 64 bytes at a time into
+ bitmasks and resolves escapes and string bodies with carry-less bit
+ tricks, so only structural characters, string quotes and the first byte
+ of each bare value are ever looked at by the token builder. */
+struct json_block {
+    json_mask quote;    /* '"' */
+    json_mask bslash;   /* '\\' */
+    json_mask open;     /* { [ */
+    json_mask close;    /* } ] */
+    json_mask sep;      /* : = , */
+    json_mask ws;       /* space, tab, newline, carriage return */
+    json_mask ctrl;     /* control characters and DEL (invalid in strings) */
+    json_mask high;     /* non-ASCII bytes */
+    json_mask nul;      /* string terminator */
+};
+struct json_scanner {
+    const unsigned char *src;
+    int len;            /* input length up to the first '\0' */
+    int pos;            /* offset of the next block */
+    json_mask escaped;  /* first byte of next block is escaped */
+    json_mask string;   /* all ones if the next block starts inside a string */
+    json_mask scalar;   /* last byte of previous block was part of a bare value */
+    int utf8;           /* remaining UTF-8 continuation bytes */
+    int err;
+    int strict;         /* unicode escape digits and UTF-8 ranges checked too */
+    /* structurals of the last block by category */
+    json_mask open, close, quote, value;
+};
+#if defined(JSON_SIMD_AVX2)
+JSON_INTERN void
+json_classify(struct json_block *b, const unsigned char *s)
+{
+    int i;
+    const __m256i lo = _mm256_set1_epi8(0x20);
+    const __m256i c1f = _mm256_set1_epi8(0x1F);
+    for (i = 0; i < 64; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(s + i));
+        __m256i l = _mm256_or_si256(v, lo);
+        __m256i sep = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('='))));
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lo),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        __m256i ctrl = _mm256_or_si256(
+            _mm256_cmpeq_epi8(_mm256_max_epu8(v, c1f), c1f),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)));
+        #define JSON_MOVEMASK(x) ((json_mask)(unsigned)_mm256_movemask_epi8(x) << i)
+        b->quote |= JSON_MOVEMASK(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+        b->bslash |= JSON_MOVEMASK(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        b->nul |= JSON_MOVEMASK(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+        b->open |= JSON_MOVEMASK(_mm256_cmpeq_epi8(l, _mm256_set1_epi8('{')));
+        b->close |= JSON_MOVEMASK(_mm256_cmpeq_epi8(l, _mm256_set1_epi8('}')));
+        b->sep |= JSON_MOVEMASK(sep);
+        b->ws |= JSON_MOVEMASK(ws);
+        b->ctrl |= JSON_MOVEMASK(ctrl);
+        b->high |= JSON_MOVEMASK(v);
+        #undef JSON_MOVEMASK
+    }
+}
+#elif defined(JSON_SIMD_SSE2)
+JSON_INTERN void
+json_classify(struct json_block *b, const unsigned char *s)
+{
+    int i;
+    const __m128i lo = _mm_set1_epi8(0x20);
+    const __m128i c1f = _mm_set1_epi8(0x1F);
+    for (i = 0; i < 64; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(s + i));
+        __m128i l = _mm_or_si128(v, lo);
+        __m128i sep = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('='))));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, lo),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        __m128i ctrl = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_max_epu8(v, c1f), c1f),
+            _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+        #define JSON_MOVEMASK(x) ((json_mask)(unsigned)_mm_movemask_epi8(x) << i)
+        b->quote |= JSON_MOVEMASK(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+        b->bslash |= JSON_MOVEMASK(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        b->nul |= JSON_MOVEMASK(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+        b->open |= JSON_MOVEMASK(_mm_cmpeq_epi8(l, _mm_set1_epi8('{')));
+        b->close |= JSON_MOVEMASK(_mm_cmpeq_epi8(l, _mm_set1_epi8('}')));
+        b->sep |= JSON_MOVEMASK(sep);
+        b->ws |= JSON_MOVEMASK(ws);
+        b->ctrl |= JSON_MOVEMASK(ctrl);
+        b->high |= JSON_MOVEMASK(v);
+        #undef JSON_MOVEMASK
+    }
+}
+#elif defined(JSON_SIMD_NEON)
+JSON_INTERN json_mask
+json_neon_mask(const uint8x16_t *v)
+{
+    /* emulates movemask by weighting each lane and folding pairwise */
+    static const unsigned char weights[16] = {
+        0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,
+        0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80};
+    const uint8x16_t w = vld1q_u8(weights);
+    uint8x16_t s0 = vpaddq_u8(vandq_u8(v[0], w), vandq_u8(v[1], w));
+    uint8x16_t s1 = vpaddq_u8(vandq_u8(v[2], w), vandq_u8(v[3], w));
+    s0 = vpaddq_u8(s0, s1);
+    s0 = vpaddq_u8(s0, s0);
+    return (json_mask)vgetq_lane_u64(vreinterpretq_u64_u8(s0), 0);
+}
+JSON_INTERN void
+json_classify(struct json_block *b, const unsigned char *s)
+{
+    int i;
+    uint8x16_t quote[4], bslash[4], open[4], close[4], sep[4], ws[4], ctrl[4], high[4], nul[4];
+    const uint8x16_t lo = vdupq_n_u8(0x20);
+    for (i = 0; i < 4; ++i) {
+        uint8x16_t v = vld1q_u8(s + i * 16);
+        uint8x16_t l = vorrq_u8(v, lo);
+        quote[i] = vceqq_u8(v, vdupq_n_u8('"'));
+        bslash[i] = vceqq_u8(v, vdupq_n_u8('\\'));
+        open[i] = vceqq_u8(l, vdupq_n_u8('{'));
+        close[i] = vceqq_u8(l, vdupq_n_u8('}'));
+        sep[i] = vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')),
+            vorrq_u8(vceqq_u8(v, vdupq_n_u8(',')), vceqq_u8(v, vdupq_n_u8('='))));
+        ws[i] = vorrq_u8(
+            vorrq_u8(vceqq_u8(v, lo), vceqq_u8(v, vdupq_n_u8('\t'))),
+            vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\r'))));
+        ctrl[i] = vorrq_u8(vcleq_u8(v, vdupq_n_u8(0x1F)), vceqq_u8(v, vdupq_n_u8(0x7F)));
+        high[i] = vcgeq_u8(v, vdupq_n_u8(0x80));
+        nul[i] = vceqq_u8(v, vdupq_n_u8(0));
+    }
+    b->quote = json_neon_mask(quote);
+    b->bslash = json_neon_mask(bslash);
+    b->open = json_neon_mask(open);
+    b->close = json_neon_mask(close);
+    b->sep = json_neon_mask(sep);
+    b->ws = json_neon_mask(ws);
+    b->ctrl = json_neon_mask(ctrl);
+    b->high = json_neon_mask(high);
+    b->nul = json_neon_mask(nul);
+}
+#else
+JSON_INTERN void
+json_classify(struct json_block *b, const unsigned char *s)
+{
+    int i;
+    for (i = 0; i < 64; ++i) {
+        const json_mask bit = (json_mask)1 << i;
+        const unsigned char c = s[i];
+        switch (c) {
+        case '"': b->quote |= bit; break;
+        case '\\': b->bslash |= bit; break;
+        case '{': case '[': b->open |= bit; break;
+        case '}': case ']': b->close |= bit; break;
+        case ':': case '=': case ',': b->sep |= bit; break;
+        case ' ': case '\t': case '\n': case '\r': b->ws |= bit; break;
+        default: break;
+        }
+        if (c < 0x20 || c == 0x7F) b->ctrl |= bit;
+        if (c & 0x80) b->high |= bit;
+        if (!c) b->nul |= bit;
+    }
+}
+#endif
+/* UTF-8 byte classes of a 64 byte block (only classified for blocks with
+ non-ASCII string bytes) */
+struct json_utf8 {
+    json_mask cont;     /* 10xxxxxx continuation byte */
+    json_mask lead2;    /* 11xxxxxx needs a second byte */
+    json_mask lead3;    /* 111xxxxx needs a third byte */
+    json_mask lead4;    /* 1111xxxx needs a fourth byte */
+    json_mask bad;      /* 11111xxx never valid */
+};
+JSON_INTERN void
+json_classify_utf8(struct json_utf8 *u, const unsigned char *s)
+{
+#if defined(JSON_SIMD_AVX2)
+    int i;
+    for (i = 0; i < 64; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(s + i));
+        #define JSON_GE(c) ((json_mask)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(\
+            _mm256_max_epu8(v, _mm256_set1_epi8((char)c)), v)) << i)
+        json_mask lead = JSON_GE(0xC0);
+        u->cont |= ((json_mask)(unsigned)_mm256_movemask_epi8(v) << i) & ~lead;
+        u->lead2 |= lead;
+        u->lead3 |= JSON_GE(0xE0);
+        u->lead4 |= JSON_GE(0xF0);
+        u->bad |= JSON_GE(0xF8);
+        #undef JSON_GE
+    }
+#elif defined(JSON_SIMD_SSE2)
+    int i;
+    for (i = 0; i < 64; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(s + i));
+        #define JSON_GE(c) ((json_mask)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(\
+            _mm_max_epu8(v, _mm_set1_epi8((char)c)), v)) << i)
+        json_mask lead = JSON_GE(0xC0);
+        u->cont |= ((json_mask)(unsigned)_mm_movemask_epi8(v) << i) & ~lead;
+        u->lead2 |= lead;
+        u->lead3 |= JSON_GE(0xE0);
+        u->lead4 |= JSON_GE(0xF0);
+        u->bad |= JSON_GE(0xF8);
+        #undef JSON_GE
+    }
+#elif defined(JSON_SIMD_NEON)
+    int i;
+    uint8x16_t high[4], lead2[4], lead3[4], lead4[4], bad[4];
+    for (i = 0; i < 4; ++i) {
+        uint8x16_t v = vld1q_u8(s + i * 16);
+        high[i] = vcgeq_u8(v, vdupq_n_u8(0x80));
+        lead2[i] = vcgeq_u8(v, vdupq_n_u8(0xC0));
+        lead3[i] = vcgeq_u8(v, vdupq_n_u8(0xE0));
+        lead4[i] = vcgeq_u8(v, vdupq_n_u8(0xF0));
+        bad[i] = vcgeq_u8(v, vdupq_n_u8(0xF8));
+    }
+    u->lead2 = json_neon_mask(lead2);
+    u->cont = json_neon_mask(high) & ~u->lead2;
+    u->lead3 = json_neon_mask(lead3);
+    u->lead4 = json_neon_mask(lead4);
+    u->bad = json_neon_mask(bad);
+#else
+    int i;
+    for (i = 0; i < 64; ++i) {
+        const json_mask bit = (json_mask)1 << i;
+        const unsigned char c = s[i];
+        if (c < 0x80) continue;
+        if (c < 0xC0) {u->cont |= bit; continue;}
+        u->lead2 |= bit;
+        if (c >= 0xE0) u->lead3 |= bit;
+        if (c >= 0xF0) u->lead4 |= bit;
+        if (c >= 0xF8) u->bad |= bit;
+    }
+#endif
+}
+JSON_INTERN void
+json_scan_begin(struct json_scanner *s, const char *str, int len)
+{
+    s->src = (const unsigned char*)str;
+    s->len = len;
+    s->pos = 0;
+    s->escaped = s->string = s->scalar = 0;
+    s->utf8 = s->err = 0;
+    s->strict = 0;
+}
+JSON_INTERN int
+json_scan_utf8(struct json_scanner *s, const unsigned char *p, json_mask body)
+{
+    /* validates multi-byte sequences inside string bodies with the rules of
+     the tokenizer tables: each lead byte marks the continuation bytes it
+     needs, and these have to be exactly the continuation bytes present */
+    struct json_utf8 u = {0,0,0,0,0};
+    json_mask need;
+    json_classify_utf8(&u, p);
+    u.lead2 &= body, u.lead3 &= body, u.lead4 &= body;
+    need = (u.lead2 << 1) | (u.lead3 << 2) | (u.lead4 << 3);
+    need |= ((json_mask)1 << s->utf8) - 1;
+    if ((u.bad & body) || (need ^ (u.cont & body)))
+        return 0;
+    s->utf8 = json_popcnt((u.lead2 >> 63) | (u.lead3 >> 62) | (u.lead4 >> 61));
+    for (; s->strict && u.lead2; u.lead2 &= u.lead2 - 1) {
+        /* the second byte limits the range of three and four byte forms */
+        int at = s->pos + json_ctz(u.lead2);
+        unsigned c = s->src[at], n = (at + 1 < s->len) ? s->src[at + 1] : 0x80;
+        if (c < 0xC2 || c > 0xF4) return 0;
+        if ((c == 0xE0 && n < 0xA0) || (c == 0xED && n >= 0xA0)) return 0;
+        if ((c == 0xF0 && n < 0x90) || (c == 0xF4 && n >= 0x90)) return 0;
+    } return 1;
+}
+JSON_INTERN int
+json_scan(struct json_scanner *s, json_mask *bits)
+{
+    /* classifies the next block and returns its offset together with a
+     mask of structural characters, string quotes (opening and closing) and
+     bare value starts. Returns -1 at the end of input or on error. */
+    struct json_block b = {0,0,0,0,0,0,0,0,0};
+    unsigned char pad[64];
+    const unsigned char *p;
+    json_mask valid = ~(json_mask)0;
+    json_mask bs, follows, odd, seq, escaped, quote, str, body, scalar, esc, op;
+    int base = s->pos;
+    int n = s->len - base;
+
+    if (s->err) return -1;
+    if (n <= 0) {
+        /* unterminated string or truncated UTF-8 sequence */
+        if (s->string || s->utf8) s->err = 1;
+        return -1;
+    }
+    if (n < 64) {
+        int i;
+        for (i = 0; i < n; ++i) pad[i] = s->src[base + i];
+        for (; i < 64; ++i) pad[i] = ' ';
+        valid = ((json_mask)1 << n) - 1;
+        p = pad;
+    } else p = s->src + base;
+    json_classify(&b, p);
+    if (b.nul & valid) {
+        /* input ends at the first '\0' */
+        int end = json_ctz(b.nul & valid);
+        valid = end ? (((json_mask)1 << end) - 1) : 0;
+        s->len = base + end;
+    }
+    b.ws |= ~valid;
+
+    /* odd-length backslash sequences escape the following byte */
+    bs = b.bslash & valid & ~s->escaped;
+    follows = (bs << 1) | s->escaped;
+    odd = bs & ~JSON_EVEN_BITS & ~follows;
+    seq = odd + bs;
+    s->escaped = (seq < bs) ? 1 : 0;
+    escaped = (JSON_EVEN_BITS ^ (seq << 1)) & follows;
+
+    /* string bodies lie between unescaped quote pairs */
+    quote = b.quote & valid & ~escaped;
+    str = json_prefix_xor(quote) ^ s->string;
+    s->string = (json_mask)0 - (str >> 63);
+    body = str & ~quote & valid;
+    if (body & b.ctrl) {
+        /* DEL is refused like in the tokenizer but allowed by RFC 8259 */
+        json_mask ctrl = body & b.ctrl;
+        while (s->strict && ctrl && p[json_ctz(ctrl)] == 0x7F)
+            ctrl &= ctrl - 1;
+        if (ctrl) {
+            s->err = 1;
+            return -1;
+        }
+    }
+    esc = body & escaped;
+    while (esc) {
+        int at = json_ctz(esc);
+        if (json_go_esc[p[at]] != JSON_STATE_UNESC || (s->strict && p[at] == 'u' &&
+            (base + at + 5 > s->len || json_hex4((const char*)s->src + base + at + 1) < 0))) {
+            s->err = 1;
+            return -1;
+        } esc &= esc - 1;
+    }
+    if (((body & b.high) || s->utf8) && !json_scan_utf8(s, p, body)) {
+        s->err = 1;
+        return -1;
+    }
+
+    /* bare values start at the first byte after whitespace or an operator */
+    op = b.open | b.close | b.sep;
+    scalar = ~(str | quote | op | b.ws);
+    s->open = b.open & ~str & valid;
+    s->close = b.close & ~str & valid;
+    s->quote = quote;
+    s->value = scalar & ~((scalar << 1) | s->scalar) & valid;
+    s->scalar = scalar >> 63;
+    *bits = (op & ~str & valid) | quote | s->value;
+    s->pos += 64;
+    return base;
+}
 /*--------------------------------------------------------------------------
                                 PARSER
   -------------------------------------------------------------------------*/
@@ -1031,6 +3197,88 @@ json_num(const char *str, int len)
         iter = json_read(&tok, &iter);
     } return cnt;
 }
+JSON_API void
+json_parser_init(struct json_parser *p, json_alloc_callback alloc,
+    json_grow_callback grow, void *usr)
+{
+    /* the stack region is only handed out, never cleared */
+    JSON_ASSERT(p);
+    if (!p) return;
+    p->err = JSON_OK;
+    p->toks = 0;
+    p->cnt = p->cap = 0;
+    p->alloc = alloc;
+    p->grow = grow;
+    p->usr = usr;
+    p->size = 0;
+    p->depth = 0;
+    p->deep = 0;
+    p->iter = 0;
+    p->stk = 0;
+}
+JSON_API void
+json_parser_reset(struct json_parser *p)
+{
+    /* ready for the next document. Tokens and stack taken from the arena
+     are kept and reused, so it must not be rewound while they are */
+    JSON_ASSERT(p);
+    if (!p) return;
+    p->err = JSON_OK;
+    p->cnt = 0;
+    p->deep = 0;
+    p->iter = 0;
+    if (p->size) p->cap = p->size;
+}
+JSON_INTERN int
+json_parser_grow(struct json_parser *p)
+{
+    /* takes the `cap` tokens a loader asked for from the arena while
+     keeping the ones already loaded. Fails without arena */
+    int i, size;
+    struct json_token *toks;
+
+    if (!p->alloc || p->cap <= 0 || p->cap > 0x7FFFFFFF / (int)sizeof(struct json_token))
+        return 0;
+    size = p->cap * (int)sizeof(struct json_token);
+    if (p->size && p->grow) {
+        toks = (struct json_token*)p->grow(p->usr, p->toks,
+            p->size * (int)sizeof(struct json_token), size);
+    } else {
+        toks = (struct json_token*)p->alloc(p->usr, size);
+        for (i = 0; toks && p->toks && i < p->cnt && i < p->cap; ++i)
+            toks[i] = p->toks[i];
+    }
+    if (!toks) return 0;
+    p->toks = toks;
+    p->size = p->cap;
+    p->err = JSON_OK;
+    return 1;
+}
+JSON_INTERN int
+json_parser_deepen(struct json_parser *p)
+{
+    /* doubles the stack, moving it out of the parser into the arena */
+    int i, n, size;
+    struct json_iter *stk;
+
+    if (!p->alloc || p->depth >= JSON_MAX_DEPTH)
+        return 0;
+    n = (p->depth * 2 < JSON_MAX_DEPTH) ? p->depth * 2 : JSON_MAX_DEPTH;
+    size = n * (int)sizeof(struct json_iter);
+    if (p->stk != p->base && p->grow) {
+        stk = (struct json_iter*)p->grow(p->usr, p->stk,
+            p->depth * (int)sizeof(struct json_iter), size);
+    } else {
+        stk = (struct json_iter*)p->alloc(p->usr, size);
+        for (i = 0; stk && i < p->depth; ++i)
+            stk[i] = p->stk[i];
+    }
+    if (!stk) return 0;
+    p->iter = stk + (p->iter - p->stk);
+    p->stk = stk;
+    p->depth = n;
+    return 1;
+}
 JSON_API int
 json_load(struct json_parser *p, const char *str, int len)
 {
@@ -1040,8 +3288,14 @@ json_load(struct json_parser *p, const char *str, int len)
 
     if (!str || !len)
         return 0;
+    if (p->deep)
+        return json_load_tape(p, str, len);
     if (p->iter == NULL) {
         /* initialize state-machine */
+        if (!p->stk) {
+            p->stk = p->base;
+            p->depth = JSON_PARSER_DEPTH;
+        }
         p->iter = p->stk;
 
         *p->iter = json_begin(str, len);
@@ -1053,7 +3307,8 @@ json_load(struct json_parser *p, const char *str, int len)
         if (!p->cap || !p->toks) {
             if (!p->toks && !p->cap)
                 p->cap = JSON_INITIAL_CAPACITY;
-            return 1;
+            if (!json_parser_grow(p))
+                return 1;
         }
     }
     JSON_ASSERT(p->cap);
@@ -1063,13 +3318,20 @@ json_load(struct json_parser *p, const char *str, int len)
             /* handle not enough memory */
             p->cap = p->cap << 1;
             p->err = JSON_OUT_OF_TOKEN;
-            return 1;
+            if (!json_parser_grow(p))
+                return 1;
         }
         p->toks[p->cnt++] = p->tok;
         if (p->tok.type == JSON_OBJECT ||
             p->tok.type == JSON_ARRAY) {
-            /* handle recursive down parsing using fixed stack */
-            if (p->iter + 1 >= p->stk + JSON_MAX_DEPTH) {
+            /* handle recursive down parsing using the lazily grown stack */
+            if (p->iter + 1 >= p->stk + p->depth && !json_parser_deepen(p)) {
+                if (p->depth < JSON_MAX_DEPTH) {
+                    /* no arena: the single pass loader keeps its stack
+                     on the C stack and takes over from the start */
+                    p->deep = 1;
+                    return json_load_tape(p, str, len);
+                }
                 p->err = JSON_STACK_OVERFLOW;
                 return 0;
             }
@@ -1101,21 +3363,417 @@ json_load(struct json_parser *p, const char *str, int len)
     p->err = JSON_OK;
     return 0;
 }
-
 /*--------------------------------------------------------------------------
-                                QUERY
+                                BUILDER
   -------------------------------------------------------------------------*/
-JSON_INTERN const char*
-json_strchr(const char *str, char c, int len)
+/* Stage two of the one-pass loader: consumes structural positions in
+ order and appends tokens, back-patching `len`, `children` and `sub` of
+ each object/array once its closing bracket is reached. The outermost
+ object/array stays transparent just like in `json_load`. Once the token
+ array is full, tokens are only counted so the caller learns the exact
+ capacity required. */
+struct json_builder {
+    const char *src;
+    int len;
+    struct json_token *toks;
+    struct json_ctoken *ctoks; /* compact tokens instead of toks */
+    int cap, cnt;
+    int quote; /* offset of the pending opening quote, -1 or -2 in a string of an earlier part */
+    int depth;
+    int stk[JSON_MAX_DEPTH]; /* ((token index + 1) << 1) | is_array */
+    int outer; /* containers opened before the input of a part */
+    struct json_chunk *chunk; /* part being built or null */
+    enum json_status err;
+};
+JSON_INTERN void
+json_build_init(struct json_builder *b, const char *str, int len)
 {
-    int neg = (len < 0) ? 1: 0;
-    int dec = neg ? 0 : 1;
-    len = neg ? 0 : len;
-    if (!str) return NULL;
-    while (*str && len >= 0) {
-        if (*str == c)
-            return str;
-        len -= dec;
+    b->src = str;
+    b->len = len;
+    b->toks = 0;
+    b->ctoks = 0;
+    b->cap = 0;
+    b->cnt = 0;
+    b->quote = -1;
+    b->depth = 0;
+    b->outer = 0;
+    b->chunk = 0;
+    b->err = JSON_OK;
+}
+JSON_INTERN void
+json_build_begin(struct json_builder *b, struct json_parser *p,
+    const char *str, int len)
+{
+    json_build_init(b, str, len);
+    b->toks = p->toks;
+    b->cap = p->toks ? p->cap : 0;
+    p->cnt = 0;
+}
+JSON_INTERN void
+json_build_children(struct json_builder *b, int n)
+{
+    /* adds to the child count of the innermost open container */
+    if (b->depth) {
+        int top = (b->stk[b->depth-1] >> 1) - 1;
+        if (top < 0 || top >= b->cap) return;
+        if (b->ctoks) b->ctoks[top].info += n * 16;
+        else b->toks[top].children += n;
+    } else if (b->chunk) {
+        /* child of a container from an earlier part */
+        b->chunk->kids[b->chunk->closes] += n;
+    }
+}
+JSON_INTERN void
+json_build_push(struct json_builder *b, const char *str, int len,
+    enum json_token_type type)
+{
+    json_build_children(b, 1);
+    if (b->cnt < b->cap && b->ctoks) {
+        struct json_ctoken *tok = &b->ctoks[b->cnt];
+        tok->off = (int)(str - b->src);
+        tok->len = len;
+        tok->info = (int)type;
+        tok->sub = 0;
+    } else if (b->cnt < b->cap) {
+        struct json_token *tok = &b->toks[b->cnt];
+        tok->str = str;
+        tok->type = type;
+        tok->len = len;
+        tok->children = 0;
+        tok->sub = 0;
+    } b->cnt++;
+}
+JSON_INTERN int
+json_build(struct json_builder *b, int pos)
+{
+    const char *cur = b->src + pos;
+    if (b->quote != -1) {
+        /* closing quote of a string */
+        if (b->quote >= 0)
+            json_build_push(b, b->src + b->quote + 1, pos - b->quote - 1, JSON_STRING);
+        else b->chunk->quote = pos;
+        b->quote = -1;
+        return 1;
+    }
+    switch (*cur) {
+    case '"': b->quote = pos; break;
+    case ',': break;
+    case '{': case '[': {
+        int arr = (*cur == '[');
+        if (b->depth + b->outer >= JSON_MAX_DEPTH) {
+            b->err = JSON_STACK_OVERFLOW;
+            return 0;
+        }
+        if (!b->depth && !b->outer) {
+            /* root object/array is not emitted */
+            b->stk[b->depth++] = arr;
+        } else {
+            int idx = b->cnt;
+            json_build_push(b, cur, 0, arr ? JSON_ARRAY: JSON_OBJECT);
+            b->stk[b->depth++] = ((idx + 1) << 1) | arr;
+        }
+    } break;
+    case '}': case ']': {
+        int idx, e;
+        if (!b->depth && b->outer) {
+            /* container of an earlier part, patched when merging */
+            struct json_chunk *c = b->chunk;
+            c->close[c->closes] = pos;
+            c->count[c->closes] = b->cnt;
+            c->kids[++c->closes] = 0;
+            b->outer--;
+            break;
+        }
+        if (!b->depth) {
+            b->err = JSON_PARSING_ERROR;
+            return 0;
+        }
+        e = b->stk[--b->depth];
+        if ((e & 1) != (*cur == ']')) {
+            b->err = JSON_PARSING_ERROR;
+            return 0;
+        }
+        idx = (e >> 1) - 1;
+        if (idx >= 0 && idx < b->cap && b->ctoks) {
+            struct json_ctoken *tok = &b->ctoks[idx];
+            tok->len = pos - tok->off + 1;
+            tok->sub = b->cnt - idx - 1;
+        } else if (idx >= 0 && idx < b->cap) {
+            struct json_token *tok = &b->toks[idx];
+            tok->len = (int)(cur - tok->str) + 1;
+            tok->sub = b->cnt - idx - 1;
+        }
+    } break;
+    case ':': case '=': {
+        /* key separators turn the key/value count into a pair count */
+        json_build_children(b, -1);
+    } break;
+    default: {
+        /* bare value: number, true, false or null */
+        int end;
+        enum json_token_type type;
+        if (json_go_struct[(unsigned char)*cur] != JSON_STATE_BARE) {
+            b->err = JSON_PARSING_ERROR;
+            return 0;
+        }
+        for (end = pos + 1; end < b->len; ++end) {
+            const unsigned char c = (unsigned char)b->src[end];
+            const char state = json_go_bare[c];
+            if (state == JSON_STATE_UNBARE || !c) break;
+            if (state != JSON_STATE_LOOP || c == '"' || c == '{' ||
+                c == '[' || c == ':' || c == '=') {
+                b->err = JSON_PARSING_ERROR;
+                return 0;
+            }
+        }
+        if (*cur == 't') type = JSON_TRUE;
+        else if (*cur == 'f') type = JSON_FALSE;
+        else if (*cur == 'n') type = JSON_NULL;
+        else type = JSON_NUMBER;
+        json_build_push(b, cur, end - pos, type);
+    } break;
+    } return 1;
+}
+JSON_INTERN enum json_status
+json_build_finish(struct json_builder *b)
+{
+    if (!b->err && (b->depth || b->quote >= 0))
+        b->err = JSON_PARSING_ERROR;
+    if (b->err) return b->err;
+    /* restart with exactly enough tokens */
+    return (b->cnt > b->cap) ? JSON_OUT_OF_TOKEN : JSON_OK;
+}
+JSON_INTERN int
+json_build_end(struct json_builder *b, struct json_parser *p)
+{
+    p->err = json_build_finish(b);
+    if (p->err == JSON_OUT_OF_TOKEN)
+        p->cap = b->cnt;
+    else if (p->err == JSON_OK)
+        p->cnt = b->cnt;
+    return p->err == JSON_OUT_OF_TOKEN;
+}
+JSON_API int
+json_index(int *idx, int cap, const char *str, int len)
+{
+    struct json_scanner s;
+    json_mask bits;
+    int base, n = 0;
+
+    JSON_ASSERT(str);
+    if (!str || len <= 0)
+        return 0;
+    if (!idx) cap = 0;
+
+    json_scan_begin(&s, str, len);
+    while ((base = json_scan(&s, &bits)) >= 0) {
+        if (n + json_popcnt(bits) <= cap) {
+            while (bits) {
+                idx[n++] = base + json_ctz(bits);
+                bits &= bits - 1;
+            }
+        } else {
+            while (bits) {
+                if (n < cap) idx[n] = base + json_ctz(bits);
+                bits &= bits - 1;
+                n++;
+            }
+        }
+    } return s.err ? -1: n;
+}
+JSON_API int
+json_count(const char *str, int len)
+{
+    int depth = 0;
+    int quotes = 0;
+    int cnt = 0;
+    json_mask bits;
+    struct json_scanner s;
+
+    JSON_ASSERT(str);
+    if (!str || len <= 0)
+        return 0;
+
+    /* tokens are strings (quote pairs), bare values and every
+     object/array except the transparent root, so only brackets have to
+     be visited one by one and only while the root could close */
+    json_scan_begin(&s, str, len);
+    while (json_scan(&s, &bits) >= 0) {
+        json_mask br = s.open | s.close;
+        int opens = json_popcnt(s.open);
+        int closes = json_popcnt(s.close);
+        quotes += json_popcnt(s.quote);
+        cnt += json_popcnt(s.value);
+        if (closes < depth) {
+            cnt += opens;
+            depth += opens - closes;
+        } else while (br) {
+            json_mask bit = br & (~br + 1);
+            if (s.open & bit) {
+                if (depth++) cnt++;
+            } else if (depth) depth--;
+            br &= br - 1;
+        }
+    } return s.err ? -1: cnt + (quotes >> 1);
+}
+JSON_API int
+json_load_index(struct json_parser *p, const char *str, int len,
+    const int *idx, int cnt)
+{
+    int i;
+    struct json_builder b;
+
+    JSON_ASSERT(p);
+    JSON_ASSERT(str);
+    JSON_ASSERT(idx);
+    if (!p || !str || !len || !idx || cnt < 0)
+        return 0;
+    if (!p->toks || !p->cap) {
+        if (!p->cap)
+            p->cap = JSON_INITIAL_CAPACITY;
+        if (!json_parser_grow(p))
+            return 1;
+    }
+    do {
+        json_build_begin(&b, p, str, len);
+        for (i = 0; i < cnt; ++i) {
+            if (!json_build(&b, idx[i]))
+                break;
+        }
+    } while (json_build_end(&b, p) && json_parser_grow(p));
+    return p->err == JSON_OUT_OF_TOKEN;
+}
+JSON_INTERN int
+json_tape(struct json_parser *p, const char *str, int len)
+{
+    int base;
+    json_mask bits;
+    struct json_scanner s;
+    struct json_builder b;
+
+    /* classify each block and feed its structurals straight into the
+     builder so the input is only walked once and no index is stored */
+    json_scan_begin(&s, str, len);
+    json_build_begin(&b, p, str, len);
+    while ((base = json_scan(&s, &bits)) >= 0) {
+        while (bits) {
+            if (!json_build(&b, base + json_ctz(bits)))
+                return json_build_end(&b, p);
+            bits &= bits - 1;
+        }
+    }
+    if (s.err) {
+        p->err = JSON_PARSING_ERROR;
+        return 0;
+    } return json_build_end(&b, p);
+}
+JSON_API int
+json_load_tape(struct json_parser *p, const char *str, int len)
+{
+    JSON_ASSERT(p);
+    JSON_ASSERT(str);
+    JSON_ASSERT(len > 0);
+    if (!p || !str || !len)
+        return 0;
+    if (!p->toks || !p->cap) {
+        if (!p->cap)
+            p->cap = JSON_INITIAL_CAPACITY;
+        if (!json_parser_grow(p))
+            return 1;
+    }
+    /* with an arena the document is loaded again into the grown tokens */
+    while (json_tape(p, str, len))
+        if (!json_parser_grow(p)) return 1;
+    return 0;
+}
+JSON_API int
+json_load_exact(struct json_parser *p, const char *str, int len)
+{
+    int n;
+    JSON_ASSERT(p);
+    JSON_ASSERT(str);
+    JSON_ASSERT(len > 0);
+    if (!p || !str || !len)
+        return 0;
+    if (p->toks && p->cap)
+        return json_load_tape(p, str, len);
+
+    /* counting pass: request exactly as many tokens as needed */
+    n = json_count(str, len);
+    if (n < 0) {
+        p->err = JSON_PARSING_ERROR;
+        return 0;
+    }
+    p->cap = n ? n : 1;
+    p->err = JSON_OUT_OF_TOKEN;
+    if (!json_parser_grow(p))
+        return 1;
+    return json_load_tape(p, str, len);
+}
+JSON_API int
+json_load_compact(struct json_compact *c, const char *str, int len)
+{
+    int n, base;
+    json_mask bits;
+    struct json_scanner s;
+    struct json_builder b;
+
+    JSON_ASSERT(c);
+    JSON_ASSERT(str);
+    JSON_ASSERT(len > 0);
+    if (!c || !str || !len)
+        return 0;
+    c->src = str;
+    c->cnt = 0;
+    if (!c->toks || !c->cap) {
+        /* counting pass: request exactly as many tokens as needed */
+        n = json_count(str, len);
+        if (n < 0) {
+            c->err = JSON_PARSING_ERROR;
+            return 0;
+        }
+        c->cap = n ? n : 1;
+        c->err = JSON_OUT_OF_TOKEN;
+        return 1;
+    }
+    json_scan_begin(&s, str, len);
+    json_build_init(&b, str, len);
+    b.ctoks = c->toks;
+    b.cap = c->cap;
+    while ((base = json_scan(&s, &bits)) >= 0) {
+        while (bits) {
+            if (!json_build(&b, base + json_ctz(bits)))
+                goto end;
+            bits &= bits - 1;
+        }
+    }
+    if (s.err) {
+        c->err = JSON_PARSING_ERROR;
+        return 0;
+    }
+end:
+    c->err = json_build_finish(&b);
+    if (c->err == JSON_OUT_OF_TOKEN)
+        c->cap = b.cnt;
+    else if (c->err == JSON_OK)
+        c->cnt = b.cnt;
+    return c->err == JSON_OUT_OF_TOKEN;
+}
+
+/*--------------------------------------------------------------------------
+                                QUERY
+  -------------------------------------------------------------------------*/
+JSON_INTERN const char*
+json_strchr(const char *str, char c, int len)
+{
+    int neg = (len < 0) ? 1: 0;
+    int dec = neg ? 0 : 1;
+    len = neg ? 0 : len;
+    if (!str) return NULL;
+    while (*str && len >= 0) {
+        if (*str == c)
+            return str;
+        len -= dec;
         str++;
     }
     if (neg) return str;
@@ -1296,6 +3954,24 @@ json_query_number(json_number *num, struct json_token *toks, int count,
     return json_convert(num, tok);
 }
 JSON_API int
+json_query_int(json_int *num, struct json_token *toks, int count,
+    const char *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(num);
+    JSON_ASSERT(path);
+    JSON_ASSERT(count > 0);
+    if (!toks || !count || !num || !path)
+        return JSON_NONE;
+
+    tok = json_query(toks, count, path);
+    if (!tok) return JSON_NONE;
+    if (tok->type != JSON_NUMBER)
+        return (int)tok->type;
+    return json_convert_i64(num, tok);
+}
+JSON_API int
 json_query_string(char *buffer, int max, int *size,
     struct json_token *toks, int count, const char *path)
 {
@@ -1360,9 +4036,3058 @@ json_obj_next(struct json_token *toks)
 {
     if (toks[1].type == JSON_ARRAY ||
         toks[1].type == JSON_OBJECT) {
-        toks = (toks + 1) + toks[1].sub;
+        toks = (toks + 2) + toks[1].sub;
     } else toks = toks + 2;
     return toks;
 }
+/*--------------------------------------------------------------------------
+                                MAP
+  -------------------------------------------------------------------------*/
+/* Optional lookup index over a loaded token array. The first `count`
+ slots hold the offset of each object/array table (or -1). An object
+ table is an open-addressed hash of key token indices preceded by its
+ mask, an array table the element token indices preceded by their count.
+ Root tokens are indexed as object like `json_query` treats them.
+ Maps built with `json_map_build_arrays` only hold array tables, objects
+ and the root have no table (-1) and are searched pair by pair. */
+JSON_INTERN unsigned
+json_hash(const char *str, int len)
+{
+    /* FNV-1a */
+    unsigned h = 2166136261u;
+    while (len-- > 0) {
+        h ^= (unsigned char)*str++;
+        h *= 16777619u;
+    } return h & 0xFFFFFFFFu;
+}
+JSON_INTERN int
+json_map_slots(int pairs)
+{
+    int n = 4;
+    while (n < pairs * 2) n <<= 1;
+    return n;
+}
+JSON_INTERN int
+json_map_pairs(const struct json_token *toks, int count)
+{
+    int i = 0, n = 0;
+    while (i + 1 < count) {
+        const struct json_token *v = &toks[i+1];
+        i += (v->type == JSON_OBJECT || v->type == JSON_ARRAY) ? v->sub + 2: 2;
+        n++;
+    } return n;
+}
+JSON_INTERN int
+json_map_table(int *slots, int at, const struct json_token *toks,
+    int first, int end)
+{
+    /* hashes the keys of the pairs in [first, end) into a table at `at` */
+    int i, mask, n = json_map_slots(json_map_pairs(toks + first, end - first));
+    int *tbl = slots + at + 1;
+    mask = n - 1;
+    slots[at] = mask;
+    for (i = 0; i < n; ++i)
+        tbl[i] = -1;
+    for (i = first; i + 1 < end;) {
+        const struct json_token *k = &toks[i];
+        const struct json_token *v = &toks[i+1];
+        unsigned h = json_hash(k->str, k->len);
+        while (tbl[h & (unsigned)mask] >= 0) {
+            /* keep the first of duplicate keys like `json_query` */
+            const struct json_token *d = &toks[tbl[h & (unsigned)mask]];
+            if (d->len == k->len && json_memeq(d->str, k->str, k->len))
+                break;
+            h++;
+        }
+        if (tbl[h & (unsigned)mask] < 0)
+            tbl[h & (unsigned)mask] = i;
+        i += (v->type == JSON_OBJECT || v->type == JSON_ARRAY) ? v->sub + 2: 2;
+    } return at + n + 1;
+}
+JSON_INTERN int
+json_map_array(int *slots, int at, const struct json_token *toks, int arr)
+{
+    /* element count followed by the token index of every element */
+    int j, e = arr + 1;
+    slots[at++] = toks[arr].children;
+    for (j = 0; j < toks[arr].children; ++j) {
+        slots[at++] = e;
+        e += (toks[e].type == JSON_OBJECT || toks[e].type == JSON_ARRAY) ?
+            toks[e].sub + 1: 1;
+    } return at;
+}
+JSON_INTERN int
+json_map_lookup(const struct json_map *m, const struct json_token *obj,
+    const char *key, int len, unsigned h)
+{
+    int mask, i, end;
+    const int *t;
+    const int tbl = obj ? m->slots[obj - m->toks] : m->root;
+    if (tbl < 0) {
+        /* objects without a hash table are searched pair by pair */
+        i = obj ? (int)(obj - m->toks) + 1 : 0;
+        end = obj ? i + obj->sub : m->cnt;
+        for (; i + 1 < end; i += 2 + m->toks[i+1].sub)
+            if (m->toks[i].len == len && json_memeq(m->toks[i].str, key, len))
+                return i + 1;
+        return -1;
+    }
+    mask = m->slots[tbl];
+    t = m->slots + tbl + 1;
+    while (t[h & (unsigned)mask] >= 0) {
+        const struct json_token *k = &m->toks[t[h & (unsigned)mask]];
+        if (k->len == len && json_memeq(k->str, key, len))
+            return t[h & (unsigned)mask] + 1;
+        h++;
+    } return -1;
+}
+JSON_API int
+json_map_size(const struct json_token *toks, int count)
+{
+    int i, n;
+    JSON_ASSERT(toks);
+    if (!toks || count <= 0)
+        return 0;
+    n = count + 1 + json_map_slots(json_map_pairs(toks, count));
+    for (i = 0; i < count; ++i) {
+        if (toks[i].type == JSON_OBJECT)
+            n += 1 + json_map_slots(json_map_pairs(toks + i + 1, toks[i].sub));
+        else if (toks[i].type == JSON_ARRAY)
+            n += 1 + toks[i].children;
+    } return n;
+}
+JSON_API int
+json_map_build(struct json_map *m, struct json_token *toks, int count,
+    int *mem, int size)
+{
+    int i, at;
+    JSON_ASSERT(m);
+    JSON_ASSERT(toks);
+    JSON_ASSERT(mem);
+    if (!m || !toks || !mem || count <= 0)
+        return 0;
+    if (size < json_map_size(toks, count))
+        return 0;
+
+    m->toks = toks;
+    m->cnt = count;
+    m->slots = mem;
+    m->root = count;
+    at = json_map_table(mem, count, toks, 0, count);
+    for (i = 0; i < count; ++i) {
+        const struct json_token *t = &toks[i];
+        if (t->type == JSON_OBJECT) {
+            mem[i] = at;
+            at = json_map_table(mem, at, toks, i + 1, i + 1 + t->sub);
+        } else if (t->type == JSON_ARRAY) {
+            mem[i] = at;
+            at = json_map_array(mem, at, toks, i);
+        } else mem[i] = -1;
+    } return 1;
+}
+JSON_API int
+json_map_arrays_size(const struct json_token *toks, int count)
+{
+    int i, n;
+    JSON_ASSERT(toks);
+    if (!toks || count <= 0)
+        return 0;
+    n = count;
+    for (i = 0; i < count; ++i)
+        if (toks[i].type == JSON_ARRAY)
+            n += 1 + toks[i].children;
+    return n;
+}
+JSON_API int
+json_map_build_arrays(struct json_map *m, struct json_token *toks, int count,
+    int *mem, int size)
+{
+    /* element tables only: constant time indexing without hashing keys */
+    int i, at = count;
+    JSON_ASSERT(m);
+    JSON_ASSERT(toks);
+    JSON_ASSERT(mem);
+    if (!m || !toks || !mem || count <= 0)
+        return 0;
+    if (size < json_map_arrays_size(toks, count))
+        return 0;
+
+    m->toks = toks;
+    m->cnt = count;
+    m->slots = mem;
+    m->root = -1;
+    for (i = 0; i < count; ++i) {
+        if (toks[i].type == JSON_ARRAY) {
+            mem[i] = at;
+            at = json_map_array(mem, at, toks, i);
+        } else mem[i] = -1;
+    } return 1;
+}
+JSON_API struct json_token*
+json_map_find(const struct json_map *m, const struct json_token *obj,
+    const char *key, int len)
+{
+    int i;
+    JSON_ASSERT(m);
+    JSON_ASSERT(key);
+    if (!m || !m->slots || !key)
+        return NULL;
+    if (obj && obj->type != JSON_OBJECT)
+        return NULL;
+    i = json_map_lookup(m, obj, key, len, json_hash(key, len));
+    return (i < 0) ? NULL: &m->toks[i];
+}
+JSON_API struct json_token*
+json_map_at(const struct json_map *m, const struct json_token *array, int index)
+{
+    const int *tbl;
+    JSON_ASSERT(m);
+    JSON_ASSERT(array);
+    if (!m || !m->slots || !array || array->type != JSON_ARRAY)
+        return NULL;
+    tbl = m->slots + m->slots[array - m->toks];
+    if (index < 0 || index >= tbl[0])
+        return NULL;
+    return &m->toks[tbl[1 + index]];
+}
+JSON_API const int*
+json_map_elements(const struct json_map *m, const struct json_token *array,
+    int *count)
+{
+    /* token indices of all array elements, e.g. to hand out ranges of
+     elements to worker threads */
+    const int *tbl;
+    JSON_ASSERT(m);
+    JSON_ASSERT(count);
+    if (!m || !m->slots || !array || !count || array->type != JSON_ARRAY)
+        return NULL;
+    tbl = m->slots + m->slots[array - m->toks];
+    *count = tbl[0];
+    return tbl + 1;
+}
+JSON_INTERN const char*
+json_path_parse_index(const char *path, int *n)
+{
+    /* decimal array subscript, NULL without digits or beyond int range
+     since no array can have that many elements */
+    const char *begin = path;
+    for (*n = 0; *path >= '0' && *path <= '9'; ++path) {
+        if (*n > (0x7FFFFFFF - (*path - '0')) / 10)
+            return NULL;
+        *n = *n * 10 + (*path - '0');
+    }
+    return (path == begin) ? NULL : path;
+}
+JSON_API struct json_token*
+json_map_query(const struct json_map *m, const char *path)
+{
+    struct json_token *cur = NULL;
+    JSON_ASSERT(m);
+    if (!m || !m->slots) return NULL;
+    if (!path) return m->toks;
+    while (*path) {
+        /* key segment */
+        const char *name = path;
+        while (*path && *path != JSON_DELIMITER && *path != '[')
+            path++;
+        if (path != name) {
+            cur = json_map_find(m, cur, name, (int)(path - name));
+            if (!cur) return NULL;
+        }
+        /* array subscripts */
+        while (*path == '[') {
+            int n;
+            path = json_path_parse_index(path + 1, &n);
+            if (!path || *path++ != ']' || !cur)
+                return NULL;
+            cur = json_map_at(m, cur, n);
+            if (!cur) return NULL;
+        }
+        if (*path == JSON_DELIMITER) path++;
+        else if (*path) return NULL;
+    } return cur;
+}
+JSON_API int
+json_map_query_number(json_number *num, const struct json_map *m,
+    const char *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(num);
+    JSON_ASSERT(m);
+    if (!num || !m || !path)
+        return JSON_NONE;
+
+    tok = json_map_query(m, path);
+    if (!tok) return JSON_NONE;
+    if (tok->type != JSON_NUMBER)
+        return (int)tok->type;
+    return json_convert(num, tok);
+}
+/*--------------------------------------------------------------------------
+                                PATH
+  -------------------------------------------------------------------------*/
+JSON_API int
+json_path_compile(struct json_path *p, const char *path)
+{
+    JSON_ASSERT(p);
+    JSON_ASSERT(path);
+    if (!p || !path) return 0;
+    p->cnt = 0;
+    while (*path) {
+        /* key segment */
+        const char *name = path;
+        while (*path && *path != JSON_DELIMITER && *path != '[')
+            path++;
+        if (path != name) {
+            struct json_path_segment *s;
+            if (p->cnt >= JSON_PATH_MAX) return 0;
+            s = &p->seg[p->cnt++];
+            s->key = name;
+            s->len = (int)(path - name);
+            s->hash = json_hash(name, s->len);
+            s->index = -1;
+        } else if (*path != '[') return 0;
+        /* array subscripts */
+        while (*path == '[') {
+            int n;
+            struct json_path_segment *s;
+            path = json_path_parse_index(path + 1, &n);
+            if (!path || *path++ != ']' || p->cnt >= JSON_PATH_MAX)
+                return 0;
+            s = &p->seg[p->cnt++];
+            s->key = NULL;
+            s->len = 0;
+            s->hash = 0;
+            s->index = n;
+        }
+        if (*path == JSON_DELIMITER) path++;
+        else if (*path) return 0;
+    } return 1;
+}
+JSON_API struct json_token*
+json_query_compiled(struct json_token *toks, int count,
+    const struct json_path *path)
+{
+    int i, j;
+    struct json_token *cur = NULL;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(path);
+    if (!toks || count <= 0 || !path)
+        return NULL;
+    if (!path->cnt) return toks;
+
+    for (i = 0; i < path->cnt; ++i) {
+        const struct json_path_segment *s = &path->seg[i];
+        struct json_token *it, *end;
+        if (s->len) {
+            /* step over pairs until the key matches */
+            if (!cur) {
+                it = toks;
+                end = toks + count;
+            } else if (cur->type == JSON_OBJECT) {
+                it = cur + 1;
+                end = it + cur->sub;
+            } else return NULL;
+            while (it + 1 < end) {
+                if (it->len == s->len && !json_lcmp(it, s->key, s->len))
+                    break;
+                it += 2 + it[1].sub;
+            }
+            if (it + 1 >= end) return NULL;
+            cur = it + 1;
+        } else {
+            /* step over array elements up to the index */
+            if (!cur || cur->type != JSON_ARRAY || s->index >= cur->children)
+                return NULL;
+            it = cur + 1;
+            for (j = 0; j < s->index; ++j)
+                it = json_array_next(it);
+            cur = it;
+        }
+    } return cur;
+}
+JSON_API int
+json_query_compiled_number(json_number *num, struct json_token *toks,
+    int count, const struct json_path *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(num);
+    if (!num) return JSON_NONE;
+    tok = json_query_compiled(toks, count, path);
+    if (!tok) return JSON_NONE;
+    if (tok->type != JSON_NUMBER)
+        return (int)tok->type;
+    return json_convert(num, tok);
+}
+JSON_API int
+json_query_compiled_string(char *buffer, int max, int *size,
+    struct json_token *toks, int count, const struct json_path *path)
+{
+    struct json_token *tok;
+    JSON_ASSERT(buffer);
+    JSON_ASSERT(size);
+    if (!buffer || !size) return JSON_NONE;
+    tok = json_query_compiled(toks, count, path);
+    if (!tok) return JSON_NONE;
+    if (tok->type != JSON_STRING)
+        return (int)tok->type;
+    *size = json_cpy(buffer, max, tok);
+    return (int)tok->type;
+}
+JSON_INTERN void
+json_query_scope(struct json_token *tok, const struct json_token *end,
+    enum json_token_type type, int depth, json_mask active,
+    const struct json_path *paths, struct json_token **out)
+{
+    /* resolves segment `depth` of all active paths inside one object or
+     array; unmatched values are skipped as a whole using `sub` */
+    int i, n = 0;
+    json_mask left = 0, m = active;
+    while (m) {
+        /* drop paths expecting the other container type */
+        const struct json_path_segment *s = &paths[json_ctz(m)].seg[depth];
+        if ((s->len != 0) == (type == JSON_OBJECT))
+            left |= m & (~m + 1);
+        m &= m - 1;
+    }
+    while (left && tok < end) {
+        json_mask hit = 0, deeper = 0;
+        struct json_token *val = (type == JSON_OBJECT) ? tok + 1: tok;
+        if (type == JSON_OBJECT) {
+            unsigned h = 0;
+            int hashed = 0;
+            if (val >= end) break;
+            for (m = left; m; m &= m - 1) {
+                const struct json_path_segment *s = &paths[json_ctz(m)].seg[depth];
+                if (s->len != tok->len) continue;
+                if (!hashed) {
+                    h = json_hash(tok->str, tok->len);
+                    hashed = 1;
+                }
+                if (s->hash == h && !json_lcmp(tok, s->key, s->len))
+                    hit |= m & (~m + 1);
+            }
+        } else {
+            for (m = left; m; m &= m - 1) {
+                if (paths[json_ctz(m)].seg[depth].index == n)
+                    hit |= m & (~m + 1);
+            }
+        }
+        /* the first match decides like in `json_query` */
+        left &= ~hit;
+        for (m = hit; m; m &= m - 1) {
+            i = json_ctz(m);
+            if (depth + 1 == paths[i].cnt)
+                out[i] = val;
+            else deeper |= m & (~m + 1);
+        }
+        if (deeper && (val->type == JSON_OBJECT || val->type == JSON_ARRAY))
+            json_query_scope(val + 1, val + 1 + val->sub, val->type, depth + 1,
+                deeper, paths, out);
+        tok = (val->type == JSON_OBJECT || val->type == JSON_ARRAY) ?
+            val + val->sub + 1: val + 1;
+        n++;
+    }
+}
+JSON_API int
+json_query_many(struct json_token **out, struct json_token *toks, int count,
+    const struct json_path *paths, int num)
+{
+    int i, found = 0;
+    JSON_ASSERT(out);
+    JSON_ASSERT(toks);
+    JSON_ASSERT(paths);
+    if (!out || !toks || count <= 0 || !paths || num <= 0)
+        return 0;
+
+    for (i = 0; i < num; i += 64) {
+        /* one sweep resolves up to 64 paths at once */
+        int j, n = (num - i < 64) ? num - i: 64;
+        json_mask active = 0;
+        for (j = 0; j < n; ++j) {
+            out[i+j] = NULL;
+            if (!paths[i+j].cnt)
+                out[i+j] = toks;
+            else active |= (json_mask)1 << j;
+        }
+        if (active)
+            json_query_scope(toks, toks + count, JSON_OBJECT, 0, active,
+                paths + i, out + i);
+    }
+    for (i = 0; i < num; ++i)
+        found += (out[i] != NULL);
+    return found;
+}
+JSON_API struct json_token*
+json_map_query_compiled(const struct json_map *m, const struct json_path *path)
+{
+    int i, at;
+    struct json_token *cur = NULL;
+    JSON_ASSERT(m);
+    JSON_ASSERT(path);
+    if (!m || !m->slots || !path)
+        return NULL;
+    if (!path->cnt) return m->toks;
+
+    for (i = 0; i < path->cnt; ++i) {
+        const struct json_path_segment *s = &path->seg[i];
+        if (s->len) {
+            if (cur && cur->type != JSON_OBJECT)
+                return NULL;
+            at = json_map_lookup(m, cur, s->key, s->len, s->hash);
+            if (at < 0) return NULL;
+            cur = &m->toks[at];
+        } else if (!cur || !(cur = json_map_at(m, cur, s->index)))
+            return NULL;
+    } return cur;
+}
+/*--------------------------------------------------------------------------
+                                STREAM
+  -------------------------------------------------------------------------*/
+JSON_INTERN int
+json_stream_save(struct json_stream *s, const char *beg, const char *end)
+{
+    /* carries the unfinished part of a token over into the next chunk */
+    int n = (int)(end - beg);
+    if (s->len + n > JSON_STREAM_BUFFER) {
+        s->err = JSON_BUFFER_OVERFLOW;
+        return 0;
+    }
+    for (; beg < end; ++beg)
+        s->buf[s->len++] = *beg;
+    return 1;
+}
+JSON_INTERN int
+json_stream_emit(struct json_stream *s, enum json_stream_event ev,
+    struct json_token *tok)
+{
+    if (s->cb && s->cb(s->usr, ev, tok, s->depth)) {
+        s->err = JSON_ABORTED;
+        return 0;
+    } return 1;
+}
+JSON_INTERN int
+json_stream_token(struct json_stream *s, const char *beg, const char *end)
+{
+    /* completed scalar: either a key or a value depending on its position */
+    struct json_token tok = JSON_TOKEN_NULL;
+    enum json_stream_event ev = JSON_STREAM_VALUE;
+    if (s->len) {
+        if (!json_stream_save(s, beg, end))
+            return 0;
+        beg = s->buf, end = s->buf + s->len;
+        s->len = 0;
+    }
+    tok.str = beg;
+    tok.len = (int)(end - beg);
+    tok.type = json_type(&tok);
+    if (tok.type == JSON_STRING)
+        json_deq(&tok);
+    if (s->depth && s->stk[s->depth-1] == '{') {
+        ev = s->key ? JSON_STREAM_KEY : JSON_STREAM_VALUE;
+        s->key = !s->key;
+    } return json_stream_emit(s, ev, &tok);
+}
+JSON_INTERN int
+json_stream_open(struct json_stream *s, const char *cur)
+{
+    struct json_token tok = JSON_TOKEN_NULL;
+    if (s->depth >= JSON_MAX_DEPTH) {
+        s->err = JSON_STACK_OVERFLOW;
+        return 0;
+    }
+    if (s->depth && s->stk[s->depth-1] == '{' && s->key) {
+        s->err = JSON_PARSING_ERROR;
+        return 0;
+    }
+    tok.str = cur, tok.len = 1;
+    tok.type = (*cur == '{') ? JSON_OBJECT : JSON_ARRAY;
+    if (!json_stream_emit(s, JSON_STREAM_BEGIN, &tok))
+        return 0;
+    s->stk[s->depth++] = *cur;
+    s->key = (*cur == '{');
+    return 1;
+}
+JSON_INTERN int
+json_stream_close(struct json_stream *s, const char *cur)
+{
+    struct json_token tok = JSON_TOKEN_NULL;
+    char open = (*cur == '}') ? '{' : '[';
+    if (!s->depth || s->stk[s->depth-1] != open || (open == '{' && !s->key)) {
+        s->err = JSON_PARSING_ERROR;
+        return 0;
+    }
+    s->depth--;
+    tok.str = cur, tok.len = 1;
+    tok.type = (open == '{') ? JSON_OBJECT : JSON_ARRAY;
+    if (!json_stream_emit(s, JSON_STREAM_END, &tok))
+        return 0;
+    s->key = (s->depth && s->stk[s->depth-1] == '{');
+    return 1;
+}
+JSON_API void
+json_stream_begin(struct json_stream *s, json_stream_callback cb, void *usr)
+{
+    JSON_ASSERT(s);
+    if (!s) return;
+    s->err = JSON_OK;
+    s->cb = cb;
+    s->usr = usr;
+    s->go = json_go_struct;
+    s->utf8 = s->depth = s->key = s->len = 0;
+}
+JSON_API int
+json_stream_feed(struct json_stream *s, const char *chunk, int len)
+{
+    const char *cur, *end, *beg;
+    const char *go;
+    JSON_ASSERT(s);
+    JSON_ASSERT(chunk || !len);
+    if (!s) return JSON_INVAL;
+    if (s->err) return s->err;
+    if (!chunk || len <= 0) return JSON_OK;
+
+    /* a token left unfinished by the last chunk continues at its start */
+    go = s->go;
+    beg = cur = chunk;
+    end = chunk + len;
+    while (cur < end) {
+        switch (go[*(const unsigned char*)cur]) {
+        case JSON_STATE_FAILED:
+            s->err = JSON_PARSING_ERROR;
+            return s->err;
+        case JSON_STATE_UP:
+            if (!json_stream_open(s, cur))
+                return s->err;
+            break;
+        case JSON_STATE_DOWN:
+            if (!json_stream_close(s, cur))
+                return s->err;
+            break;
+        case JSON_STATE_QUP: beg = cur; go = json_go_string; break;
+        case JSON_STATE_QDOWN:
+            go = json_go_struct;
+            if (!json_stream_token(s, beg, cur + 1))
+                return s->err;
+            break;
+        case JSON_STATE_ESC: go = json_go_esc; break;
+        case JSON_STATE_UNESC: go = json_go_string; break;
+        case JSON_STATE_BARE: beg = cur; go = json_go_bare; break;
+        case JSON_STATE_UNBARE:
+            /* delimiter ends the value and is handled as structure */
+            go = json_go_struct;
+            if (!json_stream_token(s, beg, cur))
+                return s->err;
+            continue;
+        case JSON_STATE_UTF8_2: go = json_go_utf8; s->utf8 = 1; break;
+        case JSON_STATE_UTF8_3: go = json_go_utf8; s->utf8 = 2; break;
+        case JSON_STATE_UTF8_4: go = json_go_utf8; s->utf8 = 3; break;
+        case JSON_STATE_UTF8_NEXT:
+            if (!--s->utf8)
+                go = json_go_string;
+            break;
+        default: break;
+        } cur++;
+    }
+    if (go != json_go_struct && !json_stream_save(s, beg, end))
+        return s->err;
+    s->go = go;
+    return JSON_OK;
+}
+JSON_API int
+json_stream_end(struct json_stream *s)
+{
+    JSON_ASSERT(s);
+    if (!s) return JSON_INVAL;
+    if (s->err) return s->err;
+    if (s->go == json_go_bare) {
+        /* bare value running into the end of input */
+        s->go = json_go_struct;
+        if (!json_stream_token(s, s->buf, s->buf))
+            return s->err;
+    }
+    if (s->go != json_go_struct || s->depth)
+        s->err = JSON_PARSING_ERROR;
+    return s->err;
+}
+/*--------------------------------------------------------------------------
+                                LINES
+  -------------------------------------------------------------------------*/
+JSON_INTERN int
+json_line_end(const char *str, int len)
+{
+    /* offset of the next newline or len. Raw newlines are invalid inside
+     strings, so every newline byte of valid input ends a record */
+    int i = 0;
+#if defined(JSON_SIMD_AVX2)
+    const __m256i nl = _mm256_set1_epi8('\n');
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(str + i));
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_SSE2)
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(str + i));
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_NEON)
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8((const unsigned char*)str + i), nl);
+        json_mask m = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (m) return i + (json_ctz(m) >> 2);
+    }
+#else
+    for (; i + 8 <= len; i += 8) {
+        json_mask v = json_load8(str + i) ^ JSON_U64(0x0A0A0A0A, 0x0A0A0A0A);
+        json_mask z = (v - JSON_U64(0x01010101, 0x01010101)) & ~v &
+            JSON_U64(0x80808080, 0x80808080);
+        if (z) return i + (json_ctz(z) >> 3);
+    }
+#endif
+    for (; i < len; ++i)
+        if (str[i] == '\n') return i;
+    return len;
+}
+JSON_API int
+json_lines_split(int *cuts, int parts, const char *str, int len)
+{
+    /* cuts the buffer into parts of similar size at record boundaries so
+     each part can be loaded by its own thread: part i is [cuts[i],cuts[i+1]) */
+    int i, at;
+    JSON_ASSERT(cuts);
+    JSON_ASSERT(parts > 0);
+    if (!cuts || parts <= 0 || (!str && len))
+        return 0;
+
+    cuts[0] = 0;
+    for (i = 1; i < parts; ++i) {
+        at = (int)(((json_int)len * i) / parts);
+        if (at > 0) at--;
+        if (at < cuts[i-1]) at = cuts[i-1];
+        at += json_line_end(str + at, len - at) + 1;
+        cuts[i] = (at < len) ? at : len;
+    }
+    cuts[parts] = len;
+    return parts;
+}
+JSON_API int
+json_load_lines(struct json_lines *l, const char *str, int len)
+{
+    int off = 0, recs = 0, toks = 0, over = 0;
+    struct json_parser p;
+    JSON_ASSERT(l);
+    JSON_ASSERT(str || !len);
+    if (!l || (!str && len))
+        return 0;
+
+    json_parser_init(&p, 0, 0, 0);
+    l->err = JSON_OK;
+    l->cnt = l->used = 0;
+    while (off < len) {
+        const char *line = str + off;
+        int i, need, n = json_line_end(line, len - off);
+        off += n + 1;
+        for (i = 0; i < n && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'); ++i);
+        if (i == n) continue;
+
+        if (over || recs >= l->cap || !l->recs) {
+            /* out of space: only count what the next call needs */
+            need = json_count(line, n);
+            toks += (need > 0) ? need : 0;
+            recs++;
+            continue;
+        }
+        /* records are parsed straight into the remaining arena, which
+         counts exactly if it runs out */
+        l->recs[recs].str = line;
+        l->recs[recs].len = n;
+        l->recs[recs].toks = l->toks ? l->toks + toks : 0;
+        l->recs[recs].cnt = 0;
+        l->recs[recs].err = JSON_OK;
+        if (!l->toks || toks >= l->size) {
+            need = json_count(line, n);
+            if (need < 0) l->recs[recs].err = JSON_PARSING_ERROR;
+            else if (need > 0) over = 1;
+        } else {
+            p.err = JSON_OK;
+            p.toks = l->toks + toks;
+            p.cap = l->size - toks;
+            if (json_load_tape(&p, line, n)) {
+                need = p.cap;
+                over = 1;
+            } else {
+                need = (p.err == JSON_OK) ? p.cnt : 0;
+                l->recs[recs].cnt = need;
+                l->recs[recs].err = p.err;
+            }
+        }
+        toks += (need > 0) ? need : 0;
+        recs++;
+    }
+    if (over || recs > l->cap) {
+        l->cap = recs;
+        l->size = toks;
+        l->err = JSON_OUT_OF_TOKEN;
+        return 1;
+    }
+    l->cnt = recs;
+    l->used = toks;
+    return 0;
+}
+/*--------------------------------------------------------------------------
+                                PARALLEL
+  -------------------------------------------------------------------------*/
+/* Parts are scanned in two concurrent rounds. Counting tokens requires to
+ know whether a part starts inside a string, which only follows from the
+ quote parity of all parts in front of it. So each part guesses its start
+ state from the first quote it sees and counts speculatively. Quote counts
+ do not depend on the start state, so their parities resolve the actual
+ states afterwards and only mispredicted parts are counted again. The
+ second round builds each part into its exact slice of the token array,
+ while containers and strings crossing part boundaries are recorded and
+ stitched together in a short sequential merge. */
+struct json_parallel {
+    struct json_parser *p;
+    const char *src;
+    int len;
+    struct json_chunk *parts;
+    int cnt;
+    int redo; /* only count mispredicted parts */
+};
+JSON_INTERN int
+json_part_cut(char c)
+{
+    /* bytes a part can start with without splitting a bare value */
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' ||
+        c == ':' || c == '{' || c == '}' || c == '[' || c == ']' || !c;
+}
+JSON_INTERN int
+json_part_guess(const struct json_chunk *c)
+{
+    /* a quote followed by a separator or closing bracket most likely ends
+     a string, so the part would start inside of it */
+    int i, n = (c->len < 1024) ? c->len : 1024, escaped = c->escaped;
+    for (i = 0; i < n; ++i) {
+        if (escaped) escaped = 0;
+        else if (c->str[i] == '\\') escaped = 1;
+        else if (c->str[i] == '"') break;
+    }
+    for (++i; i < n; ++i) {
+        char ch = c->str[i];
+        if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r')
+            return ch == ',' || ch == ':' || ch == '}' || ch == ']';
+    } return 0;
+}
+JSON_INTERN void
+json_part_quotes(struct json_chunk *c)
+{
+    /* unescaped quotes for parts whose scan failed with a wrong guess */
+    int i, escaped = c->escaped;
+    c->quotes = 0;
+    for (i = 0; i < c->len && c->str[i]; ++i) {
+        if (escaped) escaped = 0;
+        else if (c->str[i] == '\\') escaped = 1;
+        else c->quotes += (c->str[i] == '"');
+    } c->end = (i < c->len);
+}
+JSON_INTERN void
+json_part_scan(struct json_scanner *s, const struct json_chunk *c, int string)
+{
+    json_scan_begin(s, c->str, c->len);
+    s->escaped = (json_mask)c->escaped;
+    s->string = string ? ~(json_mask)0 : 0;
+}
+JSON_INTERN int
+json_part_failed(const struct json_scanner *s, const struct json_chunk *c, int last)
+{
+    /* the end of input inside a string is only an error for the last part */
+    return s->err && (s->pos < s->len || s->utf8 || s->len < c->len || last);
+}
+JSON_INTERN void
+json_part_count(void *arg, int i)
+{
+    struct json_parallel *ctx = (struct json_parallel*)arg;
+    struct json_chunk *c = &ctx->parts[i];
+    struct json_scanner s;
+    json_mask bits;
+
+    if (ctx->redo && c->guess == c->string) return;
+    if (ctx->redo) c->guess = c->string;
+    else c->guess = i ? json_part_guess(c) : 0;
+    c->err = JSON_OK;
+    c->quotes = c->values = c->opened = 0;
+    c->depth = c->low = c->roots = 0;
+
+    json_part_scan(&s, c, c->guess);
+    while (json_scan(&s, &bits) >= 0) {
+        int opens = json_popcnt(s.open);
+        int closes = json_popcnt(s.close);
+        c->quotes += json_popcnt(s.quote);
+        c->values += json_popcnt(s.value);
+        c->opened += opens;
+        if (closes < c->depth - c->low) {
+            c->depth += opens - closes;
+            continue;
+        }
+        /* brackets are only walked while the lowest depth could change */
+        bits = s.open | s.close;
+        while (bits) {
+            if (s.open & bits & (~bits + 1)) {
+                c->roots += (c->depth == c->low);
+                c->depth++;
+            } else if (--c->depth < c->low) {
+                c->low = c->depth;
+                c->roots = 0;
+            } bits &= bits - 1;
+        }
+    }
+    c->end = (s.len < c->len);
+    if (json_part_failed(&s, c, i == ctx->cnt - 1)) {
+        c->err = JSON_PARSING_ERROR;
+        json_part_quotes(c);
+    }
+}
+JSON_INTERN void
+json_part_build(void *arg, int i)
+{
+    struct json_parallel *ctx = (struct json_parallel*)arg;
+    struct json_chunk *c = &ctx->parts[i];
+    struct json_scanner s;
+    struct json_builder b;
+    json_mask bits;
+    int base, off = (int)(c->str - ctx->src);
+
+    json_build_init(&b, ctx->src, ctx->len);
+    b.toks = ctx->p->toks + c->off;
+    b.cap = c->cnt;
+    b.outer = c->outer;
+    b.chunk = c;
+    b.quote = c->string ? -2 : -1;
+    c->closes = c->kids[0] = 0;
+    c->quote = c->tail = -1;
+
+    json_part_scan(&s, c, c->string);
+    while ((base = json_scan(&s, &bits)) >= 0) {
+        while (bits) {
+            if (!json_build(&b, off + base + json_ctz(bits))) {
+                c->err = b.err;
+                return;
+            } bits &= bits - 1;
+        }
+    }
+    if (json_part_failed(&s, c, i == ctx->cnt - 1)) {
+        c->err = JSON_PARSING_ERROR;
+        return;
+    }
+    if (b.quote >= 0) {
+        /* string ended by a later part, its length is set when merging */
+        c->tail = b.cnt;
+        json_build_push(&b, b.src + b.quote + 1, 0, JSON_STRING);
+    }
+    for (c->pending = 0; c->pending < b.depth; ++c->pending)
+        c->stk[c->pending] = b.stk[c->pending];
+    if (b.cnt != c->cnt)
+        c->err = JSON_PARSING_ERROR;
+}
+JSON_INTERN void
+json_part_run(json_run_callback run, void *usr, json_task task, void *arg, int cnt)
+{
+    int i;
+    if (run) run(usr, task, arg, cnt);
+    else for (i = 0; i < cnt; ++i)
+        task(arg, i);
+}
+JSON_INTERN enum json_status
+json_part_merge(struct json_parallel *ctx)
+{
+    /* patches containers and strings left open by a part with what later
+     parts recorded about them */
+    int i, k, d = 0, str = -1;
+    int stk[JSON_MAX_DEPTH];
+    struct json_token *toks = ctx->p->toks;
+    for (i = 0; i < ctx->cnt; ++i) {
+        const struct json_chunk *c = &ctx->parts[i];
+        if (c->err) return c->err;
+        if (str >= 0 && c->quote >= 0) {
+            toks[str].len = (int)(ctx->src + c->quote - toks[str].str);
+            str = -1;
+        }
+        for (k = 0; k < c->closes; ++k) {
+            int e = stk[--d], idx = (e >> 1) - 1;
+            if ((e & 1) != (ctx->src[c->close[k]] == ']'))
+                return JSON_PARSING_ERROR;
+            if (idx < 0) continue;
+            toks[idx].children += c->kids[k];
+            toks[idx].len = (int)(ctx->src + c->close[k] - toks[idx].str) + 1;
+            toks[idx].sub = c->off + c->count[k] - idx - 1;
+        }
+        if (d && stk[d-1] >> 1)
+            toks[(stk[d-1] >> 1) - 1].children += c->kids[c->closes];
+        for (k = 0; k < c->pending; ++k) {
+            int e = c->stk[k];
+            stk[d++] = (e >> 1) ? ((c->off + (e >> 1)) << 1) | (e & 1) : e;
+        }
+        if (c->tail >= 0)
+            str = c->off + c->tail;
+    } return (d || str >= 0) ? JSON_PARSING_ERROR : JSON_OK;
+}
+JSON_API int
+json_load_parallel(struct json_parser *p, const char *str, int len,
+    struct json_chunk *parts, int cnt, json_run_callback run, void *usr)
+{
+    int i, k, at, state, depth, total, redo = 0;
+    struct json_parallel ctx;
+
+    JSON_ASSERT(p);
+    JSON_ASSERT(str);
+    JSON_ASSERT(len > 0);
+    JSON_ASSERT(parts);
+    JSON_ASSERT(cnt > 0);
+    if (!p || !str || !len || !parts || cnt <= 0)
+        return 0;
+
+    /* parts start at whitespace or an operator so bare values stay whole */
+    for (i = at = 0; i < cnt; ++i) {
+        int end = (int)(((json_int)len * (i + 1)) / cnt);
+        end = (end < at) ? at : end;
+        while (end < len && !json_part_cut(str[end])) end++;
+        parts[i].str = str + at;
+        parts[i].len = end - at;
+        parts[i].escaped = 0;
+        for (k = at; k > 0 && str[k-1] == '\\'; --k)
+            parts[i].escaped ^= 1;
+        at = end;
+    }
+    ctx.p = p;
+    ctx.src = str;
+    ctx.len = len;
+    ctx.parts = parts;
+    ctx.cnt = cnt;
+    ctx.redo = 0;
+
+    /* count speculatively, then again for mispredicted start states */
+    json_part_run(run, usr, json_part_count, &ctx, cnt);
+    for (state = i = 0; i < cnt; ++i) {
+        parts[i].string = state;
+        redo += (parts[i].guess != state);
+        state ^= parts[i].quotes & 1;
+        if (parts[i].end) {
+            /* input ends at '\0', later parts are ignored */
+            ctx.cnt = i + 1;
+            break;
+        }
+    }
+    if (redo) {
+        ctx.redo = 1;
+        json_part_run(run, usr, json_part_count, &ctx, ctx.cnt);
+    }
+    for (depth = total = i = 0; i < ctx.cnt; ++i) {
+        struct json_chunk *c = &parts[i];
+        if (c->err || depth + c->low < 0) {
+            p->err = c->err ? c->err : JSON_PARSING_ERROR;
+            return 0;
+        }
+        c->outer = depth;
+        c->off = total;
+        c->cnt = c->values + c->opened + ((c->quotes + !c->string) >> 1);
+        if (depth + c->low == 0) c->cnt -= c->roots;
+        total += c->cnt;
+        depth += c->depth;
+    }
+    if (!p->toks || p->cap < total) {
+        p->cap = total ? total : 1;
+        p->err = JSON_OUT_OF_TOKEN;
+        return 1;
+    }
+    /* build every part into its slice and stitch them together */
+    json_part_run(run, usr, json_part_build, &ctx, ctx.cnt);
+    p->err = json_part_merge(&ctx);
+    p->cnt = (p->err == JSON_OK) ? total : 0;
+    return 0;
+}
+/*--------------------------------------------------------------------------
+                                RELOAD
+  -------------------------------------------------------------------------*/
+JSON_INTERN int
+json_reload_span(struct json_builder *b, int from, int to)
+{
+    /* builds the object/array spanning [from,to) including its own token,
+     failing if it closes early since the edit changed the structure */
+    struct json_scanner s;
+    json_mask bits;
+    int base;
+    json_scan_begin(&s, b->src + from, to - from);
+    while ((base = json_scan(&s, &bits)) >= 0) {
+        while (bits) {
+            int pos = from + base + json_ctz(bits);
+            if (!b->depth && pos > from) {
+                b->err = JSON_PARSING_ERROR;
+                return 0;
+            }
+            if (!json_build(b, pos)) return 0;
+            bits &= bits - 1;
+        }
+    }
+    if (s.err) b->err = JSON_PARSING_ERROR;
+    else if (b->depth || b->quote >= 0)
+        b->err = JSON_PARSING_ERROR;
+    return !b->err;
+}
+JSON_API int
+json_reload(struct json_parser *p, const char *old, const char *str, int len,
+    int at, int del, int ins)
+{
+    int i, cur, from = 0, to = 0, tail, n, depth = 0, root = 0, shift = ins - del;
+    int path[JSON_MAX_DEPTH];
+    struct json_builder b;
+
+    JSON_ASSERT(p);
+    JSON_ASSERT(old);
+    JSON_ASSERT(str);
+    if (!p || !old || !str || len <= 0 || at < 0 || del < 0 || ins < 0 || at + ins > len)
+        return 0;
+    if ((p->err != JSON_OK && p->err != JSON_OUT_OF_TOKEN) || !p->toks) {
+        /* tokens of a failed load can not be patched */
+        p->err = JSON_INVAL;
+        return 0;
+    }
+    /* objects/arrays with the edit strictly between their brackets */
+    for (i = 0, n = p->cnt; i < n;) {
+        const struct json_token *t = &p->toks[i];
+        int off = (int)(t->str - old);
+        if (off > at) break;
+        if ((t->type == JSON_OBJECT || t->type == JSON_ARRAY) &&
+            off < at && at + del < off + t->len && depth < JSON_MAX_DEPTH) {
+            path[depth++] = i;
+            n = i + t->sub + 1;
+            i++;
+        } else i += t->sub + 1;
+    }
+    /* the transparent root counts towards the depth limit */
+    for (i = 0; i < len && json_go_struct[(unsigned char)str[i]] == JSON_STATE_LOOP; ++i);
+    root = (i < len && (str[i] == '{' || str[i] == '['));
+
+    /* count and validate first so tokens stay untouched on failure. Edits
+     that change the structure fall back to the enclosing container */
+    for (; depth > 0; --depth) {
+        const struct json_token *t = &p->toks[path[depth-1]];
+        from = (int)(t->str - old);
+        to = from + t->len + shift;
+        if (to > len) continue;
+        json_build_init(&b, str, to);
+        b.outer = root + depth - 1;
+        if (json_reload_span(&b, from, to)) break;
+    }
+    if (!depth) {
+        /* edit outside of any object/array: load everything again */
+        p->cnt = 0;
+        return json_load_tape(p, str, len);
+    }
+    cur = path[depth-1];
+    n = b.cnt;
+    tail = cur + 1 + p->toks[cur].sub;
+    if (p->cnt - tail + cur + n > p->cap) {
+        p->cap = p->cnt - tail + cur + n;
+        p->err = JSON_OUT_OF_TOKEN;
+        return 1;
+    }
+    /* move tokens behind the container and shift them to the new text */
+    if (cur + n > tail) {
+        for (i = p->cnt - 1; i >= tail; --i) {
+            p->toks[i + cur + n - tail] = p->toks[i];
+            p->toks[i + cur + n - tail].str = str + (p->toks[i].str - old) + shift;
+        }
+    } else {
+        for (i = tail; i < p->cnt; ++i) {
+            p->toks[i + cur + n - tail] = p->toks[i];
+            p->toks[i + cur + n - tail].str = str + (p->toks[i].str - old) + shift;
+        }
+    }
+    if (old != str) {
+        for (i = 0; i < cur; ++i)
+            p->toks[i].str = str + (p->toks[i].str - old);
+    }
+    for (i = 0; i < depth - 1; ++i) {
+        p->toks[path[i]].len += shift;
+        p->toks[path[i]].sub += cur + n - tail;
+    }
+    p->cnt += cur + n - tail;
+
+    /* rebuild the container in place */
+    json_build_init(&b, str, to);
+    b.toks = p->toks + cur;
+    b.cap = n;
+    b.outer = root + depth - 1;
+    json_reload_span(&b, from, to);
+    p->err = b.err;
+    return 0;
+}
+/*--------------------------------------------------------------------------
+                                COMPACT
+  -------------------------------------------------------------------------*/
+JSON_API struct json_token
+json_compact_token(const struct json_compact *c, const struct json_ctoken *tok)
+{
+    /* expands a compact token into a regular one */
+    struct json_token t = JSON_TOKEN_NULL;
+    JSON_ASSERT(c);
+    if (!c || !tok) return t;
+    t.str = c->src + tok->off;
+    t.len = tok->len;
+    t.type = (enum json_token_type)(tok->info & 15);
+    t.children = tok->info >> 4;
+    t.sub = tok->sub;
+    return t;
+}
+JSON_API enum json_token_type
+json_compact_type(const struct json_ctoken *tok)
+{
+    return tok ? (enum json_token_type)(tok->info & 15) : JSON_NONE;
+}
+JSON_API int
+json_compact_children(const struct json_ctoken *tok)
+{
+    return tok ? tok->info >> 4 : 0;
+}
+JSON_API struct json_ctoken*
+json_compact_array_begin(struct json_ctoken *tok)
+{
+    JSON_ASSERT(tok);
+    if (!tok) return NULL;
+    if ((tok->info & 15) != JSON_ARRAY) return NULL;
+    return tok + 1;
+}
+JSON_API struct json_ctoken*
+json_compact_array_next(struct json_ctoken *tok)
+{
+    JSON_ASSERT(tok);
+    if (!tok) return NULL;
+    return (tok + 1) + tok->sub;
+}
+JSON_API struct json_ctoken*
+json_compact_obj_begin(struct json_ctoken *tok)
+{
+    JSON_ASSERT(tok);
+    if (!tok) return NULL;
+    if ((tok->info & 15) != JSON_OBJECT) return NULL;
+    return tok + 1;
+}
+JSON_API struct json_ctoken*
+json_compact_obj_next(struct json_ctoken *tok)
+{
+    JSON_ASSERT(tok);
+    if (!tok) return NULL;
+    return (tok + 2) + tok[1].sub;
+}
+JSON_API struct json_ctoken*
+json_compact_query_compiled(const struct json_compact *c,
+    struct json_ctoken *toks, int count, const struct json_path *path)
+{
+    int i, j;
+    struct json_ctoken *cur = NULL;
+    JSON_ASSERT(c);
+    JSON_ASSERT(toks);
+    JSON_ASSERT(path);
+    if (!c || !toks || count <= 0 || !path)
+        return NULL;
+    if (!path->cnt) return toks;
+
+    for (i = 0; i < path->cnt; ++i) {
+        const struct json_path_segment *s = &path->seg[i];
+        struct json_ctoken *it, *end;
+        if (s->len) {
+            /* step over pairs until the key matches */
+            if (!cur) {
+                it = toks;
+                end = toks + count;
+            } else if ((cur->info & 15) == JSON_OBJECT) {
+                it = cur + 1;
+                end = it + cur->sub;
+            } else return NULL;
+            for (; it + 1 < end; it = json_compact_obj_next(it)) {
+                const char *key = c->src + it->off;
+                if (it->len != s->len) continue;
+                for (j = 0; j < s->len && key[j] == s->key[j]; ++j);
+                if (j == s->len) break;
+            }
+            if (it + 1 >= end) return NULL;
+            cur = it + 1;
+        } else {
+            /* step over array elements up to the index */
+            if (!cur || (cur->info & 15) != JSON_ARRAY || s->index >= (cur->info >> 4))
+                return NULL;
+            it = cur + 1;
+            for (j = 0; j < s->index; ++j)
+                it = json_compact_array_next(it);
+            cur = it;
+        }
+    } return cur;
+}
+JSON_API struct json_ctoken*
+json_compact_query(const struct json_compact *c, struct json_ctoken *toks,
+    int count, const char *path)
+{
+    struct json_path p;
+    JSON_ASSERT(path);
+    if (!path) return toks;
+    if (!json_path_compile(&p, path))
+        return NULL;
+    return json_compact_query_compiled(c, toks, count, &p);
+}
+JSON_API int
+json_compact_query_number(json_number *num, const struct json_compact *c,
+    struct json_ctoken *toks, int count, const char *path)
+{
+    struct json_token tok;
+    struct json_ctoken *ct;
+    JSON_ASSERT(num);
+    if (!num) return JSON_NONE;
+    ct = json_compact_query(c, toks, count, path);
+    if (!ct) return JSON_NONE;
+    tok = json_compact_token(c, ct);
+    if (tok.type != JSON_NUMBER)
+        return (int)tok.type;
+    return json_convert(num, &tok);
+}
+JSON_API int
+json_compact_query_string(char *buffer, int max, int *size,
+    const struct json_compact *c, struct json_ctoken *toks, int count,
+    const char *path)
+{
+    struct json_token tok;
+    struct json_ctoken *ct;
+    JSON_ASSERT(buffer);
+    JSON_ASSERT(size);
+    if (!buffer || !size) return JSON_NONE;
+    ct = json_compact_query(c, toks, count, path);
+    if (!ct) return JSON_NONE;
+    tok = json_compact_token(c, ct);
+    if (tok.type != JSON_STRING)
+        return (int)tok.type;
+    *size = json_cpy(buffer, max, &tok);
+    return (int)tok.type;
+}
+/*--------------------------------------------------------------------------
+                                CURSOR
+  -------------------------------------------------------------------------*/
+JSON_INTERN const char*
+json_cursor_ws(const char *cur, const char *end)
+{
+    /* steps over whitespace and separators like the tokenizer does */
+    while (cur < end) {
+        int state = json_go_struct[*(const unsigned char*)cur];
+        if (state != JSON_STATE_LOOP && state != JSON_STATE_SEP)
+            break;
+        cur++;
+    } return cur;
+}
+JSON_INTERN int
+json_cursor_scalar(struct json_cursor *c, struct json_token *tok)
+{
+    /* reads a single string or bare value with the tokenizer */
+    struct json_iter it = JSON_ITER_NULL;
+    it.src = c->cur;
+    it.len = (int)(c->end - c->cur);
+    it = json_read(tok, &it);
+    if (it.err || !tok->str || (!it.src && tok->type == JSON_STRING)) {
+        c->err = JSON_PARSING_ERROR;
+        return 0;
+    }
+    c->cur = it.src ? it.src : c->end;
+    return 1;
+}
+JSON_INTERN const char*
+json_cursor_balance(struct json_cursor *c, const char *from, int depth)
+{
+    /* returns the byte after the bracket closing `depth` open containers.
+     The scanner classifies 64 bytes per step (strings are masked out), so
+     only blocks in which the depth can reach zero are walked bit by bit */
+    struct json_scanner s;
+    json_mask bits;
+    int base;
+
+    json_scan_begin(&s, from, (int)(c->end - from));
+    while ((base = json_scan(&s, &bits)) >= 0) {
+        json_mask open = s.open;
+        int n = json_popcnt(s.close);
+        if (n < depth) {
+            depth += json_popcnt(open) - n;
+            continue;
+        }
+        bits = open | s.close;
+        while (bits) {
+            int i = json_ctz(bits);
+            depth += ((open >> i) & 1) ? 1 : -1;
+            if (!depth) return from + base + i + 1;
+            bits &= bits - 1;
+        }
+    }
+    c->err = JSON_PARSING_ERROR;
+    return NULL;
+}
+JSON_API int
+json_cursor_begin(struct json_cursor *c, const char *str, int len)
+{
+    JSON_ASSERT(c);
+    JSON_ASSERT(str);
+    if (!c) return JSON_INVAL;
+    c->err = JSON_OK;
+    c->src = c->cur = str;
+    c->end = str + ((str && len > 0) ? len : 0);
+    c->open = NULL;
+    c->depth = 0;
+    if (!str || len <= 0)
+        return (c->err = JSON_INVAL);
+
+    /* root without brackets is read as an object up to the end of input */
+    c->cur = json_cursor_ws(str, c->end);
+    if (c->cur < c->end && (*c->cur == '{' || *c->cur == '['))
+        c->stk[0] = *c->cur++;
+    else c->stk[0] = 0;
+    c->depth = 1;
+    return JSON_OK;
+}
+JSON_API int
+json_cursor_next(struct json_cursor *c, struct json_token *key,
+    struct json_token *val)
+{
+    char open;
+    JSON_ASSERT(c);
+    JSON_ASSERT(val);
+    if (!c || !val) return 0;
+    *val = JSON_TOKEN_NULL;
+    if (key) *key = JSON_TOKEN_NULL;
+    if (c->err || !c->depth) return 0;
+    if (c->open && json_cursor_skip(c, NULL))
+        return 0;
+
+    open = c->stk[c->depth-1];
+    c->cur = json_cursor_ws(c->cur, c->end);
+    if (c->cur == c->end || !*c->cur) {
+        /* only the implicit root object runs into the end of input */
+        if (open) c->err = JSON_PARSING_ERROR;
+        return 0;
+    }
+    if (*c->cur == '}' || *c->cur == ']')
+        return 0;
+    if (open != '[') {
+        struct json_token name;
+        if (*c->cur == '{' || *c->cur == '[') {
+            c->err = JSON_PARSING_ERROR;
+            return 0;
+        }
+        if (!json_cursor_scalar(c, &name))
+            return 0;
+        if (key) *key = name;
+        c->cur = json_cursor_ws(c->cur, c->end);
+        if (c->cur == c->end || !*c->cur || *c->cur == '}' || *c->cur == ']') {
+            c->err = JSON_PARSING_ERROR;
+            return 0;
+        }
+    }
+    if (*c->cur == '{' || *c->cur == '[') {
+        /* stays unread until the next call skips or enters it */
+        val->str = c->open = c->cur;
+        val->len = 1;
+        val->type = (*c->cur == '{') ? JSON_OBJECT : JSON_ARRAY;
+        return 1;
+    } return json_cursor_scalar(c, val);
+}
+JSON_API int
+json_cursor_find(struct json_cursor *c, struct json_token *val,
+    const char *key, int len)
+{
+    /* searches the current object forward from the read position */
+    struct json_token name;
+    JSON_ASSERT(c);
+    JSON_ASSERT(key);
+    if (!c || !key || !c->depth || c->stk[c->depth-1] == '[')
+        return 0;
+    while (json_cursor_next(c, &name, val)) {
+        if (!json_lcmp(&name, key, len))
+            return 1;
+    } return 0;
+}
+JSON_API int
+json_cursor_at(struct json_cursor *c, struct json_token *val, int index)
+{
+    /* index counts elements from the read position of the current array */
+    JSON_ASSERT(c);
+    if (!c || index < 0 || !c->depth || c->stk[c->depth-1] != '[')
+        return 0;
+    do {
+        if (!json_cursor_next(c, NULL, val))
+            return 0;
+    } while (index--);
+    return 1;
+}
+JSON_API int
+json_cursor_enter(struct json_cursor *c)
+{
+    JSON_ASSERT(c);
+    if (!c) return JSON_INVAL;
+    if (c->err) return c->err;
+    if (!c->open) return JSON_INVAL;
+    if (c->depth >= JSON_MAX_DEPTH)
+        return (c->err = JSON_STACK_OVERFLOW);
+    c->stk[c->depth++] = *c->open;
+    c->cur = c->open + 1;
+    c->open = NULL;
+    return JSON_OK;
+}
+JSON_API int
+json_cursor_leave(struct json_cursor *c)
+{
+    /* skips the rest of the current container including its closing bracket */
+    const char *end;
+    char open;
+    JSON_ASSERT(c);
+    if (!c) return JSON_INVAL;
+    if (c->err) return c->err;
+    if (!c->depth) return JSON_INVAL;
+    open = c->stk[c->depth-1];
+    if (!open) {
+        c->cur = c->end;
+    } else {
+        end = json_cursor_balance(c, c->open ? c->open : c->cur, 1);
+        if (!end) return c->err;
+        if (end[-1] != ((open == '{') ? '}' : ']'))
+            return (c->err = JSON_PARSING_ERROR);
+        c->cur = end;
+    }
+    c->open = NULL;
+    c->depth--;
+    return JSON_OK;
+}
+JSON_API int
+json_cursor_skip(struct json_cursor *c, struct json_token *val)
+{
+    /* steps over the container returned last and extends its token to
+     the full text of the container */
+    const char *end;
+    JSON_ASSERT(c);
+    if (!c) return JSON_INVAL;
+    if (c->err) return c->err;
+    if (!c->open) return JSON_OK;
+    end = json_cursor_balance(c, c->open, 0);
+    if (!end) return c->err;
+    if (val) {
+        val->str = c->open;
+        val->len = (int)(end - c->open);
+        val->type = (*c->open == '{') ? JSON_OBJECT : JSON_ARRAY;
+    }
+    c->cur = end;
+    c->open = NULL;
+    return JSON_OK;
+}
+JSON_API int
+json_cursor_query(struct json_cursor *c, struct json_token *val,
+    const char *path)
+{
+    /* resolves the path from the document root, entering only the
+     containers along the path. The cursor stays on the found value */
+    int i;
+    struct json_path p;
+    JSON_ASSERT(c);
+    JSON_ASSERT(val);
+    JSON_ASSERT(path);
+    if (!c || !val || !path) return 0;
+    if (!json_path_compile(&p, path) || !p.cnt)
+        return 0;
+    if (json_cursor_begin(c, c->src, (int)(c->end - c->src)))
+        return 0;
+    for (i = 0; i < p.cnt; ++i) {
+        const struct json_path_segment *s = &p.seg[i];
+        if (i && json_cursor_enter(c))
+            return 0;
+        if (s->len) {
+            if (!json_cursor_find(c, val, s->key, s->len))
+                return 0;
+        } else if (!json_cursor_at(c, val, s->index))
+            return 0;
+    } return 1;
+}
+/*--------------------------------------------------------------------------
+                                WRITER
+  -------------------------------------------------------------------------*/
+JSON_GLOBAL const char json_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+JSON_INTERN int
+json_format_uint(char *out, json_uint v)
+{
+    /* writes two digits per division from the back */
+    char tmp[20];
+    int i, n = 20;
+    while (v >= 100) {
+        int r = (int)(v % 100) * 2;
+        v /= 100;
+        tmp[--n] = json_digit_pairs[r + 1];
+        tmp[--n] = json_digit_pairs[r];
+    }
+    if (v >= 10) {
+        tmp[--n] = json_digit_pairs[v * 2 + 1];
+        tmp[--n] = json_digit_pairs[v * 2];
+    } else tmp[--n] = (char)('0' + v);
+    for (i = 0; n < 20; ++i, ++n)
+        out[i] = tmp[n];
+    return i;
+}
+JSON_INTERN void
+json_scale(json_mask *f, json_mask n, const json_mask *p, int s)
+{
+    /* (n * p) >> s for a 128-bit power of five p (high word first) as
+     128-bit result (low word first) */
+    json_mask w0, w1, w2, t;
+    w0 = json_mul128(n, p[1], &w1);
+    t = json_mul128(n, p[0], &w2);
+    w1 += t;
+    if (w1 < t) w2++;
+    while (s >= 64) {
+        w0 = w1, w1 = w2, w2 = 0;
+        s -= 64;
+    }
+    if (s > 0) {
+        w0 = (w0 >> s) | (w1 << (64 - s));
+        w1 = (w1 >> s) | (w2 << (64 - s));
+    }
+    f[0] = w0, f[1] = w1;
+}
+#define JSON_FORMAT_EPS 4
+JSON_INTERN int
+json_format_double(char *out, json_number v)
+{
+    /* Shortest digits that read back as v. The rounding interval of v is
+     scaled by 10^q into 64.64 fixed point with the 128-bit powers of five,
+     so it holds 17 to 19 digit integers. Trailing digits are dropped for as
+     long as a multiple of the dropped power of ten lies inside the interval
+     (narrowed by the error of the truncated powers), picking the multiple
+     closest to v. Boundaries within that error are only accepted after
+     reading the shorter candidate back. At most 25 bytes are written. */
+    union {json_number d; json_mask u;} b;
+    json_mask m, bits, lo[2], mid[2], hi[2], l, h, d, c, r, t;
+    int e2, q, s, i, n, p, up, exp10, len = 0;
+    char dig[20];
+
+    b.d = v;
+    bits = b.u & ~((json_uint)1 << 63);
+    if (b.u >> 63) out[len++] = '-';
+    e2 = (int)(bits >> 52);
+    m = bits & JSON_U64(0x000FFFFF, 0xFFFFFFFF);
+    if (!e2 && !m) {
+        out[len++] = '0';
+        return len;
+    }
+    if (e2) {
+        m |= (json_uint)1 << 52;
+        e2 -= 1075;
+    } else e2 = -1074;
+    if (e2 <= 0 && e2 > -53 && !(m & (((json_uint)1 << -e2) - 1)))
+        return len + json_format_uint(out + len, m >> -e2);
+
+    /* floor(log10(v)) or one less, so v * 10^q lies in [10^16, 10^18) */
+    q = 16 - (((e2 + 63 - json_clz(m)) * 78913) >> 18);
+    s = 65 - e2 - (((152170 + 65536) * q) >> 16);
+    json_scale(mid, m << 2, &json_pow5[2*(q+342)], s);
+    json_scale(hi, (m << 2) + 2, &json_pow5[2*(q+342)], s);
+    json_scale(lo, (m << 2) - ((m == ((json_uint)1 << 52) && e2 > -1074) ? 1 : 2),
+        &json_pow5[2*(q+342)], s);
+
+    /* integers strictly inside the narrowed interval */
+    t = lo[0] + JSON_FORMAT_EPS;
+    l = lo[1] + (t < JSON_FORMAT_EPS) + 1;
+    t = hi[0] - JSON_FORMAT_EPS;
+    h = hi[1] - (hi[0] < JSON_FORMAT_EPS);
+    h -= (t == 0);
+
+    exp10 = -q;
+    for (d = 1; h / (d * 10) * (d * 10) >= l; d *= 10)
+        exp10++;
+    c = mid[1] / d;
+    r = mid[1] % d;
+    if (d == 1) up = mid[0] > ((json_uint)1 << 63) || (mid[0] == ((json_uint)1 << 63) && (c & 1));
+    else up = r > d / 2 || (r == d / 2 && (mid[0] || (c & 1)));
+    c = (c + (json_mask)up) * d;
+    if (c < l) c += d;
+    else if (c > h) c -= d;
+    c /= d;
+
+    /* shorter candidates on the boundaries */
+    l = lo[1] - (lo[0] < JSON_FORMAT_EPS);
+    l += ((lo[0] - JSON_FORMAT_EPS) != 0);
+    t = hi[0] + JSON_FORMAT_EPS;
+    h = hi[1] + (t < JSON_FORMAT_EPS);
+    for (d *= 10; d <= h && (t = h / d * d) >= l; d *= 10) {
+        if (json_lemire(t / d, exp10 + 1) == bits) {
+            c = t / d;
+            exp10++;
+        } else if ((t = (l + d - 1) / d * d) <= h &&
+            json_lemire(t / d, exp10 + 1) == bits) {
+            c = t / d;
+            exp10++;
+        } else break;
+    }
+
+    /* digits in plain, fractional or exponential notation */
+    n = json_format_uint(dig, c);
+    p = n + exp10;
+    if (p > 21 || p < -5) {
+        out[len++] = dig[0];
+        if (n > 1) out[len++] = '.';
+        for (i = 1; i < n; ++i)
+            out[len++] = dig[i];
+        out[len++] = 'e';
+        if (p - 1 < 0) out[len++] = '-';
+        len += json_format_uint(out + len, (json_uint)((p - 1 < 0) ? 1 - p : p - 1));
+    } else if (p <= 0) {
+        out[len++] = '0';
+        out[len++] = '.';
+        for (i = 0; i < -p; ++i)
+            out[len++] = '0';
+        for (i = 0; i < n; ++i)
+            out[len++] = dig[i];
+    } else {
+        for (i = 0; i < n; ++i) {
+            if (i == p) out[len++] = '.';
+            out[len++] = dig[i];
+        }
+        for (; i < p; ++i)
+            out[len++] = '0';
+    } return len;
+}
+JSON_INTERN int
+json_escape_run(char *dst, int room, const char *str, int len)
+{
+    /* length of the run up to the next byte that needs escaping (quote,
+     backslash, control byte or DEL, which json_load refuses raw). Bytes
+     of the run are copied into dst while searching as long as they fit
+     into room */
+    int i = 0;
+#if defined(JSON_SIMD_AVX2)
+    const __m256i c1f = _mm256_set1_epi8(0x1F);
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    for (; i + 32 <= len && i + 32 <= room; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(str + i));
+        __m256i x = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(v, c1f), v), _mm256_cmpeq_epi8(v, del)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, bslash)));
+        unsigned m = (unsigned)_mm256_movemask_epi8(x);
+        _mm256_storeu_si256((__m256i*)(void*)(dst + i), v);
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_SSE2)
+    const __m128i c1f = _mm_set1_epi8(0x1F);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i del = _mm_set1_epi8(0x7F);
+    for (; i + 16 <= len && i + 16 <= room; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(str + i));
+        __m128i x = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(v, c1f), v), _mm_cmpeq_epi8(v, del)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)));
+        unsigned m = (unsigned)_mm_movemask_epi8(x);
+        _mm_storeu_si128((__m128i*)(void*)(dst + i), v);
+        if (m) return i + json_ctz(m);
+    }
+#elif defined(JSON_SIMD_NEON)
+    for (; i + 16 <= len && i + 16 <= room; i += 16) {
+        uint8x16_t v = vld1q_u8((const unsigned char*)str + i);
+        uint8x16_t x = vorrq_u8(
+            vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)), vceqq_u8(v, vdupq_n_u8(0x7F))),
+            vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+        json_mask m = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(x), 4)), 0);
+        vst1q_u8((unsigned char*)dst + i, v);
+        if (m) return i + (json_ctz(m) >> 2);
+    }
+#else
+    for (; i + 8 <= len && i + 8 <= room; i += 8) {
+        const json_mask ones = JSON_U64(0x01010101, 0x01010101);
+        const json_mask high = JSON_U64(0x80808080, 0x80808080);
+        json_mask v = json_load8(str + i);
+        json_mask q = v ^ JSON_U64(0x22222222, 0x22222222);
+        json_mask b = v ^ JSON_U64(0x5C5C5C5C, 0x5C5C5C5C);
+        json_mask d = v ^ JSON_U64(0x7F7F7F7F, 0x7F7F7F7F);
+        json_mask z = (((v - JSON_U64(0x20202020, 0x20202020)) & ~v) |
+            ((q - ones) & ~q) | ((b - ones) & ~b) | ((d - ones) & ~d)) & high;
+        int k = z ? (json_ctz(z) >> 3) : 8, j;
+        for (j = 0; j < k; ++j)
+            dst[i + j] = str[i + j];
+        if (z) return i + k;
+    }
+#endif
+    for (; i < len; ++i) {
+        unsigned char c = (unsigned char)str[i];
+        if (c < 0x20 || c == '"' || c == '\\' || c == 0x7F) break;
+        if (i >= room) continue;
+        dst[i] = str[i];
+    } return i;
+}
+JSON_INTERN int
+json_write_bytes(struct json_writer *w, const char *str, int len)
+{
+    while (len > 0) {
+        int n = w->cap - w->len;
+        if (!n) {
+            if (!w->flush) {
+                w->err = JSON_BUFFER_OVERFLOW;
+                return 0;
+            }
+            if (w->flush(w->usr, w->buf, w->len)) {
+                w->err = JSON_ABORTED;
+                return 0;
+            }
+            w->len = 0;
+            continue;
+        }
+        n = (n < len) ? n : len;
+        len -= n;
+        while (n--)
+            w->buf[w->len++] = *str++;
+    } return 1;
+}
+JSON_INTERN int
+json_write_value(struct json_writer *w)
+{
+    /* separator in front of the next value */
+    char sep = 0;
+    if (w->err) return 0;
+    if (w->depth && w->stk[w->depth-1] == '{' && !w->key) {
+        w->err = JSON_INVAL;
+        return 0;
+    }
+    if (!w->first && !w->key)
+        sep = w->depth ? ',' : '\n';
+    w->first = w->key = 0;
+    return !sep || json_write_bytes(w, &sep, 1);
+}
+JSON_INTERN int
+json_write_escaped(struct json_writer *w, const char *str, int len)
+{
+    /* quoted string with quotes, backslashes, control bytes and DEL escaped.
+     Runs and escapes go straight into the buffer while they fit */
+    static const char hex[] = "0123456789abcdef";
+    if (w->len < w->cap) w->buf[w->len++] = '"';
+    else if (!json_write_bytes(w, "\"", 1)) return 0;
+    while (len > 0) {
+        char esc[6], *out;
+        int n = 2;
+        int room = w->cap - w->len;
+        int run = json_escape_run(w->buf + w->len, room, str, len);
+        int done = (run < room) ? run : room;
+        w->len += done;
+        if (done < run && !json_write_bytes(w, str + done, run - done))
+            return 0;
+        str += run, len -= run;
+        if (!len) break;
+
+        out = (w->cap - w->len >= 6) ? w->buf + w->len : esc;
+        out[0] = '\\';
+        switch (*str) {
+        case '"': out[1] = '"'; break;
+        case '\\': out[1] = '\\'; break;
+        case '\b': out[1] = 'b'; break;
+        case '\f': out[1] = 'f'; break;
+        case '\n': out[1] = 'n'; break;
+        case '\r': out[1] = 'r'; break;
+        case '\t': out[1] = 't'; break;
+        default:
+            out[1] = 'u', out[2] = '0', out[3] = '0';
+            out[4] = hex[(*str >> 4) & 0xF];
+            out[5] = hex[*str & 0xF];
+            n = 6;
+            break;
+        }
+        if (out != esc) w->len += n;
+        else if (!json_write_bytes(w, esc, n))
+            return 0;
+        str++, len--;
+    }
+    if (w->len < w->cap) w->buf[w->len++] = '"';
+    else return json_write_bytes(w, "\"", 1);
+    return 1;
+}
+JSON_API void
+json_write_begin(struct json_writer *w, char *buf, int cap,
+    json_write_callback flush, void *usr)
+{
+    JSON_ASSERT(w);
+    JSON_ASSERT(buf);
+    if (!w) return;
+    w->err = (buf && cap > 0) ? JSON_OK : JSON_INVAL;
+    w->buf = buf;
+    w->len = 0;
+    w->cap = (cap > 0) ? cap : 0;
+    w->flush = flush;
+    w->usr = usr;
+    w->depth = w->key = 0;
+    w->first = 1;
+}
+JSON_API int
+json_write_end(struct json_writer *w)
+{
+    /* hands the rest of the output to the flush callback */
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (w->err) return w->err;
+    if (w->depth || w->key)
+        return (w->err = JSON_INVAL);
+    if (w->flush && w->len) {
+        if (w->flush(w->usr, w->buf, w->len))
+            return (w->err = JSON_ABORTED);
+        w->len = 0;
+    } return JSON_OK;
+}
+JSON_INTERN int
+json_write_open(struct json_writer *w, char c)
+{
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (!json_write_value(w)) return w->err;
+    if (w->depth >= JSON_MAX_DEPTH)
+        return (w->err = JSON_STACK_OVERFLOW);
+    if (!json_write_bytes(w, &c, 1))
+        return w->err;
+    w->stk[w->depth++] = c;
+    w->first = 1;
+    return JSON_OK;
+}
+JSON_API int
+json_write_object(struct json_writer *w)
+{
+    return json_write_open(w, '{');
+}
+JSON_API int
+json_write_array(struct json_writer *w)
+{
+    return json_write_open(w, '[');
+}
+JSON_API int
+json_write_close(struct json_writer *w)
+{
+    char c;
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (w->err) return w->err;
+    if (!w->depth || w->key)
+        return (w->err = JSON_INVAL);
+    c = (w->stk[--w->depth] == '{') ? '}' : ']';
+    w->first = 0;
+    json_write_bytes(w, &c, 1);
+    return w->err;
+}
+JSON_API int
+json_write_key(struct json_writer *w, const char *key, int len)
+{
+    JSON_ASSERT(w);
+    JSON_ASSERT(key);
+    if (!w || !key) return JSON_INVAL;
+    if (w->err) return w->err;
+    if (!w->depth || w->stk[w->depth-1] != '{' || w->key)
+        return (w->err = JSON_INVAL);
+    if (!w->first && !json_write_bytes(w, ",", 1))
+        return w->err;
+    if (json_write_escaped(w, key, len) && json_write_bytes(w, ":", 1))
+        w->key = 1;
+    return w->err;
+}
+JSON_API int
+json_write_string(struct json_writer *w, const char *str, int len)
+{
+    JSON_ASSERT(w);
+    JSON_ASSERT(str || !len);
+    if (!w) return JSON_INVAL;
+    if (json_write_value(w))
+        json_write_escaped(w, str, len);
+    return w->err;
+}
+JSON_API int
+json_write_int(struct json_writer *w, json_int v)
+{
+    char buf[24];
+    int n = 0;
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (v < 0) buf[n++] = '-';
+    n += json_format_uint(buf + n, (v < 0) ? (json_uint)0 - (json_uint)v : (json_uint)v);
+    if (json_write_value(w))
+        json_write_bytes(w, buf, n);
+    return w->err;
+}
+JSON_API int
+json_write_number(struct json_writer *w, json_number v)
+{
+    /* JSON has no infinity or NaN, they are written as null */
+    char buf[32];
+    int n;
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (v != v || v - v != 0)
+        return json_write_null(w);
+    n = json_format_double(buf, v);
+    if (json_write_value(w))
+        json_write_bytes(w, buf, n);
+    return w->err;
+}
+JSON_API int
+json_write_bool(struct json_writer *w, int v)
+{
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (json_write_value(w))
+        json_write_bytes(w, v ? "true" : "false", v ? 4 : 5);
+    return w->err;
+}
+JSON_API int
+json_write_null(struct json_writer *w)
+{
+    JSON_ASSERT(w);
+    if (!w) return JSON_INVAL;
+    if (json_write_value(w))
+        json_write_bytes(w, "null", 4);
+    return w->err;
+}
+JSON_API int
+json_write_token(struct json_writer *w, const struct json_token *tok)
+{
+    /* string tokens are stored without quotes but with their escapes, so
+     only the quotes are added back. Inside objects a string token in key
+     position is written as key */
+    JSON_ASSERT(w);
+    JSON_ASSERT(tok);
+    if (!w || !tok || !tok->str || tok->type == JSON_NONE)
+        return w ? (w->err = JSON_INVAL) : JSON_INVAL;
+    if (w->err) return w->err;
+    if (tok->type == JSON_STRING && w->depth && w->stk[w->depth-1] == '{' && !w->key) {
+        if (!w->first && !json_write_bytes(w, ",", 1))
+            return w->err;
+        if (json_write_bytes(w, "\"", 1) && json_write_bytes(w, tok->str, tok->len) &&
+            json_write_bytes(w, "\":", 2))
+            w->key = 1;
+        return w->err;
+    }
+    if (!json_write_value(w)) return w->err;
+    if (tok->type == JSON_STRING) {
+        if (json_write_bytes(w, "\"", 1) && json_write_bytes(w, tok->str, tok->len))
+            json_write_bytes(w, "\"", 1);
+    } else json_write_bytes(w, tok->str, tok->len);
+    return w->err;
+}
+/*--------------------------------------------------------------------------
+                                DECODE
+  -------------------------------------------------------------------------*/
+/* Keys are hashed from their length and first, second and last byte which
+ already tells most field names apart. Only if two names share all of them
+ the whole key is hashed instead. Table size and multiplier are searched
+ until each field has a slot of its own, so a lookup is one probe followed
+ by a single compare. */
+JSON_INTERN unsigned
+json_schema_hash(const char *str, int len, int full)
+{
+    if (full) return json_hash(str, len);
+    if (len <= 0) return 0;
+    return ((unsigned)len & 0xFF) |
+        ((unsigned)(unsigned char)str[0] << 8) |
+        ((unsigned)(unsigned char)str[len > 1] << 16) |
+        ((unsigned)(unsigned char)str[len-1] << 24);
+}
+JSON_INTERN int
+json_schema_slot(unsigned seed, int shift, unsigned h)
+{
+    return (int)(((h * seed) & 0xFFFFFFFFu) >> shift);
+}
+JSON_INTERN int
+json_schema_place(unsigned char *slot, int size, unsigned *seed, int *shift,
+    const unsigned *h, int cnt)
+{
+    /* searches table size and multiplier until every hash has a slot,
+     the table grows up to the largest power of two that fits in `size`.
+     Returns 1 for a perfect table and 2 if it fell back to probing. */
+    int i, bits, tries, max;
+    for (max = 1; (2 << max) <= size; ++max);
+    for (bits = 1; (1 << bits) < cnt * 2; ++bits);
+    for (; bits <= max; ++bits) {
+        *shift = 32 - bits;
+        *seed = 0x9E3779B9u;
+        for (tries = (bits < max) ? 512 : (1 << 16); tries; --tries) {
+            *seed = ((*seed * 1664525u + 1013904223u) & 0xFFFFFFFFu) | 1u;
+            for (i = 0; i < (1 << bits); ++i)
+                slot[i] = 0xFF;
+            for (i = 0; i < cnt; ++i) {
+                int at = json_schema_slot(*seed, *shift, h[i]);
+                if (slot[at] != 0xFF) break;
+                slot[at] = (unsigned char)i;
+            }
+            if (i == cnt) return 1;
+        }
+    }
+    /* hashes are distinct and the table at most half full */
+    for (i = 0; i < (1 << max); ++i)
+        slot[i] = 0xFF;
+    for (i = 0; i < cnt; ++i) {
+        int at = json_schema_slot(*seed, *shift, h[i]);
+        while (slot[at] != 0xFF)
+            at = (at + 1) & ((1 << max) - 1);
+        slot[at] = (unsigned char)i;
+    } return 2;
+}
+JSON_API int
+json_schema_build(struct json_schema *s, const struct json_field *fields, int cnt)
+{
+    int i, j;
+    unsigned *h = s ? s->hash : NULL;
+
+    JSON_ASSERT(s);
+    JSON_ASSERT(fields);
+    if (!s || !fields || cnt <= 0 || cnt > JSON_SCHEMA_MAX_FIELDS)
+        return 0;
+    s->fields = fields;
+    s->cnt = cnt;
+    s->full = 0;
+    s->dict = NULL;
+    for (i = 0; i < cnt; ++i) {
+        const struct json_field *f = &fields[i];
+        int n = 0;
+        if (!f->name || f->offset < 0) return 0;
+        if (f->type == JSON_FIELD_OBJECT && !f->sub) return 0;
+        if (f->type == JSON_FIELD_STRING && f->size <= 0) return 0;
+        while (n < 256 && f->name[n]) n++;
+        if (n > 255) return 0;
+        s->len[i] = (unsigned char)n;
+    }
+    /* names sharing the cheap hash are either duplicates or need the full one */
+    for (i = 0; i < cnt; ++i) {
+        h[i] = json_schema_hash(fields[i].name, s->len[i], 0);
+        for (j = 0; j < i; ++j) {
+            if (h[i] != h[j]) continue;
+            if (json_memeq(fields[i].name, fields[j].name, s->len[i]))
+                return 0;
+            s->full = 1;
+        }
+    }
+    if (s->full) {
+        for (i = 0; i < cnt; ++i) {
+            h[i] = json_schema_hash(fields[i].name, s->len[i], 1);
+            for (j = 0; j < i; ++j)
+                if (h[i] == h[j]) return 0;
+        }
+    }
+    s->probe = json_schema_place(s->slot, (int)sizeof(s->slot), &s->seed, &s->shift, h, cnt) > 1;
+    return 1;
+}
+JSON_INTERN const struct json_field*
+json_schema_find(const struct json_schema *s, const struct json_token *key)
+{
+    /* the cheap hash holds all bytes of names up to three bytes long */
+    unsigned h = json_schema_hash(key->str, key->len, s->full);
+    int at = json_schema_slot(s->seed, s->shift, h);
+    int i = s->slot[at];
+    while (s->probe && i != 0xFF && s->hash[i] != h)
+        i = s->slot[at = (at + 1) & ((1 << (32 - s->shift)) - 1)];
+    if (i == 0xFF || s->hash[i] != h || s->len[i] != key->len) return NULL;
+    if ((s->full || key->len > 3) && !json_memeq(key->str, s->fields[i].name, key->len))
+        return NULL;
+    return &s->fields[i];
+}
+JSON_INTERN int
+json_decode_field(char *dst, const struct json_field *f, const struct json_token *v)
+{
+    /* returns 1 if the member was set, 0 for null and -1 on mismatch */
+    json_int i;
+    json_uint u;
+    json_number n;
+
+    dst += f->offset;
+    if (v->type == JSON_NULL && f->type != JSON_FIELD_TOKEN)
+        return 0;
+    switch (f->type) {
+    case JSON_FIELD_INT:
+        if (v->type != JSON_NUMBER || !json_convert_i64(&i, v)) return -1;
+        *(json_int*)(void*)dst = i; break;
+    case JSON_FIELD_UINT:
+        if (v->type != JSON_NUMBER || !json_convert_u64(&u, v)) return -1;
+        *(json_uint*)(void*)dst = u; break;
+    case JSON_FIELD_INT32:
+        if (v->type != JSON_NUMBER || !json_convert_i64(&i, v)) return -1;
+        if (i < -2147483647 - 1 || i > 2147483647) return -1;
+        *(int*)(void*)dst = (int)i; break;
+    case JSON_FIELD_NUMBER:
+        if (v->type != JSON_NUMBER || !json_convert(&n, v)) return -1;
+        *(json_number*)(void*)dst = n; break;
+    case JSON_FIELD_FLOAT:
+        if (v->type != JSON_NUMBER || !json_convert(&n, v)) return -1;
+        *(float*)(void*)dst = (float)n; break;
+    case JSON_FIELD_BOOL:
+        if (v->type != JSON_TRUE && v->type != JSON_FALSE) return -1;
+        *(int*)(void*)dst = (v->type == JSON_TRUE); break;
+    case JSON_FIELD_STRING: {
+        /* short values without escapes are copied directly */
+        int k = 0;
+        if (v->type != JSON_STRING) return -1;
+        if (v->len < f->size && v->len <= 32)
+            for (; k < v->len && v->str[k] != '\\'; ++k)
+                dst[k] = v->str[k];
+        if (k == v->len && k < f->size) dst[k] = '\0';
+        else if (json_unescape(dst, f->size, v) < 0) return -1;
+    } break;
+    case JSON_FIELD_TOKEN:
+        *(struct json_token*)(void*)dst = *v; break;
+    case JSON_FIELD_OBJECT:
+        if (v->type != JSON_OBJECT || json_decode_struct(dst, f->sub, v, v->sub + 1) < 0)
+            return -1;
+        break;
+    default: return -1;
+    } return 1;
+}
+JSON_API int
+json_decode_struct(void *dst, const struct json_schema *s,
+    const struct json_token *toks, int count)
+{
+    /* decodes the pairs of an object token, or the root pairs as passed to
+     `json_query`, in one pass. Unknown keys and null values are skipped.
+     Returns the number of members set or -1 if a value does not fit its
+     field, members decoded up to that point keep their values */
+    const struct json_token *k, *end;
+    int n = 0;
+
+    JSON_ASSERT(dst);
+    JSON_ASSERT(s);
+    if (!dst || !s || count < 0 || (count && !toks))
+        return -1;
+    if (!count) return 0;
+    end = toks + count;
+    if (toks->type == JSON_OBJECT) {
+        end = toks + 1 + toks->sub;
+        toks++;
+    }
+    for (k = toks; k + 1 < end;) {
+        const struct json_token *v = k + 1;
+        const struct json_field *f;
+        if (k->type != JSON_STRING) return -1;
+        if ((f = json_schema_find(s, k)) != NULL) {
+            int r = json_decode_field((char*)dst, f, v);
+            if (r < 0) return -1;
+            n += r;
+        }
+        k = v + 1;
+        if (v->type == JSON_OBJECT || v->type == JSON_ARRAY)
+            k += v->sub;
+    } return n;
+}
+/*--------------------------------------------------------------------------
+                                COLUMNS
+  -------------------------------------------------------------------------*/
+/* Elements of an array of objects usually share their key order, so each
+ key is looked up at the pair index it had in the previous element first.
+ Getting there only steps over pairs, which leaves one compare per key
+ and element. Keys at another position fall back to a full search that
+ also updates the prediction. */
+JSON_INTERN const struct json_token*
+json_column_find(const struct json_token *obj, const char *key, int len, int *hint)
+{
+    int i;
+    const struct json_token *k = obj + 1;
+    if (*hint < obj->children) {
+        for (i = 0; i < *hint; ++i)
+            k += k[1].sub + 2;
+        if (k->len == len && json_memeq(k->str, key, len))
+            return k + 1;
+    }
+    for (i = 0, k = obj + 1; i < obj->children; ++i, k += k[1].sub + 2) {
+        if (k->len == len && json_memeq(k->str, key, len)) {
+            *hint = i;
+            return k + 1;
+        }
+    } return NULL;
+}
+JSON_INTERN int
+json_column_parse(struct json_column *col)
+{
+    const char *p = col->path;
+    col->depth = 0;
+    col->found = 0;
+    if (!p || !*p) return 0;
+    while (1) {
+        const char *s = p;
+        while (*p && *p != JSON_DELIMITER) p++;
+        if (p == s || col->depth >= JSON_COLUMN_MAX_DEPTH)
+            return 0;
+        col->key[col->depth] = s;
+        col->len[col->depth] = (int)(p - s);
+        col->hint[col->depth++] = 0;
+        if (!*p++) return 1;
+    }
+}
+JSON_API int
+json_columns(struct json_column *cols, int cnt, const struct json_token *array)
+{
+    /* fills the output of each column for every element of the array in
+     one pass. Returns the number of elements or -1 for invalid paths or
+     if the token is not an array */
+    int i, c;
+    const struct json_token *e;
+
+    JSON_ASSERT(cols || !cnt);
+    JSON_ASSERT(array);
+    if ((!cols && cnt) || cnt < 0 || !array || array->type != JSON_ARRAY)
+        return -1;
+    for (c = 0; c < cnt; ++c) {
+        if (!cols[c].out || !json_column_parse(&cols[c]))
+            return -1;
+    }
+    e = array + 1;
+    for (i = 0; i < array->children; ++i, e += e->sub + 1) {
+        if (e->type != JSON_OBJECT) continue;
+        for (c = 0; c < cnt; ++c) {
+            struct json_column *col = &cols[c];
+            const struct json_token *v = e;
+            int d;
+            for (d = 0; d < col->depth && v && v->type == JSON_OBJECT; ++d)
+                v = json_column_find(v, col->key[d], col->len[d], &col->hint[d]);
+            if (!v || d < col->depth) continue;
+            switch (col->type) {
+            case JSON_COLUMN_NUMBER:
+                if (v->type == JSON_NUMBER && json_convert((json_number*)col->out + i, v))
+                    col->found++;
+                break;
+            case JSON_COLUMN_INT:
+                if (v->type == JSON_NUMBER && json_convert_i64((json_int*)col->out + i, v))
+                    col->found++;
+                break;
+            case JSON_COLUMN_SPAN:
+                if (v->type == JSON_STRING) {
+                    ((struct json_span*)col->out)[i].str = v->str;
+                    ((struct json_span*)col->out)[i].len = v->len;
+                    col->found++;
+                } break;
+            default: return -1;
+            }
+        }
+    } return array->children;
+}
+
+/*--------------------------------------------------------------------------
+                                IMAGE
+  -------------------------------------------------------------------------*/
+/* An image is a header followed by the document's compact tokens. Tokens
+ only hold offsets so the image can live at any address, e.g. mapped
+ straight from a file. Opening checks the header against the source and
+ walks the tokens once to make sure every offset and skip stays in bounds,
+ which touches far less memory than parsing and never allocates. */
+JSON_INTERN unsigned
+json_image_sum(const char *src, int len)
+{
+    /* four interleaved multiplicative lanes over 16 byte blocks */
+    const unsigned char *s = (const unsigned char*)src;
+    unsigned h[4], w;
+    int i = 0, j;
+
+    h[0] = 0x811C9DC5u ^ (unsigned)len;
+    h[1] = 0x9E3779B9u; h[2] = 0x85EBCA6Bu; h[3] = 0xC2B2AE35u;
+    for (; i + 16 <= len; i += 16) {
+        for (j = 0; j < 4; ++j) {
+            const unsigned char *b = s + i + j * 4;
+            w = (unsigned)b[0] | (unsigned)b[1] << 8 |
+                (unsigned)b[2] << 16 | (unsigned)b[3] << 24;
+            h[j] = ((h[j] ^ w) * 0x9E3779B1u) & 0xFFFFFFFFu;
+            h[j] ^= h[j] >> 15;
+        }
+    }
+    for (; i < len; ++i)
+        h[0] = ((h[0] ^ s[i]) * 0x01000193u) & 0xFFFFFFFFu;
+    for (j = 1; j < 4; ++j) {
+        h[0] = ((h[0] ^ h[j]) * 0x9E3779B1u) & 0xFFFFFFFFu;
+        h[0] ^= h[0] >> 13;
+    } return h[0];
+}
+JSON_API int
+json_image_write(void *mem, int size, const struct json_token *toks,
+    int count, const char *src, int len)
+{
+    /* returns the number of bytes the image takes or 0 if the tokens do
+     not belong to `src`. Like snprintf the image is only written if `size`
+     is large enough, so a first call with NULL asks for the size */
+    int i, need;
+    struct json_image_header *h;
+    struct json_ctoken *ct;
+
+    JSON_ASSERT(src);
+    if (!src || len <= 0 || count < 0 || (count && !toks))
+        return 0;
+    if (count > (0x7FFFFFFF - (int)sizeof(*h)) / (int)sizeof(*ct))
+        return 0;
+    need = (int)sizeof(*h) + count * (int)sizeof(*ct);
+    for (i = 0; i < count; ++i) {
+        const struct json_token *t = &toks[i];
+        if (t->str < src || t->str - src > len || t->len < 0 ||
+            t->len > len - (int)(t->str - src))
+            return 0;
+    }
+    if (!mem || size < need)
+        return need;
+
+    h = (struct json_image_header*)mem;
+    h->magic = JSON_IMAGE_MAGIC;
+    h->version = JSON_IMAGE_VERSION;
+    h->token_size = (int)sizeof(*ct);
+    h->cnt = count;
+    h->len = len;
+    h->sum = json_image_sum(src, len);
+    ct = (struct json_ctoken*)(void*)(h + 1);
+    for (i = 0; i < count; ++i) {
+        ct[i].off = (int)(toks[i].str - src);
+        ct[i].len = toks[i].len;
+        ct[i].info = (int)toks[i].type | (toks[i].children << 4);
+        ct[i].sub = toks[i].sub;
+    } return need;
+}
+JSON_INTERN int
+json_image_check(const struct json_ctoken *toks, int cnt, int len)
+{
+    /* every token has to stay inside the source and every container has
+     to hold exactly its children within its subtokens */
+    int i, j, k, n, end;
+    for (i = 0; i < cnt; ++i) {
+        const struct json_ctoken *t = &toks[i];
+        int type = t->info & 15;
+        if (t->off < 0 || t->len < 0 || t->off > len - t->len) return 0;
+        if (type <= JSON_NONE || type >= JSON_MAX || t->info < 0) return 0;
+        if (t->sub < 0 || t->sub > cnt - i - 1) return 0;
+        if (type != JSON_OBJECT && type != JSON_ARRAY && (t->sub || t->info >> 4))
+            return 0;
+    }
+    for (i = 0; i < cnt; ++i) {
+        const struct json_ctoken *t = &toks[i];
+        int type = t->info & 15;
+        if (type != JSON_OBJECT && type != JSON_ARRAY)
+            continue;
+        end = i + 1 + t->sub;
+        n = (t->info >> 4) * ((type == JSON_OBJECT) ? 2 : 1);
+        for (j = i + 1, k = 0; k < n && j < end; ++k) {
+            if (type == JSON_OBJECT && !(k & 1) && (toks[j].info & 15) != JSON_STRING)
+                return 0;
+            j += 1 + toks[j].sub;
+        }
+        if (k != n || j != end) return 0;
+    } return 1;
+}
+JSON_API int
+json_image_open(struct json_compact *c, const void *mem, int size,
+    const char *src, int len)
+{
+    /* points `c` at the tokens inside the image, which must be aligned to at
+     least four bytes and stay untouched while in use. Returns 1 if the
+     image matches `src`, otherwise 0 with `c->err` set to JSON_INVAL */
+    const struct json_image_header *h = (const struct json_image_header*)mem;
+    const struct json_ctoken *toks;
+
+    JSON_ASSERT(c);
+    if (!c) return 0;
+    c->err = JSON_INVAL;
+    c->src = src;
+    c->toks = NULL;
+    c->cnt = c->cap = 0;
+    if (!mem || !src || len <= 0 || size < (int)sizeof(*h))
+        return 0;
+    if (h->magic != JSON_IMAGE_MAGIC || h->version != JSON_IMAGE_VERSION ||
+        h->token_size != (int)sizeof(struct json_ctoken) || h->len != len)
+        return 0;
+    if (h->cnt < 0 || h->cnt > (size - (int)sizeof(*h)) / (int)sizeof(struct json_ctoken))
+        return 0;
+    toks = (const struct json_ctoken*)(const void*)(h + 1);
+    if (h->sum != json_image_sum(src, len) || !json_image_check(toks, h->cnt, len))
+        return 0;
+
+    /* the compact queries only read through the token pointer */
+    c->toks = (struct json_ctoken*)toks;
+    c->cnt = c->cap = h->cnt;
+    c->err = JSON_OK;
+    return 1;
+}
+/*--------------------------------------------------------------------------
+                                DICT
+  -------------------------------------------------------------------------*/
+/* Keys are copied into the dictionary so ids outlive the documents they
+ came from. Ids are handed out in order of insertion, which makes them
+ stable if the dictionary is seeded with the same keys up front. A frozen
+ dictionary is only read and can be shared between threads. */
+JSON_INTERN unsigned
+json_dict_hash(const char *str, int len)
+{
+    /* first and last four bytes, which covers keys up to eight in full */
+    const unsigned char *s = (const unsigned char*)str;
+    unsigned a = 0, b = 0, h;
+    int i;
+    if (len >= 4) {
+        a = (unsigned)s[0] | (unsigned)s[1] << 8 |
+            (unsigned)s[2] << 16 | (unsigned)s[3] << 24;
+        s += len - 4;
+        b = (unsigned)s[0] | (unsigned)s[1] << 8 |
+            (unsigned)s[2] << 16 | (unsigned)s[3] << 24;
+    } else for (i = 0; i < len; ++i)
+        a |= (unsigned)s[i] << (i * 8);
+    h = ((a ^ (unsigned)len) * 0x9E3779B1u) & 0xFFFFFFFFu;
+    h = ((h ^ (h >> 15) ^ b) * 0x85EBCA6Bu) & 0xFFFFFFFFu;
+    return (h ^ (h >> 13)) & 0x7FFFFFFFu;
+}
+JSON_INTERN int
+json_dict_slot(const struct json_dict *d, const char *key, int len, int h)
+{
+    /* returns the slot holding the key or the empty slot it belongs into */
+    int i = h & d->mask;
+    while (d->slots[i] >= 0) {
+        const int *k = d->keys + d->slots[i] * 3;
+        if (k[0] == h && k[2] == len && json_memeq(d->text + k[1], key, len))
+            break;
+        i = (i + 1) & d->mask;
+    } return i;
+}
+JSON_INTERN int
+json_dict_table(int keys)
+{
+    int n = 2;
+    while (n < keys * 2) n <<= 1;
+    return n;
+}
+JSON_API int
+json_dict_size(int keys, int text)
+{
+    /* number of ints required for up to `keys` keys of `text` bytes total */
+    if (keys <= 0 || text < 0 || keys > (1 << 24)) return 0;
+    return json_dict_table(keys) + keys * 3 + (text + 3) / 4;
+}
+JSON_API int
+json_dict_init(struct json_dict *d, int *mem, int size, int keys, int text)
+{
+    int i, n;
+    JSON_ASSERT(d);
+    JSON_ASSERT(mem);
+    if (!d || !mem || !(n = json_dict_size(keys, text)) || size < n)
+        return 0;
+    d->cnt = 0;
+    d->max = keys;
+    d->used = 0;
+    d->space = text;
+    d->frozen = 0;
+    d->mask = json_dict_table(keys) - 1;
+    d->slots = mem;
+    d->keys = mem + d->mask + 1;
+    d->text = (char*)(void*)(d->keys + keys * 3);
+    for (i = 0; i <= d->mask; ++i)
+        d->slots[i] = -1;
+    return 1;
+}
+JSON_API int
+json_dict_add(struct json_dict *d, const char *key, int len)
+{
+    /* returns the id of the key, added if new, or -1 if the dictionary is
+     frozen or full */
+    int i, j, h, *k;
+    JSON_ASSERT(d);
+    if (!d || !d->slots || (!key && len) || len < 0)
+        return -1;
+    h = (int)json_dict_hash(key, len);
+    i = json_dict_slot(d, key, len, h);
+    if (d->slots[i] >= 0) return d->slots[i];
+    if (d->frozen || d->cnt >= d->max || len > d->space - d->used)
+        return -1;
+    k = d->keys + d->cnt * 3;
+    k[0] = h; k[1] = d->used; k[2] = len;
+    for (j = 0; j < len; ++j)
+        d->text[d->used + j] = key[j];
+    d->used += len;
+    d->slots[i] = d->cnt;
+    return d->cnt++;
+}
+JSON_API int
+json_dict_find(const struct json_dict *d, const char *key, int len)
+{
+    JSON_ASSERT(d);
+    if (!d || !d->slots || (!key && len) || len < 0)
+        return -1;
+    return d->slots[json_dict_slot(d, key, len, (int)json_dict_hash(key, len))];
+}
+JSON_API const char*
+json_dict_key(const struct json_dict *d, int id, int *len)
+{
+    JSON_ASSERT(d);
+    if (!d || id < 0 || id >= d->cnt) return NULL;
+    if (len) *len = d->keys[id * 3 + 2];
+    return d->text + d->keys[id * 3 + 1];
+}
+JSON_API int
+json_intern(struct json_dict *d, int *ids, const struct json_token *toks, int count,
+    int root)
+{
+    /* fills `ids` with the id of every key token in all objects, -1 for
+     everything else. Tokens of an object and an array root look the same,
+     so `root` tells if `toks` are the pairs of a root object. Returns the
+     number of keys left without id or -1 for invalid arguments */
+    int i, k, n, missing = 0;
+    JSON_ASSERT(d);
+    JSON_ASSERT(ids);
+    if (!d || !ids || count < 0 || (count && !toks))
+        return -1;
+    for (i = 0; i < count; ++i)
+        ids[i] = -1;
+    if (root) {
+        for (k = 0; k + 1 < count && toks[k].type == JSON_STRING; k += 2 + toks[k+1].sub)
+            if ((ids[k] = json_dict_add(d, toks[k].str, toks[k].len)) < 0)
+                missing++;
+    }
+    for (i = 0; i < count; ++i) {
+        if (toks[i].type != JSON_OBJECT) continue;
+        for (k = i + 1, n = 0; n < toks[i].children; ++n, k += 2 + toks[k+1].sub)
+            if ((ids[k] = json_dict_add(d, toks[k].str, toks[k].len)) < 0)
+                missing++;
+    } return missing;
+}
+JSON_API struct json_token*
+json_find_id(struct json_token *toks, const int *ids, int count, int id)
+{
+    /* value of the key with `id` inside an object token or the root pairs,
+     `ids` being the entry of `toks` in the id array */
+    struct json_token *end;
+    int k = 0;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(ids);
+    if (!toks || !ids || count <= 0 || id < 0)
+        return NULL;
+    end = toks + count;
+    if (toks->type == JSON_OBJECT) {
+        end = toks + 1 + toks->sub;
+        k = 1;
+    }
+    while (toks + k + 1 < end) {
+        if (ids[k] == id) return toks + k + 1;
+        k += 2 + toks[k+1].sub;
+    } return NULL;
+}
+JSON_API int
+json_schema_bind(struct json_schema *s, struct json_dict *d)
+{
+    /* adds the field names to the dictionary and prepares dispatch by id
+     for json_decode_ids, decoding by name keeps working */
+    int i;
+    unsigned h[JSON_SCHEMA_MAX_FIELDS];
+    JSON_ASSERT(s);
+    JSON_ASSERT(d);
+    if (!s || !d || !s->fields || s->cnt <= 0)
+        return 0;
+    s->dict = NULL;
+    for (i = 0; i < s->cnt; ++i) {
+        if ((s->id[i] = json_dict_add(d, s->fields[i].name, s->len[i])) < 0)
+            return 0;
+        h[i] = (unsigned)s->id[i];
+    }
+    s->idprobe = json_schema_place(s->idslot, (int)sizeof(s->idslot), &s->idseed, &s->idshift, h, s->cnt) > 1;
+    s->dict = d;
+    return 1;
+}
+JSON_API int
+json_decode_ids(void *dst, const struct json_schema *s,
+    const struct json_token *toks, const int *ids, int count)
+{
+    /* json_decode_struct dispatching on key ids from json_intern with a
+     dictionary the schema is bound to. Nested objects whose schema is
+     bound to the same dictionary are decoded by id as well */
+    const struct json_token *end;
+    int k = 0, n = 0;
+
+    JSON_ASSERT(dst);
+    JSON_ASSERT(s);
+    if (!dst || !s || !s->dict || !ids || count < 0 || (count && !toks))
+        return -1;
+    if (!count) return 0;
+    end = toks + count;
+    if (toks->type == JSON_OBJECT) {
+        end = toks + 1 + toks->sub;
+        k = 1;
+    }
+    while (toks + k + 1 < end) {
+        const struct json_token *v = toks + k + 1;
+        const struct json_field *f;
+        int at, i, r, id = ids[k];
+        if (toks[k].type != JSON_STRING) return -1;
+        k += 2 + v->sub;
+        if (id < 0) continue;
+        at = json_schema_slot(s->idseed, s->idshift, (unsigned)id);
+        i = s->idslot[at];
+        while (s->idprobe && i != 0xFF && s->id[i] != id)
+            i = s->idslot[at = (at + 1) & ((1 << (32 - s->idshift)) - 1)];
+        if (i == 0xFF || s->id[i] != id) continue;
+        f = &s->fields[i];
+        if (f->type == JSON_FIELD_OBJECT && v->type == JSON_OBJECT && f->sub->dict == s->dict)
+            r = (json_decode_ids((char*)dst + f->offset, f->sub, v, ids + (v - toks), v->sub + 1) < 0) ? -1 : 1;
+        else r = json_decode_field((char*)dst, f, v);
+        if (r < 0) return -1;
+        n += r;
+    } return n;
+}
+/*--------------------------------------------------------------------------
+                                SELECT
+  -------------------------------------------------------------------------*/
+/* Selection runs as one walk over the tokens. Each child is tested against
+ the set of steps active in its parent, kept as a bit mask: a match on the
+ last step emits the child, other matches activate the following step
+ for its children and `..` steps stay active all the way down. Children
+ without any active step are skipped as a whole using `sub`. */
+struct json_selector {
+    const struct json_select *sel;
+    json_select_callback cb;
+    void *usr;
+    int found;
+    int stop;
+};
+JSON_INTERN const char*
+json_select_filter(struct json_select_step *s, const char *q)
+{
+    /* parses `key op value` up to the closing bracket */
+    const char *lit;
+    s->type = JSON_STEP_FILTER;
+    if (*q == '@') q++;
+    else {
+        s->key = q;
+        while (*q && *q != ']' && *q != '=' && *q != '!' && *q != '<' && *q != '>')
+            q++;
+        s->len = (int)(q - s->key);
+        if (!s->len) return NULL;
+    }
+    if (*q == ']') return q;
+    if (q[0] == '=' && q[1] == '=') s->op = JSON_OP_EQ;
+    else if (q[0] == '!' && q[1] == '=') s->op = JSON_OP_NE;
+    else if (q[0] == '<' && q[1] == '=') s->op = JSON_OP_LE;
+    else if (q[0] == '>' && q[1] == '=') s->op = JSON_OP_GE;
+    else if (q[0] == '<') s->op = JSON_OP_LT;
+    else if (q[0] == '>') s->op = JSON_OP_GT;
+    else return NULL;
+    q += (s->op == JSON_OP_LT || s->op == JSON_OP_GT) ? 1 : 2;
+
+    /* literal: string with escapes kept as written, number or constant */
+    if (*q == '\"') {
+        lit = ++q;
+        while (*q && *q != '\"')
+            q += (*q == '\\' && q[1]) ? 2 : 1;
+        if (*q != '\"') return NULL;
+        s->value.type = JSON_STRING;
+        s->value.str = lit;
+        s->value.len = (int)(q++ - lit);
+        return q;
+    }
+    for (lit = q; *q && *q != ']'; ++q);
+    s->value.str = lit;
+    s->value.len = (int)(q - lit);
+    if (s->value.len == 4 && json_memeq(lit, "true", 4))
+        s->value.type = JSON_TRUE;
+    else if (s->value.len == 5 && json_memeq(lit, "false", 5))
+        s->value.type = JSON_FALSE;
+    else if (s->value.len == 4 && json_memeq(lit, "null", 4))
+        s->value.type = JSON_NULL;
+    else if (json_convert(&s->num, &s->value) == JSON_NUMBER)
+        s->value.type = JSON_NUMBER;
+    else return NULL;
+    return q;
+}
+JSON_API int
+json_select_compile(struct json_select *sel, const char *query)
+{
+    const char *q = query;
+    int deep = 0;
+    JSON_ASSERT(sel);
+    JSON_ASSERT(query);
+    if (!sel || !query) return 0;
+    sel->cnt = 0;
+    if (q[0] == JSON_DELIMITER && q[1] == JSON_DELIMITER) {
+        deep = 1;
+        q += 2;
+    }
+    while (*q) {
+        struct json_select_step *s;
+        if (sel->cnt >= JSON_PATH_MAX || sel->cnt >= 64)
+            return 0;
+        s = &sel->step[sel->cnt++];
+        s->deep = deep;
+        s->key = NULL;
+        s->len = 0;
+        s->index = -1;
+        s->op = JSON_OP_EXISTS;
+        s->value = JSON_TOKEN_NULL;
+        s->num = 0;
+        if (*q == '[') {
+            if (*++q == '*') {
+                s->type = JSON_STEP_ANY;
+                q++;
+            } else if (*q == '?') {
+                if (!(q = json_select_filter(s, q + 1)))
+                    return 0;
+            } else {
+                s->type = JSON_STEP_INDEX;
+                if (!(q = json_path_parse_index(q, &s->index)))
+                    return 0;
+            }
+            if (*q++ != ']') return 0;
+        } else if (*q == '*') {
+            s->type = JSON_STEP_ANY;
+            q++;
+        } else {
+            s->type = JSON_STEP_KEY;
+            s->key = q;
+            while (*q && *q != JSON_DELIMITER && *q != '[')
+                q++;
+            s->len = (int)(q - s->key);
+            if (!s->len) return 0;
+        }
+        /* a single delimiter goes one level down, two any number of levels */
+        deep = 0;
+        if (*q == JSON_DELIMITER) {
+            if (*++q == JSON_DELIMITER) {
+                deep = 1;
+                q++;
+            }
+            if (!*q || *q == JSON_DELIMITER) return 0;
+        } else if (*q && *q != '[') return 0;
+    } return sel->cnt != 0;
+}
+JSON_INTERN int
+json_select_test(const struct json_select_step *s, const struct json_token *tok)
+{
+    const struct json_token *v = tok;
+    json_number n;
+    int eq;
+    if (s->key) {
+        /* member of an object child */
+        const struct json_token *it, *end;
+        if (tok->type != JSON_OBJECT) return 0;
+        end = tok + 1 + tok->sub;
+        for (it = tok + 1; it + 1 < end; it += 2 + it[1].sub)
+            if (it->len == s->len && json_memeq(it->str, s->key, s->len)) break;
+        if (it + 1 >= end) return 0;
+        v = it + 1;
+    }
+    switch (s->op) {
+    case JSON_OP_EXISTS: return 1;
+    case JSON_OP_EQ: case JSON_OP_NE:
+        if (s->value.type == JSON_NUMBER && v->type == JSON_NUMBER)
+            eq = (json_convert(&n, v) == JSON_NUMBER && n == s->num);
+        else eq = v->type == s->value.type && (v->type != JSON_STRING ||
+            (v->len == s->value.len && json_memeq(v->str, s->value.str, v->len)));
+        return (s->op == JSON_OP_EQ) ? eq : !eq;
+    default:
+        /* ranges only compare numbers */
+        if (s->value.type != JSON_NUMBER || v->type != JSON_NUMBER ||
+            json_convert(&n, v) != JSON_NUMBER) return 0;
+        switch (s->op) {
+        case JSON_OP_LT: return n < s->num;
+        case JSON_OP_LE: return n <= s->num;
+        case JSON_OP_GT: return n > s->num;
+        default: return n >= s->num;
+        }
+    }
+}
+JSON_INTERN void
+json_select_scope(struct json_selector *x, struct json_token *tok,
+    const struct json_token *end, int object, json_mask active)
+{
+    int n = 0;
+    while (tok < end && !x->stop) {
+        const struct json_token *key = object ? tok : NULL;
+        struct json_token *val = object ? tok + 1 : tok;
+        json_mask next = 0, m;
+        int hit = 0;
+        if (val >= end) break;
+        for (m = active; m; m &= m - 1) {
+            int i = json_ctz(m), match = 0;
+            const struct json_select_step *s = &x->sel->step[i];
+            switch (s->type) {
+            case JSON_STEP_KEY:
+                match = key && key->len == s->len && json_memeq(key->str, s->key, s->len);
+                break;
+            case JSON_STEP_ANY: match = 1; break;
+            case JSON_STEP_INDEX: match = !key && n == s->index; break;
+            case JSON_STEP_FILTER: match = json_select_test(s, val); break;
+            }
+            if (s->deep) next |= m & (~m + 1);
+            if (!match) continue;
+            if (i + 1 == x->sel->cnt) hit = 1;
+            else next |= (m & (~m + 1)) << 1;
+            /* like in `json_query` the first key or index match decides */
+            if (!s->deep && (s->type == JSON_STEP_KEY || s->type == JSON_STEP_INDEX))
+                active &= ~(m & (~m + 1));
+        }
+        if (hit) {
+            x->found++;
+            if (x->cb && x->cb(x->usr, val))
+                x->stop = 1;
+        }
+        if (next && (val->type == JSON_OBJECT || val->type == JSON_ARRAY))
+            json_select_scope(x, val + 1, val + 1 + val->sub, val->type == JSON_OBJECT, next);
+        if (!active) break;
+        tok = val + 1 + val->sub;
+        n++;
+    }
+}
+JSON_API int
+json_select(struct json_token *toks, int count, const struct json_select *sel,
+    json_select_callback cb, void *usr)
+{
+    /* walks the root pairs as passed to `json_query` and passes every match
+     to `cb` (may be null to count only). A nonzero return from `cb` stops
+     the walk. Returns the number of matches */
+    struct json_selector x;
+    JSON_ASSERT(toks);
+    JSON_ASSERT(sel);
+    if (!toks || count <= 0 || !sel || sel->cnt <= 0)
+        return 0;
+    x.sel = sel;
+    x.cb = cb;
+    x.usr = usr;
+    x.found = 0;
+    x.stop = 0;
+    json_select_scope(&x, toks, toks + count, 1, 1);
+    return x.found;
+}
+/*--------------------------------------------------------------------------
+                                VALIDATE
+  -------------------------------------------------------------------------*/
+/* The scanner classifies 64 byte blocks at a time, checks string bodies
+ for control characters, escapes and UTF-8 and hands over structural
+ positions only. Grammar is a table driven automaton over these positions:
+ the state says what may come next, containers push the state to return
+ to once they close. Bare values are checked in place. */
+enum json_valid_state {
+    JSON_VALID_TOP,         /* document value */
+    JSON_VALID_DONE,        /* nothing but whitespace */
+    JSON_VALID_OBJ,         /* first key or '}' */
+    JSON_VALID_KEY,         /* key after ',' */
+    JSON_VALID_COLON,
+    JSON_VALID_MEMBER,      /* member value */
+    JSON_VALID_OBJ_NEXT,    /* ',' or '}' */
+    JSON_VALID_ARR,         /* first element or ']' */
+    JSON_VALID_ELEM,        /* element after ',' */
+    JSON_VALID_ARR_NEXT,    /* ',' or ']' */
+    JSON_VALID_FAIL,
+    JSON_VALID_POP          /* back to the state below the container */
+};
+enum json_valid_class {
+    JSON_VALID_OPEN_OBJ, JSON_VALID_OPEN_ARR, JSON_VALID_CLOSE_OBJ,
+    JSON_VALID_CLOSE_ARR, JSON_VALID_COLON_SEP, JSON_VALID_COMMA,
+    JSON_VALID_QUOTE, JSON_VALID_SCALAR, JSON_VALID_OTHER, JSON_VALID_CLASSES
+};
+static const unsigned char json_valid_go[JSON_VALID_FAIL][JSON_VALID_CLASSES] = {
+    /*  {   [   }   ]   :   ,   "   v   =      10 fails, 11 pops */
+    {   2,  7, 10, 10, 10, 10,  1,  1, 10}, /* TOP */
+    {  10, 10, 10, 10, 10, 10, 10, 10, 10}, /* DONE */
+    {  10, 10, 11, 10, 10, 10,  4, 10, 10}, /* OBJ */
+    {  10, 10, 10, 10, 10, 10,  4, 10, 10}, /* KEY */
+    {  10, 10, 10, 10,  5, 10, 10, 10, 10}, /* COLON */
+    {   2,  7, 10, 10, 10, 10,  6,  6, 10}, /* MEMBER */
+    {  10, 10, 11, 10, 10,  3, 10, 10, 10}, /* OBJ_NEXT */
+    {   2,  7, 10, 11, 10, 10,  9,  9, 10}, /* ARR */
+    {   2,  7, 10, 10, 10, 10,  9,  9, 10}, /* ELEM */
+    {  10, 10, 10, 11, 10,  8, 10, 10, 10}  /* ARR_NEXT */
+};
+static const unsigned char json_valid_cls[256] = {
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 5, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 4, 7, 7, 8, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 1, 7, 3, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 0, 7, 2, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+
+};
+JSON_INTERN int
+json_valid_scalar(const unsigned char *p, const unsigned char *end)
+{
+    /* literal or number with RFC 8259 grammar, ended by whitespace, an
+     operator, a quote or the end of input */
+    const unsigned char *s = p;
+    if (*p == 't' || *p == 'f' || *p == 'n') {
+        const char *lit = (*p == 't') ? "true" : (*p == 'f') ? "false" : "null";
+        int n = (*p == 'f') ? 5 : 4;
+        if (end - p < n || !json_memeq((const char*)p, lit, n)) return 0;
+        p += n;
+    } else {
+        if (*p == '-') p++;
+        if (p < end && *p == '0') p++;
+        else if (p < end && *p >= '1' && *p <= '9')
+            while (p < end && *p >= '0' && *p <= '9') p++;
+        else return 0;
+        if (p < end && *p == '.') {
+            if (++p >= end || *p < '0' || *p > '9') return 0;
+            while (p < end && *p >= '0' && *p <= '9') p++;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            if (++p < end && (*p == '+' || *p == '-')) p++;
+            if (p >= end || *p < '0' || *p > '9') return 0;
+            while (p < end && *p >= '0' && *p <= '9') p++;
+        }
+    }
+    if (p == s) return 0;
+    if (p == end) return 1;
+    switch (*p) {
+    case ' ': case '\t': case '\n': case '\r':
+    case ',': case ':': case '[': case ']': case '{': case '}': case '"':
+        return 1;
+    default: return 0;
+    }
+}
+JSON_API int
+json_validate(const char *str, int len)
+{
+    /* returns 1 if the `len` bytes hold exactly one RFC 8259 value: strict
+     numbers and literals, no trailing commas, '\0' or bytes outside the
+     value besides whitespace, valid escapes and well formed UTF-8 (no
+     overlong forms or surrogates) and nesting up to JSON_MAX_DEPTH */
+    struct json_scanner s;
+    unsigned char stk[JSON_MAX_DEPTH];
+    const unsigned char *src = (const unsigned char*)str;
+    int base, depth = 0, state = JSON_VALID_TOP;
+    json_mask bits, in, string = 0;
+
+    JSON_ASSERT(str);
+    if (!str || len <= 0)
+        return 0;
+    json_scan_begin(&s, str, len);
+    s.strict = 1;
+    while ((base = json_scan(&s, &bits)) >= 0) {
+        /* only opening quotes start a key or value */
+        in = json_prefix_xor(s.quote) ^ string;
+        string = (json_mask)0 - (in >> 63);
+        bits &= ~(s.quote & ~in);
+        for (; bits; bits &= bits - 1) {
+            int at = base + json_ctz(bits);
+            int cls = json_valid_cls[src[at]];
+            int next = json_valid_go[state][cls];
+            if (next == JSON_VALID_FAIL) return 0;
+            if (cls == JSON_VALID_SCALAR && !json_valid_scalar(src + at, src + s.len))
+                return 0;
+            if (cls <= JSON_VALID_OPEN_ARR) {
+                if (depth >= JSON_MAX_DEPTH) return 0;
+                stk[depth++] = json_valid_go[state][JSON_VALID_SCALAR];
+            } else if (next == JSON_VALID_POP)
+                next = stk[--depth];
+            state = next;
+        }
+    } return !s.err && s.len == len && state == JSON_VALID_DONE;
+}
 #endif
 
@@ -0,0 +1,1656 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+
+#define JSON_IMPLEMENTATION
+#include "../json.h"
+
+/* cycle counter for cycles/byte, only read where the time stamp counter exists */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define bench_cycles() ((unsigned long long)__rdtsc())
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define bench_cycles() ((unsigned long long)__rdtsc())
+#else
+#define bench_cycles() 0ull
+#endif
+
+/* monotonic wall clock in seconds, clock() only as last resort since it
+ counts process time at a coarse resolution */
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+static double
+bench_now(void)
+{
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+}
+#elif defined(CLOCK_MONOTONIC)
+static double
+bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+#else
+static double
+bench_now(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+#endif
+
+/* generated inputs */
+static char*
+gen_flat(int *len, int count)
+{
+    /* large array of small records */
+    int i, n = 0;
+    char *buf = (char*)malloc((size_t)count * 96 + 16);
+    n += sprintf(buf + n, "{\"records\":[");
+    for (i = 0; i < count; ++i) {
+        n += sprintf(buf + n, "%s{\"id\":%d,\"name\":\"item%d\",\"x\":%d.%d,\"on\":%s}",
+            i ? "," : "", i, i, i % 1000, i % 7, (i & 1) ? "true" : "false");
+    }
+    n += sprintf(buf + n, "]}");
+    *len = n;
+    return buf;
+}
+static char*
+gen_nested(int *len, int count, int depth)
+{
+    /* many deeply nested config sections */
+    int i, d, n = 0;
+    char *buf = (char*)malloc((size_t)count * (size_t)depth * 48 + 16);
+    n += sprintf(buf + n, "{");
+    for (i = 0; i < count; ++i) {
+        n += sprintf(buf + n, "%s\"s%d\":", i ? "," : "", i);
+        for (d = 0; d < depth; ++d)
+            n += sprintf(buf + n, "{\"v%d\":[%d,%d],\"c\":", d, i, d);
+        n += sprintf(buf + n, "null");
+        for (d = 0; d < depth; ++d)
+            buf[n++] = '}';
+    }
+    n += sprintf(buf + n, "}");
+    *len = n;
+    return buf;
+}
+
+static char*
+gen_numbers(int *len, int count)
+{
+    /* numeric heavy array: full precision doubles, ids and short decimals */
+    int i, n = 0;
+    unsigned long long r = 88172645463325252ull;
+    char *buf = (char*)malloc((size_t)count * 32 + 16);
+    buf[n++] = '[';
+    for (i = 0; i < count; ++i) {
+        double d;
+        r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+        if (i) buf[n++] = ',';
+        switch (i % 4) {
+        case 0: d = (double)(r >> 11) / 9007199254740992.0;
+            n += sprintf(buf + n, "%.17g", d * 1000.0); break;
+        case 1: n += sprintf(buf + n, "%llu", r >> 20); break;
+        case 2: n += sprintf(buf + n, "%d.%02d", (int)(r % 10000), (int)(r % 100)); break;
+        default: d = (double)(r >> 11) / 9007199254740992.0;
+            n += sprintf(buf + n, "%.6e", d * 1e-12); break;
+        }
+    }
+    buf[n++] = ']';
+    buf[n] = 0;
+    *len = n;
+    return buf;
+}
+
+static char*
+gen_lines(int *len, int count)
+{
+    /* newline delimited log records */
+    int i, n = 0;
+    char *buf = (char*)malloc((size_t)count * 128 + 16);
+    for (i = 0; i < count; ++i) {
+        n += sprintf(buf + n, "{\"ts\":%d,\"level\":\"%s\",\"msg\":\"request %d done\","
+            "\"tags\":[\"a\",\"b%d\"],\"ms\":%d.%d}\n", 1600000000 + i,
+            (i % 3) ? "info" : "warn", i, i % 10, i % 100, i % 7);
+    }
+    buf[n] = 0;
+    *len = n;
+    return buf;
+}
+
+static char*
+gen_strings(int *len, int count)
+{
+    /* string heavy records: long ASCII text, UTF-8 text and escapes */
+    static const char *words[] = {"lorem", "ipsum", "dolor", "sit", "amet",
+        "consectetur", "adipiscing", "elit", "sed", "do", "eiusmod", "tempor"};
+    static const char *names[] = {"caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9\x65",
+        "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe3\x83\x86\xe3\x82\xad\xe3\x82\xb9\xe3\x83\x88",
+        "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xd0\xbc\xd0\xb8\xd1\x80",
+        "emoji \xf0\x9f\x98\x80 and \xf0\x9f\x9a\x80 mixed in"};
+    int i, k, n = 0;
+    char *buf = (char*)malloc((size_t)count * 320 + 16);
+    buf[n++] = '[';
+    for (i = 0; i < count; ++i) {
+        n += sprintf(buf + n, "%s{\"id\":%d,\"text\":\"", i ? "," : "", i);
+        for (k = 0; k < 16; ++k)
+            n += sprintf(buf + n, "%s%s", k ? " " : "", words[(i + k * 7) % 12]);
+        n += sprintf(buf + n, "\",\"name\":\"%s\",\"note\":\"line %d\\nsaid \\\"hi\\\""
+            " \\u00e9t\\u00e9 \\ud83d\\ude00\\t\\\\end\"}", names[i % 4], i);
+    }
+    buf[n++] = ']';
+    buf[n] = 0;
+    *len = n;
+    return buf;
+}
+
+/* number conversion as done before (table walk, digit by digit with json_ipow) */
+static double
+old_stoi(int *neg, const struct json_token *tok)
+{
+    double n = 0;
+    int i, off;
+    if (!tok->str || !tok->len) return 0;
+    off = (tok->str[0] == '-' || tok->str[0] == '+') ? 1 : 0;
+    *neg = (tok->str[0] == '-') ? 1 : 0;
+    for (i = off; i < tok->len; i++)
+        if ((tok->str[i] >= '0') && (tok->str[i] <= '9'))
+            n = (n * 10) + tok->str[i]  - '0';
+    return (*neg) ? -n : n;
+}
+static double
+old_stof(const struct json_token *tok)
+{
+    double n = 0, f = 0.1;
+    int i;
+    if (!tok->str || !tok->len) return 0;
+    for (i = 0; i < tok->len; i++) {
+        if ((tok->str[i] >= '0') && (tok->str[i] <= '9')) {
+            n = n + (tok->str[i] - '0') * f;
+            f *= 0.1;
+        }
+    } return n;
+}
+static double
+convert_old(const struct json_token *tok)
+{
+    int ineg, eneg, len = tok->len;
+    long res = 1, base = 10;
+    unsigned exp;
+    const char *cur;
+    double i, f, e, p;
+    struct json_token nums[3], *write = &nums[0];
+    memset(nums, 0, sizeof(nums));
+    write->str = tok->str;
+    for (cur = tok->str; len; cur++, len--) {
+        switch (json_go_num[*(const unsigned char*)cur]) {
+        case JSON_STATE_NUM_FAILED: return 0;
+        case JSON_STATE_NUM_FLT: case JSON_STATE_NUM_EXP:
+            write->len = (int)(cur - write->str);
+            write = &nums[*cur == '.' ? 1 : 2];
+            write->str = cur + 1; break;
+        case JSON_STATE_NUM_BREAK: len = 1; break;
+        default: break;
+        }
+    } write->len = (int)(cur - write->str);
+    i = old_stoi(&ineg, &nums[0]);
+    f = old_stof(&nums[1]);
+    e = old_stoi(&eneg, &nums[2]);
+    for (exp = (unsigned)(eneg ? -e : e); exp; exp >>= 1, base *= base)
+        if (exp & 1) res *= base;
+    p = (double)res;
+    if (eneg) p = (1 / p);
+    return (i + (ineg ? -f : f)) * p;
+}
+static double
+convert_new(const struct json_token *tok)
+{
+    json_number n = 0;
+    json_convert(&n, tok);
+    return n;
+}
+static double
+convert_strtod(const struct json_token *tok)
+{
+    return strtod(tok->str, NULL);
+}
+static volatile double bench_sink;
+static void
+bench_numbers(const char *buf, int len, const char *name,
+    double (*convert)(const struct json_token*))
+{
+    int i, iter = 0, wrong = 0;
+    double secs = 0, sum = 0;
+    struct json_parser p;
+    memset(&p, 0, sizeof(p));
+    p.cap = json_num(buf, len) + 1;
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+
+    /* round trip exactness against the C library */
+    for (i = 0; i < p.cnt; ++i) {
+        double a = convert(&p.toks[i]), b = strtod(p.toks[i].str, NULL);
+        wrong += memcmp(&a, &b, sizeof(a)) != 0;
+    }
+    while (secs < 0.5) {
+        clock_t begin = clock();
+        for (i = 0; i < p.cnt; ++i)
+            sum += convert(&p.toks[i]);
+        secs += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        iter++;
+    }
+    bench_sink = sum;
+    printf("numbers  %-12s %10d values %9.1f MB/s %8.1f ns/value %d inexact\n", name,
+        p.cnt, ((double)len * iter) / (secs * 1024.0 * 1024.0),
+        (secs * 1e9) / ((double)iter * p.cnt), wrong);
+    free(p.toks);
+}
+
+static char*
+gen_ids(int *len, int count)
+{
+    /* id and timestamp heavy records */
+    int i, n = 0;
+    unsigned long long r = 88172645463325252ull;
+    char *buf = (char*)malloc((size_t)count * 64 + 16);
+    buf[n++] = '[';
+    for (i = 0; i < count; ++i) {
+        r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+        n += sprintf(buf + n, "%s%llu,%llu,%d", i ? "," : "", r >> 1,
+            1600000000000ull + (r % 100000000000ull), (int)(r % 1000));
+    }
+    buf[n++] = ']';
+    buf[n] = 0;
+    *len = n;
+    return buf;
+}
+static json_int
+int_convert(const struct json_token *tok)
+{
+    json_int n = 0;
+    json_convert_i64(&n, tok);
+    return n;
+}
+static json_int
+int_double(const struct json_token *tok)
+{
+    json_number n = 0;
+    json_convert(&n, tok);
+    return (json_int)n;
+}
+static json_int
+int_strtoll(const struct json_token *tok)
+{
+    return strtoll(tok->str, NULL, 10);
+}
+static void
+bench_ints(const char *buf, int len, const char *name,
+    json_int (*convert)(const struct json_token*))
+{
+    int i, iter = 0, wrong = 0;
+    double secs = 0;
+    json_int sum = 0;
+    struct json_parser p;
+    memset(&p, 0, sizeof(p));
+    p.cap = json_num(buf, len) + 1;
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+
+    for (i = 0; i < p.cnt; ++i)
+        wrong += convert(&p.toks[i]) != strtoll(p.toks[i].str, NULL, 10);
+    while (secs < 0.5) {
+        clock_t begin = clock();
+        for (i = 0; i < p.cnt; ++i)
+            sum += convert(&p.toks[i]);
+        secs += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        iter++;
+    }
+    bench_sink = (double)sum;
+    printf("ids      %-12s %10d values %9.1f MB/s %8.1f ns/value %d inexact\n", name,
+        p.cnt, ((double)len * iter) / (secs * 1024.0 * 1024.0),
+        (secs * 1e9) / ((double)iter * p.cnt), wrong);
+    free(p.toks);
+}
+
+static int
+unescape_naive(char *dst, int max, const struct json_token *tok)
+{
+    /* byte at a time decoder as typically written by callers */
+    int i, n = 0;
+    for (i = 0; i < tok->len && n < max - 4; ++i) {
+        char c = tok->str[i];
+        if (c != '\\') {dst[n++] = c; continue;}
+        switch (tok->str[++i]) {
+        case 'n': dst[n++] = '\n'; break;
+        case 't': dst[n++] = '\t'; break;
+        case 'u': {
+            char hex[5];
+            unsigned cp;
+            memcpy(hex, tok->str + i + 1, 4);
+            hex[4] = 0;
+            cp = (unsigned)strtoul(hex, NULL, 16);
+            i += 4;
+            if (cp < 0x80) dst[n++] = (char)cp;
+            else if (cp < 0x800) {
+                dst[n++] = (char)(0xC0 | (cp >> 6));
+                dst[n++] = (char)(0x80 | (cp & 0x3F));
+            } else {
+                dst[n++] = (char)(0xE0 | (cp >> 12));
+                dst[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                dst[n++] = (char)(0x80 | (cp & 0x3F));
+            }
+        } break;
+        default: dst[n++] = tok->str[i]; break;
+        }
+    }
+    dst[n] = 0;
+    return n;
+}
+static void
+bench_unescape(const char *buf, int len, const char *name,
+    int (*unescape)(char*, int, const struct json_token*))
+{
+    int i, iter = 0;
+    long bytes = 0, total = 0;
+    double secs = 0;
+    char out[1024];
+    struct json_parser p;
+    memset(&p, 0, sizeof(p));
+    p.cap = json_num(buf, len) + 1;
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    for (i = 0; i < p.cnt; ++i)
+        if (p.toks[i].type == JSON_STRING) bytes += p.toks[i].len;
+    while (secs < 0.5) {
+        clock_t begin = clock();
+        for (i = 0; i < p.cnt; ++i)
+            if (p.toks[i].type == JSON_STRING)
+                total += unescape(out, sizeof(out), &p.toks[i]);
+        secs += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        iter++;
+    }
+    bench_sink = (double)total;
+    printf("strings  %-12s %10ld bytes  %9.1f MB/s\n", name, bytes,
+        ((double)bytes * iter) / (secs * 1024.0 * 1024.0));
+    free(p.toks);
+}
+
+/* loaders under test */
+static int
+load_old(struct json_parser *p, const char *buf, int len)
+{
+    json_parser_reset(p);
+    json_load(p, buf, len);
+    return p->cnt;
+}
+static int
+load_tape(struct json_parser *p, const char *buf, int len)
+{
+    json_load_tape(p, buf, len);
+    return p->cnt;
+}
+static int
+load_exact(struct json_parser *p, const char *buf, int len)
+{
+    /* counting pass plus load into a right-sized array */
+    struct json_parser q;
+    memset(&q, 0, sizeof(q));
+    while (json_load_exact(&q, buf, len))
+        q.toks = (struct json_token*)malloc((size_t)q.cap * sizeof(struct json_token));
+    free(q.toks);
+    p->err = q.err;
+    return q.cnt;
+}
+static int
+load_grow(struct json_parser *p, const char *buf, int len)
+{
+    /* documented realloc loop starting from an empty parser */
+    struct json_parser q;
+    memset(&q, 0, sizeof(q));
+    while (json_load(&q, buf, len))
+        q.toks = (struct json_token*)realloc(q.toks, (size_t)q.cap * sizeof(struct json_token));
+    free(q.toks);
+    p->err = q.err;
+    return q.cnt;
+}
+static int *bench_idx;
+static int bench_idx_cap;
+static int
+load_index(struct json_parser *p, const char *buf, int len)
+{
+    int n = json_index(bench_idx, bench_idx_cap, buf, len);
+    json_load_index(p, buf, len, bench_idx, n);
+    return p->cnt;
+}
+
+static int
+stream_count(void *usr, enum json_stream_event ev, const struct json_token *tok, int depth)
+{
+    (void)ev; (void)tok; (void)depth;
+    ++*(int*)usr;
+    return 0;
+}
+static int
+load_stream(struct json_parser *p, const char *buf, int len)
+{
+    /* push parser fed in 64KB chunks, tokens are only counted */
+    static struct json_stream s;
+    int i, cnt = 0;
+    json_stream_begin(&s, stream_count, &cnt);
+    for (i = 0; i < len; i += 64 * 1024)
+        json_stream_feed(&s, buf + i, (len - i < 64 * 1024) ? len - i : 64 * 1024);
+    p->err = (enum json_status)json_stream_end(&s);
+    return cnt;
+}
+
+static int
+load_lines(struct json_parser *p, const char *buf, int len)
+{
+    /* sizing pass plus filling pass into one arena */
+    struct json_lines l;
+    memset(&l, 0, sizeof(l));
+    while (json_load_lines(&l, buf, len)) {
+        l.recs = (struct json_record*)realloc(l.recs, (size_t)l.cap * sizeof(struct json_record));
+        l.toks = (struct json_token*)realloc(l.toks, (size_t)l.size * sizeof(struct json_token));
+    }
+    free(l.recs);
+    free(l.toks);
+    p->err = l.err;
+    return l.used;
+}
+static struct json_chunk bench_chunks[16];
+static int
+load_parallel(struct json_parser *p, const char *buf, int len)
+{
+    /* parts run one after another: cost of the two rounds and the merge */
+    json_load_parallel(p, buf, len, bench_chunks, 8, 0, 0);
+    return p->cnt;
+}
+/* build with -DJSON_BENCH_THREADS -lpthread to also load lines and single documents on several threads */
+#ifdef JSON_BENCH_THREADS
+#include <pthread.h>
+#define BENCH_THREADS 4
+struct bench_part {const char *buf; int len; struct json_lines l;};
+static void*
+load_part(void *arg)
+{
+    struct bench_part *part = (struct bench_part*)arg;
+    json_load_lines(&part->l, part->buf, part->len);
+    return NULL;
+}
+static int
+load_lines_mt(struct json_parser *p, const char *buf, int len)
+{
+    /* every thread sizes its part, then fills its slice of the shared arena */
+    int i, recs = 0, toks = 0, cuts[BENCH_THREADS+1];
+    pthread_t th[BENCH_THREADS];
+    struct bench_part parts[BENCH_THREADS];
+    struct json_record *all_recs;
+    struct json_token *all_toks;
+
+    json_lines_split(cuts, BENCH_THREADS, buf, len);
+    memset(parts, 0, sizeof(parts));
+    for (i = 0; i < BENCH_THREADS; ++i) {
+        parts[i].buf = buf + cuts[i];
+        parts[i].len = cuts[i+1] - cuts[i];
+        pthread_create(&th[i], NULL, load_part, &parts[i]);
+    }
+    for (i = 0; i < BENCH_THREADS; ++i) {
+        pthread_join(th[i], NULL);
+        recs += parts[i].l.cap;
+        toks += parts[i].l.size;
+    }
+    all_recs = (struct json_record*)malloc((size_t)recs * sizeof(struct json_record));
+    all_toks = (struct json_token*)malloc((size_t)toks * sizeof(struct json_token));
+    for (recs = toks = i = 0; i < BENCH_THREADS; ++i) {
+        parts[i].l.recs = all_recs + recs;
+        parts[i].l.toks = all_toks + toks;
+        recs += parts[i].l.cap;
+        toks += parts[i].l.size;
+        pthread_create(&th[i], NULL, load_part, &parts[i]);
+    }
+    for (i = 0; i < BENCH_THREADS; ++i)
+        pthread_join(th[i], NULL);
+    free(all_recs);
+    free(all_toks);
+    p->err = JSON_OK;
+    return toks;
+}
+struct bench_pool {json_task task; void *arg; int cnt, at;};
+static void*
+run_strided(void *arg)
+{
+    struct bench_pool *pool = (struct bench_pool*)arg;
+    int i;
+    for (i = pool->at; i < pool->cnt; i += BENCH_THREADS)
+        pool->task(pool->arg, i);
+    return NULL;
+}
+static void
+run_threads(void *usr, json_task task, void *arg, int cnt)
+{
+    int i;
+    pthread_t th[BENCH_THREADS];
+    struct bench_pool pool[BENCH_THREADS];
+    (void)usr;
+    for (i = 0; i < BENCH_THREADS; ++i) {
+        pool[i].task = task;
+        pool[i].arg = arg;
+        pool[i].cnt = cnt;
+        pool[i].at = i;
+        pthread_create(&th[i], NULL, run_strided, &pool[i]);
+    }
+    for (i = 0; i < BENCH_THREADS; ++i)
+        pthread_join(th[i], NULL);
+}
+static int
+load_parallel_mt(struct json_parser *p, const char *buf, int len)
+{
+    json_load_parallel(p, buf, len, bench_chunks, BENCH_THREADS, run_threads, 0);
+    return p->cnt;
+}
+#endif
+
+static int
+load_compact(struct json_parser *p, const char *buf, int len)
+{
+    /* compact tokens into a buffer sized once from the token count */
+    static struct json_compact c;
+    if (c.src != buf) {
+        free(c.toks);
+        memset(&c, 0, sizeof(c));
+        json_load_compact(&c, buf, len);
+        c.toks = (struct json_ctoken*)malloc((size_t)c.cap * sizeof(struct json_ctoken));
+    }
+    json_load_compact(&c, buf, len);
+    p->err = c.err;
+    return c.cnt;
+}
+static void
+bench_query(const char *input, const char *buf, int len, const char *path)
+{
+    /* sibling skips over regular tokens against 16 byte compact tokens */
+    int i, iter;
+    double secs[2];
+    struct json_path q;
+    struct json_parser p;
+    struct json_compact c;
+    const void *found[2] = {0, 0};
+
+    memset(&p, 0, sizeof(p));
+    memset(&c, 0, sizeof(c));
+    json_path_compile(&q, path);
+    p.cap = json_count(buf, len);
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    json_load_compact(&c, buf, len);
+    c.toks = (struct json_ctoken*)malloc((size_t)c.cap * sizeof(struct json_ctoken));
+    json_load_compact(&c, buf, len);
+
+    for (i = 0; i < 2; ++i) {
+        secs[i] = 0;
+        for (iter = 0; secs[i] < 0.25; iter += 16) {
+            int k;
+            clock_t begin = clock();
+            for (k = 0; k < 16; ++k)
+                found[i] = i ? (const void*)json_compact_query_compiled(&c, c.toks, c.cnt, &q) :
+                    (const void*)json_query_compiled(p.toks, p.cnt, &q);
+            secs[i] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        } secs[i] = (secs[i] * 1e6) / iter;
+    }
+    printf("%-8s query %-22s %8.1f us tokens (%d MB) %8.1f us compact (%d MB)%s\n",
+        input, path, secs[0], (int)(((double)p.cnt * sizeof(struct json_token)) / (1024*1024)),
+        secs[1], (int)(((double)c.cnt * sizeof(struct json_ctoken)) / (1024*1024)),
+        (found[0] && found[1]) ? "" : " (not found)");
+    free(p.toks);
+    free(c.toks);
+}
+
+static void
+bench_reload(const char *input, const char *buf, int len)
+{
+    /* a number in the middle of the document toggles between two lengths
+     in place, reloaded incrementally or from scratch */
+    int i, k, at = 0, del = 0, n = len, iter[2] = {0,0};
+    double secs[2] = {0,0};
+    char *text = (char*)malloc((size_t)len + 16);
+    struct json_parser p;
+    memset(&p, 0, sizeof(p));
+    p.cap = json_count(buf, len) + 64;
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    memcpy(text, buf, (size_t)len);
+    json_load_tape(&p, text, len);
+    for (i = p.cnt / 2; i < p.cnt; ++i) {
+        if (p.toks[i].type != JSON_NUMBER) continue;
+        at = (int)(p.toks[i].str - text);
+        del = p.toks[i].len;
+        break;
+    }
+    for (k = 0; k < 2; ++k) {
+        while (secs[k] < 0.5) {
+            clock_t begin = clock();
+            for (i = 0; i < 16; ++i) {
+                int old = (n == len) ? del : 9, ins = (n == len) ? 9 : del;
+                memmove(text + at + ins, text + at + old, (size_t)(n - at - old));
+                memset(text + at, '7', (size_t)ins);
+                n += ins - old;
+                if (k) json_load_tape(&p, text, n);
+                else json_reload(&p, text, text, n, at, old, ins);
+            }
+            secs[k] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+            iter[k] += 16;
+        }
+    }
+    printf("%-8s edit   reload %10.1f us/edit   load_tape %10.1f us/edit%s\n", input,
+        (secs[0] * 1e6) / iter[0], (secs[1] * 1e6) / iter[1], p.err == JSON_OK ? "" : " (error)");
+    free(text);
+    free(p.toks);
+}
+static void
+bench_image(const char *input, const char *buf, int len, const char *path)
+{
+    /* startup cost up to a first query: parsing the document against
+     opening a saved token image, which checks the source and walks the
+     tokens once. The image sits in memory here instead of a mapped file */
+    int i, k, size, iter[2] = {0,0};
+    double secs[2] = {0,0};
+    const void *found = NULL;
+    void *img;
+    struct json_compact c;
+    struct json_parser p;
+
+    memset(&p, 0, sizeof(p));
+    p.cap = json_count(buf, len);
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    size = json_image_write(NULL, 0, p.toks, p.cnt, buf, len);
+    img = malloc((size_t)size);
+    json_image_write(img, size, p.toks, p.cnt, buf, len);
+    for (k = 0; k < 2; ++k) {
+        while (secs[k] < 0.5) {
+            clock_t begin = clock();
+            for (i = 0; i < 8; ++i) {
+                if (k && json_image_open(&c, img, size, buf, len))
+                    found = json_compact_query(&c, c.toks, c.cnt, path);
+                else if (!k && !json_load_tape(&p, buf, len))
+                    found = json_query(p.toks, p.cnt, path);
+            }
+            secs[k] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+            iter[k] += 8;
+        }
+    }
+    printf("%-8s image %6.2f MB  load+query %8.2f ms/doc  open+query %8.2f ms/doc%s\n",
+        input, size / (1024.0 * 1024.0), (secs[0] * 1000.0) / iter[0],
+        (secs[1] * 1000.0) / iter[1], (found && c.err == JSON_OK) ? "" : " (error)");
+    free(img);
+    free(p.toks);
+}
+static void
+bench_validate(const char *input, const char *buf, int len)
+{
+    /* validation without tokens against tokenizing with json_num */
+    int k, iter, ok = 0;
+    double secs[2];
+    unsigned long long cycles[2];
+    for (k = 0; k < 2; ++k) {
+        unsigned long long begin_cycles = bench_cycles();
+        secs[k] = 0;
+        for (iter = 0; secs[k] < 0.5; ++iter) {
+            clock_t begin = clock();
+            ok += k ? json_validate(buf, len) : (json_num(buf, len) > 0);
+            secs[k] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        }
+        cycles[k] = (bench_cycles() - begin_cycles) / (unsigned long long)iter;
+        secs[k] = ((double)len * iter) / (secs[k] * 1024.0 * 1024.0);
+    }
+    printf("%-8s validate json_num %8.1f MB/s %6.2f bytes/cycle  json_validate %8.1f MB/s %6.2f bytes/cycle%s\n",
+        input, secs[0], cycles[0] ? (double)len / (double)cycles[0] : 0.0,
+        secs[1], cycles[1] ? (double)len / (double)cycles[1] : 0.0, ok ? "" : " (invalid)");
+}
+static void
+bench_elements(const char *input, const char *buf, int len, const char *path)
+{
+    /* build cost of the two map kinds and an indexed lookup */
+    int i, k, size[2];
+    double build[2], query;
+    struct json_map m;
+    struct json_parser p;
+    struct json_token *found = NULL;
+    int *mem;
+
+    memset(&m, 0, sizeof(m));
+    memset(&p, 0, sizeof(p));
+    p.cap = json_count(buf, len);
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    size[0] = json_map_size(p.toks, p.cnt);
+    size[1] = json_map_arrays_size(p.toks, p.cnt);
+    mem = (int*)malloc((size_t)size[0] * sizeof(int));
+    for (i = 0; i < 2; ++i) {
+        clock_t begin = clock();
+        for (k = 0; k < 8; ++k) {
+            if (i) json_map_build_arrays(&m, p.toks, p.cnt, mem, size[1]);
+            else json_map_build(&m, p.toks, p.cnt, mem, size[0]);
+        }
+        build[i] = ((double)(clock() - begin) * 1000.0 / CLOCKS_PER_SEC) / 8;
+    }
+    {clock_t begin = clock();
+    for (k = 0; k < 100000; ++k)
+        found = json_map_query(&m, path);
+    query = ((double)(clock() - begin) * 1e9 / CLOCKS_PER_SEC) / 100000;}
+    printf("%-8s map build %6.2f ms (%d MB) arrays %6.2f ms (%d MB), %s in %.0f ns%s\n",
+        input, build[0], (int)((double)size[0] * sizeof(int) / (1024*1024)), build[1],
+        (int)((double)size[1] * sizeof(int) / (1024*1024)), path, query, found ? "" : " (not found)");
+    free(mem);
+    free(p.toks);
+}
+
+static void
+bench_cursor(const char *input, const char *buf, int len, const char **paths, int n)
+{
+    /* a few fields through the on-demand cursor against a full load */
+    int i, k, iter;
+    double secs[2];
+    struct json_cursor c;
+    struct json_token val;
+    struct json_parser p;
+    int found[2] = {0, 0};
+
+    memset(&p, 0, sizeof(p));
+    p.cap = json_count(buf, len);
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    for (i = 0; i < 2; ++i) {
+        secs[i] = 0;
+        for (iter = 0; secs[i] < 0.25; ++iter) {
+            clock_t begin = clock();
+            found[i] = 0;
+            if (i) {
+                json_load_tape(&p, buf, len);
+                for (k = 0; k < n; ++k)
+                    found[i] += json_query(p.toks, p.cnt, paths[k]) != NULL;
+            } else {
+                json_cursor_begin(&c, buf, len);
+                for (k = 0; k < n; ++k)
+                    found[i] += json_cursor_query(&c, &val, paths[k]);
+            }
+            secs[i] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        } secs[i] = (secs[i] * 1e6) / iter;
+    }
+    for (k = 0; k < n; ++k)
+        printf("%s%s", k ? ", " : "", paths[k]);
+    printf("\n%-8s cursor %10.1f us/doc   load_tape+query %10.1f us/doc%s\n",
+        input, secs[0], secs[1], (found[0] == n && found[1] == n) ? "" : " (not found)");
+    free(p.toks);
+}
+static int
+write_discard(void *usr, const char *buf, int len)
+{
+    (void)buf;
+    *(long*)usr += len;
+    return 0;
+}
+static long
+write_printf(char *out, int cap, const double *vals, const struct json_token *toks, int n)
+{
+    /* the usual snprintf based serializer with per byte escaping */
+    long total = 0;
+    int i, j, k = 0;
+    for (i = 0; i < n; ++i) {
+        if (cap - k < 512) {total += k; k = 0;}
+        if (vals) {
+            k += snprintf(out + k, (size_t)(cap - k), "%s%.17g", i ? "," : "", vals[i]);
+            continue;
+        }
+        if (i) out[k++] = ',';
+        out[k++] = '"';
+        for (j = 0; j < toks[i].len && j < 200; ++j) {
+            unsigned char c = (unsigned char)toks[i].str[j];
+            if (c == '"' || c == '\\') {out[k++] = '\\'; out[k++] = (char)c;}
+            else if (c < 0x20) k += snprintf(out + k, 8, "\\u%04x", c);
+            else out[k++] = (char)c;
+        } out[k++] = '"';
+    } return total + k;
+}
+static long
+write_writer(char *out, int cap, const double *vals, const struct json_token *toks, int n)
+{
+    long total = 0;
+    int i;
+    struct json_writer w;
+    json_write_begin(&w, out, cap, write_discard, &total);
+    json_write_array(&w);
+    for (i = 0; i < n; ++i) {
+        if (vals) json_write_number(&w, vals[i]);
+        else json_write_string(&w, toks[i].str, toks[i].len < 200 ? toks[i].len : 200);
+    }
+    json_write_close(&w);
+    json_write_end(&w);
+    return total;
+}
+static void
+bench_write(const char *input, const char *buf, int len, int numbers)
+{
+    /* serializes the values of a corpus back out */
+    int i, k, n = 0, iter[2] = {0,0};
+    long bytes[2] = {0,0};
+    double secs[2] = {0,0};
+    char *out = (char*)malloc(1 << 16);
+    double *vals = NULL;
+    struct json_token *toks;
+    struct json_parser p;
+    memset(&p, 0, sizeof(p));
+    p.cap = json_num(buf, len) + 1;
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    vals = (double*)malloc((size_t)p.cap * sizeof(double));
+    for (i = 0; i < p.cnt; ++i) {
+        if (p.toks[i].type != (numbers ? JSON_NUMBER : JSON_STRING)) continue;
+        toks[n] = p.toks[i];
+        json_convert(&vals[n++], &p.toks[i]);
+    }
+    for (k = 0; k < 2; ++k) {
+        while (secs[k] < 0.5) {
+            clock_t begin = clock();
+            bytes[k] = k ? write_writer(out, 1 << 16, numbers ? vals : NULL, toks, n):
+                write_printf(out, 1 << 16, numbers ? vals : NULL, toks, n);
+            secs[k] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+            iter[k]++;
+        }
+    }
+    printf("%-8s write %8d values  snprintf %9.1f MB/s %7.1f ns/value  writer %9.1f MB/s %7.1f ns/value\n",
+        input, n, ((double)bytes[0] * iter[0]) / (secs[0] * 1024.0 * 1024.0),
+        (secs[0] * 1e9) / ((double)iter[0] * n),
+        ((double)bytes[1] * iter[1]) / (secs[1] * 1024.0 * 1024.0),
+        (secs[1] * 1e9) / ((double)iter[1] * n));
+    free(vals); free(toks); free(p.toks); free(out);
+}
+struct bench_record {json_int id; char name[16]; json_number x; int on;};
+static long
+decode_cmp(struct bench_record *r, struct json_token *rec)
+{
+    /* hand written pair walk comparing each key in turn */
+    int i;
+    struct json_token *t = json_obj_begin(rec);
+    memset(r, 0, sizeof(*r));
+    for (i = 0; i < rec->children && t; ++i, t = json_obj_next(t)) {
+        if (!json_cmp(&t[0], "id")) json_convert_i64(&r->id, &t[1]);
+        else if (!json_cmp(&t[0], "name")) json_cpy(r->name, 16, &t[1]);
+        else if (!json_cmp(&t[0], "x")) json_convert(&r->x, &t[1]);
+        else if (!json_cmp(&t[0], "on")) r->on = t[1].type == JSON_TRUE;
+    } return (long)r->id + r->on;
+}
+static long
+decode_query(struct bench_record *r, struct json_token *rec)
+{
+    /* one path query per member */
+    int size;
+    memset(r, 0, sizeof(*r));
+    json_query_int(&r->id, rec, rec->sub, "id");
+    json_query_string(r->name, 16, &size, rec, rec->sub, "name");
+    json_query_number(&r->x, rec, rec->sub, "x");
+    r->on = json_query_type(rec, rec->sub, "on") == JSON_TRUE;
+    return (long)r->id + r->on;
+}
+static void
+bench_decode(const char *input, const char *buf, int len)
+{
+    /* decodes every record of the flat corpus into a struct, by id with
+     the keys interned once per document up front */
+    static const char *names[] = {"json_cmp", "json_query", "decode_struct", "decode_ids"};
+    const struct json_field fields[] = {
+        {"id", offsetof(struct bench_record, id), JSON_FIELD_INT, 0, NULL},
+        {"name", offsetof(struct bench_record, name), JSON_FIELD_STRING, 16, NULL},
+        {"x", offsetof(struct bench_record, x), JSON_FIELD_NUMBER, 0, NULL},
+        {"on", offsetof(struct bench_record, on), JSON_FIELD_BOOL, 0, NULL}};
+    int i, k, iter, recs = 0, *ids, mem[2048];
+    long sum = 0;
+    double secs;
+    struct json_dict d;
+    struct json_schema s;
+    struct json_parser p;
+    struct json_token *arr, *rec;
+    struct bench_record r;
+
+    memset(&p, 0, sizeof(p));
+    p.cap = json_count(buf, len);
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    json_schema_build(&s, fields, 4);
+    json_dict_init(&d, mem, 2048, 256, 2048);
+    json_schema_bind(&s, &d);
+    ids = (int*)malloc((size_t)p.cnt * sizeof(int));
+    arr = json_query(p.toks, p.cnt, "records");
+    for (k = 0; k < 4; ++k) {
+        secs = 0;
+        for (iter = 0; secs < 0.25; ++iter) {
+            clock_t begin = clock();
+            rec = json_array_begin(arr);
+            for (i = 0; i < arr->children && rec; ++i, rec = json_array_next(rec)) {
+                if (k == 0) sum += decode_cmp(&r, rec);
+                else if (k == 1) sum += decode_query(&r, rec);
+                else if (k == 2) {
+                    memset(&r, 0, sizeof(r));
+                    json_decode_struct(&r, &s, rec, rec->sub + 1);
+                    sum += (long)r.id + r.on;
+                } else {
+                    memset(&r, 0, sizeof(r));
+                    json_decode_ids(&r, &s, rec, ids + (rec - p.toks), rec->sub + 1);
+                    sum += (long)r.id + r.on;
+                }
+            } recs = i;
+            secs += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        }
+        printf("%-8s decode %-14s %8d records %8.1f ns/record%s\n", input, names[k], recs,
+            (secs * 1e9) / ((double)iter * recs), sum ? "" : " (empty)");
+        if (k != 2) continue;
+        secs = 0;
+        for (iter = 0; secs < 0.25; ++iter) {
+            clock_t begin = clock();
+            sum += json_intern(&d, ids, p.toks, p.cnt, 1);
+            secs += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        }
+        printf("%-8s decode %-14s %8d records %8.1f ns/record (%d keys)\n", input, "json_intern",
+            recs, (secs * 1e9) / ((double)iter * recs), d.cnt);
+    }
+    free(ids);
+    free(p.toks);
+}
+static int
+select_sum(void *usr, struct json_token *tok)
+{
+    *(long*)usr += tok->len;
+    return 0;
+}
+static void
+bench_select(const char *input, const char *buf, int len)
+{
+    /* every name and the ids of records passing a filter, by looping over
+     the array with a query per element against one json_select pass */
+    static const char *queries[] = {"records[*].name", "records[?on==true].id", "..[?x>=500].name"};
+    int i, k, q, iter, recs = 0;
+    long sum = 0;
+    double secs[2];
+    json_number x;
+    struct json_select sel;
+    struct json_parser p;
+    struct json_token *arr, *rec, *t;
+
+    memset(&p, 0, sizeof(p));
+    p.cap = json_count(buf, len);
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    for (q = 0; q < 3; ++q) {
+        json_select_compile(&sel, queries[q]);
+        for (k = 0; k < 2; ++k) {
+            secs[k] = 0;
+            for (iter = 0; secs[k] < 0.25; ++iter) {
+                clock_t begin = clock();
+                if (k) json_select(p.toks, p.cnt, &sel, select_sum, &sum);
+                else {
+                    arr = json_query(p.toks, p.cnt, "records");
+                    rec = json_array_begin(arr);
+                    for (i = 0; i < arr->children && rec; ++i, rec = json_array_next(rec)) {
+                        if (q == 1 && json_query_type(rec, rec->sub, "on") != JSON_TRUE)
+                            continue;
+                        if (q == 2 && (json_query_number(&x, rec, rec->sub, "x") != JSON_NUMBER || x < 500))
+                            continue;
+                        if ((t = json_query(rec, rec->sub, q == 1 ? "id" : "name")) != NULL)
+                            sum += t->len;
+                    } recs = i;
+                }
+                secs[k] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+            } secs[k] = (secs[k] * 1e9) / ((double)iter * recs);
+        }
+        printf("%-8s select %-22s query loop %6.1f ns/record  json_select %6.1f ns/record%s\n",
+            input, queries[q], secs[0], secs[1], sum ? "" : " (empty)");
+    }
+    free(p.toks);
+}
+static char bench_arena[1 << 16];
+static int bench_arena_used;
+static void*
+arena_alloc(void *usr, int size)
+{
+    void *m;
+    (void)usr;
+    size = (size + 15) & ~15;
+    if (size > (int)sizeof(bench_arena) - bench_arena_used) return NULL;
+    m = bench_arena + bench_arena_used;
+    bench_arena_used += size;
+    return m;
+}
+static void
+bench_messages(int count)
+{
+    /* many small documents: a fresh parser and token array for each
+     against one arena backed parser that is reset between them */
+    int i, k, iter, cnt = 0;
+    double secs[2];
+    char msgs[64][96];
+    int lens[64];
+    struct json_parser p;
+
+    for (i = 0; i < 64; ++i)
+        lens[i] = sprintf(msgs[i], "{\"id\":%d,\"type\":\"tick\",\"px\":%d.%02d,\"qty\":%d,\"tags\":[%d,%d]}",
+            i * 7919, 100 + i, i, i % 13, i, i + 1);
+    for (k = 0; k < 2; ++k) {
+        secs[k] = 0;
+        bench_arena_used = 0;
+        json_parser_init(&p, arena_alloc, 0, 0);
+        for (iter = 0; secs[k] < 0.5; ++iter) {
+            clock_t begin = clock();
+            for (i = 0; i < count; ++i) {
+                const char *m = msgs[i & 63];
+                if (k) {
+                    json_parser_reset(&p);
+                    json_load(&p, m, lens[i & 63]);
+                    cnt += p.cnt;
+                } else {
+                    struct json_parser q;
+                    memset(&q, 0, sizeof(q));
+                    while (json_load(&q, m, lens[i & 63]))
+                        q.toks = (struct json_token*)realloc(q.toks, (size_t)q.cap * sizeof(struct json_token));
+                    cnt += q.cnt;
+                    free(q.toks);
+                }
+            } secs[k] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        } secs[k] = (secs[k] * 1e9) / ((double)iter * count);
+    }
+    printf("messages %d bytes parser  realloc %7.1f ns/message  arena+reset %7.1f ns/message%s\n",
+        (int)sizeof(struct json_parser), secs[0], secs[1], cnt ? "" : " (empty)");
+}
+static char*
+gen_samples(int *len, int count)
+{
+    /* time series: array of small objects sharing their key order */
+    int i, n = 0;
+    char *buf = (char*)malloc((size_t)count * 80 + 32);
+    n += sprintf(buf + n, "{\"samples\":[");
+    for (i = 0; i < count; ++i)
+        n += sprintf(buf + n, "%s{\"t\":%d,\"v\":%d.%03d,\"q\":%d,\"src\":\"s%d\"}",
+            i ? "," : "", 1600000000 + i, i % 977, i % 1000, i & 3, i % 16);
+    n += sprintf(buf + n, "]}");
+    *len = n;
+    return buf;
+}
+static void
+bench_columns(int count)
+{
+    /* pulling two fields out of every element: a json_array_next loop
+     with a query per field against json_columns */
+    int i, k, len, iter;
+    double secs[2], sum = 0;
+    char *buf = gen_samples(&len, count);
+    json_int *t = (json_int*)malloc((size_t)count * sizeof(json_int));
+    json_number *v = (json_number*)malloc((size_t)count * sizeof(json_number));
+    struct json_column cols[2];
+    struct json_token *arr;
+    struct json_parser p;
+
+    memset(&p, 0, sizeof(p));
+    p.cap = json_count(buf, len);
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+    json_load_tape(&p, buf, len);
+    arr = json_query(p.toks, p.cnt, "samples");
+    memset(cols, 0, sizeof(cols));
+    cols[0].path = "t"; cols[0].type = JSON_COLUMN_INT; cols[0].out = t;
+    cols[1].path = "v"; cols[1].type = JSON_COLUMN_NUMBER; cols[1].out = v;
+    for (k = 0; k < 2; ++k) {
+        secs[k] = 0;
+        for (iter = 0; secs[k] < 0.5; ++iter) {
+            clock_t begin = clock();
+            if (k) json_columns(cols, 2, arr);
+            else {
+                struct json_token *e = json_array_begin(arr);
+                for (i = 0; i < arr->children && e; ++i, e = json_array_next(e)) {
+                    json_query_int(&t[i], e + 1, e->sub, "t");
+                    json_query_number(&v[i], e + 1, e->sub, "v");
+                }
+            }
+            secs[k] += (double)(clock() - begin) / CLOCKS_PER_SEC;
+            sum += v[count - 1] + (double)t[count / 2];
+        } secs[k] = (secs[k] * 1e9) / ((double)iter * count);
+    }
+    bench_sink = sum;
+    printf("samples  columns %8d elements  query loop %7.1f ns/element  json_columns %7.1f ns/element\n",
+        count, secs[0], secs[1]);
+    free(p.toks); free(t); free(v); free(buf);
+}
+static void
+bench(const char *input, const char *name, const char *buf, int len,
+    int (*load)(struct json_parser*, const char*, int))
+{
+    int i, iter = 0, cnt = 0;
+    double secs = 0;
+    struct json_parser p;
+    memset(&p, 0, sizeof(p));
+    p.cap = json_num(buf, len) + 1;
+    p.toks = (struct json_token*)malloc((size_t)p.cap * sizeof(struct json_token));
+
+    while (secs < 0.5) {
+        clock_t begin = clock();
+        for (i = 0; i < 8; ++i)
+            cnt = load(&p, buf, len);
+        secs += (double)(clock() - begin) / CLOCKS_PER_SEC;
+        iter += 8;
+    }
+    printf("%-8s %-12s %10d tokens %9.1f MB/s %8.2f ms/doc %s\n", input, name, cnt,
+        ((double)len * iter) / (secs * 1024.0 * 1024.0), (secs * 1000.0) / iter,
+        p.err == JSON_OK ? "" : "(error)");
+    free(p.toks);
+}
+/* ---------------------------------------------------------------
+ *                          SUITE
+ * --------------------------------------------------------------- */
+/* Fixed set of generated corpora shaped like the usual JSON benchmark
+ files, measured for json_load, json_num, json_validate, json_query and
+ json_convert. Each round times a batch of calls with a monotonic clock
+ and the median round is reported, so runs are comparable and can be
+ checked against a saved baseline. Ops reading the text are given in
+ MB/s of input, query and convert only read tokens that are already
+ loaded and are given in ns per query/number. Cycles are read from the time
+ stamp counter, which ticks at a constant reference rate on current
+ x86 processors and is not available elsewhere. */
+static char*
+gen_twitter(int *len, int count)
+{
+    /* search results: nested user and entity objects, long ids, urls,
+     escapes, UTF-8 text and many null and boolean fields */
+    static const char *texts[] = {
+        "RT @sn%d: check this out https:\\/\\/t.co\\/Xf3kQ \\u2764\\ufe0f",
+        "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe3\x83\x84\xe3\x82\xa4\xe3\x83\xbc\xe3\x83\x88 #%d",
+        "just setting up my account, reply %d times if you \\\"like\\\" it\\n",
+        "caf\xc3\xa9 \xf0\x9f\x98\x80 %d people were here"};
+    int i, n = 0;
+    char *buf = (char*)malloc((size_t)count * 1536 + 256);
+    n += sprintf(buf + n, "{\"statuses\":[");
+    for (i = 0; i < count; ++i) {
+        unsigned long long id = 505874924095815681ull + (unsigned long long)i * 7919ull;
+        n += sprintf(buf + n, "%s{\"metadata\":{\"result_type\":\"recent\",\"iso_language_code\":\"%s\"},"
+            "\"created_at\":\"Sun Aug 31 00:%02d:%02d +0000 2014\",\"id\":%llu,\"id_str\":\"%llu\",\"text\":\"",
+            i ? "," : "", (i & 1) ? "ja" : "en", i % 60, (i * 7) % 60, id, id);
+        n += sprintf(buf + n, texts[i % 4], i);
+        n += sprintf(buf + n, "\",\"source\":\"<a href=\\\"http:\\/\\/twitter.com\\/download\\/iphone\\\" "
+            "rel=\\\"nofollow\\\">Twitter for iPhone<\\/a>\",\"truncated\":false,"
+            "\"in_reply_to_status_id\":null,\"in_reply_to_user_id\":%s,\"user\":{\"id\":%d,"
+            "\"id_str\":\"%d\",\"name\":\"user %d\",\"screen_name\":\"sn%d\",\"location\":\"%s\","
+            "\"description\":\"bio of user %d, likes json and coffee\",\"url\":null,"
+            "\"protected\":false,\"followers_count\":%d,\"friends_count\":%d,\"listed_count\":%d,"
+            "\"created_at\":\"Fri Jan 04 2013\",\"favourites_count\":%d,\"utc_offset\":null,"
+            "\"verified\":%s,\"statuses_count\":%d,\"lang\":\"%s\",\"profile_image_url\":"
+            "\"http:\\/\\/pbs.twimg.com\\/profile_images\\/%d\\/normal.jpeg\",\"default_profile\":true},",
+            (i % 5) ? "null" : "1186275104", 1186275104 + i, 1186275104 + i, i, i,
+            (i % 3) ? "" : "\xe6\x9d\xb1\xe4\xba\xac", i, i % 9000, i % 700, i % 30, i % 4000,
+            (i % 11) ? "false" : "true", i * 3, (i & 1) ? "ja" : "en", 378800000 + i);
+        n += sprintf(buf + n, "\"geo\":null,\"coordinates\":null,\"place\":null,\"retweet_count\":%d,"
+            "\"favorite_count\":%d,\"entities\":{\"hashtags\":[{\"text\":\"tag%d\",\"indices\":[%d,%d]}],"
+            "\"symbols\":[],\"urls\":[],\"user_mentions\":[{\"screen_name\":\"sn%d\",\"name\":\"user %d\","
+            "\"id\":%d,\"id_str\":\"%d\",\"indices\":[3,%d]}]},\"favorited\":false,\"retweeted\":false,"
+            "\"lang\":\"%s\"}", i % 50, i % 20, i % 100, i % 40, i % 40 + 6, i / 2, i / 2,
+            1186275104 + i / 2, 1186275104 + i / 2, 8 + i % 5, (i & 1) ? "ja" : "en");
+    }
+    n += sprintf(buf + n, "],\"search_metadata\":{\"completed_in\":0.087,\"max_id\":505874924095815681,"
+        "\"query\":\"%%E4%%B8%%80\",\"count\":%d,\"since_id\":0}}", count);
+    *len = n;
+    return buf;
+}
+static char*
+gen_canada(int *len, int features, int points)
+{
+    /* GeoJSON polygons: long arrays of coordinate pairs with full
+     precision doubles */
+    int i, k, n = 0;
+    unsigned long long r = 88172645463325252ull;
+    char *buf = (char*)malloc((size_t)features * (size_t)points * 48 + 256);
+    n += sprintf(buf + n, "{\"type\":\"FeatureCollection\",\"features\":[");
+    for (i = 0; i < features; ++i) {
+        n += sprintf(buf + n, "%s{\"type\":\"Feature\",\"properties\":{\"name\":\"region %d\"},"
+            "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[", i ? "," : "", i);
+        for (k = 0; k < points; ++k) {
+            double x, y;
+            r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+            x = -141.0 + (double)(r >> 11) / 9007199254740992.0 * 88.0;
+            y = 41.0 + (double)(r & 0xFFFFFFFFull) / 4294967296.0 * 42.0;
+            n += sprintf(buf + n, "%s[%.15f,%.15f]", k ? "," : "", x, y);
+        }
+        n += sprintf(buf + n, "]]}}");
+    }
+    n += sprintf(buf + n, "]}");
+    *len = n;
+    return buf;
+}
+static char*
+gen_tiny(int *len, int **offs, int count)
+{
+    /* newline separated small messages, each loaded on its own */
+    int i, n = 0;
+    char *buf = (char*)malloc((size_t)count * 128 + 16);
+    *offs = (int*)malloc((size_t)(count + 1) * sizeof(int));
+    for (i = 0; i < count; ++i) {
+        (*offs)[i] = n;
+        n += sprintf(buf + n, "{\"id\":%d,\"type\":\"%s\",\"px\":%d.%02d,\"qty\":%d,\"ok\":%s,"
+            "\"tags\":[%d,\"t%d\"]}\n", i * 7919, (i % 3) ? "tick" : "trade", 100 + i % 900,
+            i % 100, i % 13, (i & 1) ? "true" : "false", i % 50, i % 7);
+    }
+    (*offs)[count] = n;
+    *len = n;
+    return buf;
+}
+
+struct suite_corpus {
+    const char *name;
+    const char *buf;
+    int len;
+    const int *offs;            /* tiny documents or null */
+    int docs;
+    const char *list;           /* array of records or null for the root */
+    const char *path;           /* queried in each record */
+    struct json_parser p;       /* all tokens, per document at toff */
+    int *toff;
+    struct json_parser load;    /* scratch tokens of the load rounds */
+};
+static int
+suite_load(struct suite_corpus *c)
+{
+    int i, n = 0;
+    if (!c->docs) {
+        json_parser_reset(&c->load);
+        json_load(&c->load, c->buf, c->len);
+        return c->load.cnt;
+    }
+    for (i = 0; i < c->docs; ++i) {
+        json_parser_reset(&c->load);
+        json_load(&c->load, c->buf + c->offs[i], c->offs[i+1] - c->offs[i] - 1);
+        n += c->load.cnt;
+    } return n;
+}
+static int
+suite_num(struct suite_corpus *c)
+{
+    int i, n = 0;
+    if (!c->docs)
+        return json_num(c->buf, c->len);
+    for (i = 0; i < c->docs; ++i)
+        n += json_num(c->buf + c->offs[i], c->offs[i+1] - c->offs[i] - 1);
+    return n;
+}
+static int
+suite_validate(struct suite_corpus *c)
+{
+    /* counts valid documents */
+    int i, n = 0;
+    if (!c->docs)
+        return json_validate(c->buf, c->len);
+    for (i = 0; i < c->docs; ++i)
+        n += json_validate(c->buf + c->offs[i], c->offs[i+1] - c->offs[i] - 1);
+    return n;
+}
+static int
+suite_query(struct suite_corpus *c)
+{
+    /* one query inside every record: the elements of `list`, the root
+     values or each tiny document. Returns the number of queries */
+    int i, keyed, n = 0, found = 0;
+    for (i = 0; i < (c->docs ? c->docs : 1); ++i) {
+        struct json_token *toks = c->p.toks + c->toff[i];
+        int cnt = c->toff[i+1] - c->toff[i];
+        struct json_token *rec = toks, *end = toks + cnt;
+        if (c->docs) {
+            found += json_query(toks, cnt, c->path) != NULL;
+            n++;
+            continue;
+        }
+        keyed = 1;
+        if (c->list) {
+            struct json_token *list = json_query(toks, cnt, c->list);
+            keyed = (list->type == JSON_OBJECT);
+            rec = list + 1;
+            end = rec + list->sub;
+        }
+        while (rec < end) {
+            rec += keyed;
+            found += json_query(rec + 1, rec->sub, c->path) != NULL;
+            rec += rec->sub + 1;
+            n++;
+        }
+    }
+    bench_sink = found;
+    return n;
+}
+static int
+suite_convert(struct suite_corpus *c)
+{
+    int i, n = 0;
+    double sum = 0;
+    for (i = 0; i < c->toff[c->docs ? c->docs : 1]; ++i) {
+        json_number v;
+        if (c->p.toks[i].type != JSON_NUMBER) continue;
+        json_convert(&v, &c->p.toks[i]);
+        sum += v;
+        n++;
+    }
+    bench_sink = sum;
+    return n;
+}
+static void
+suite_prepare(struct suite_corpus *c)
+{
+    /* tokens of every document for the query and convert rounds */
+    int i, docs = c->docs ? c->docs : 1, total = 0;
+    json_parser_init(&c->p, 0, 0, 0);
+    c->toff = (int*)malloc((size_t)(docs + 1) * sizeof(int));
+    c->p.cap = c->docs ? 0 : json_num(c->buf, c->len) + 1;
+    for (i = 0; c->docs && i < c->docs; ++i)
+        c->p.cap += json_num(c->buf + c->offs[i], c->offs[i+1] - c->offs[i] - 1);
+    c->p.toks = (struct json_token*)malloc((size_t)(c->p.cap + 1) * sizeof(struct json_token));
+    for (i = 0; i < docs; ++i) {
+        struct json_parser q;
+        json_parser_init(&q, 0, 0, 0);
+        q.toks = c->p.toks + total;
+        q.cap = c->p.cap - total + 1;
+        if (c->docs) json_load(&q, c->buf + c->offs[i], c->offs[i+1] - c->offs[i] - 1);
+        else json_load(&q, c->buf, c->len);
+        c->toff[i] = total;
+        total += q.cnt;
+    }
+    c->toff[docs] = total;
+    c->p.cnt = total;
+    json_parser_init(&c->load, 0, 0, 0);
+    c->load.cap = c->p.cap;
+    c->load.toks = (struct json_token*)malloc((size_t)(c->p.cap + 1) * sizeof(struct json_token));
+}
+struct suite_op {
+    const char *name;
+    int (*run)(struct suite_corpus*);
+    const char *count;          /* what the returned count is */
+    int per_op;                 /* ns per returned count instead of MB/s */
+};
+static const struct suite_op suite_ops[] = {
+    {"json_query", suite_query, "queries", 1},
+    {"json_convert", suite_convert, "numbers", 1},
+    {"json_load", suite_load, "tokens", 0},
+    {"json_num", suite_num, "tokens", 0},
+    {"json_validate", suite_validate, "valid", 0}};
+#define SUITE_OPS ((int)(sizeof(suite_ops)/sizeof(suite_ops[0])))
+#define SUITE_CORPORA 4
+#define SUITE_ROUNDS 11
+
+struct suite_result {
+    const struct suite_corpus *corpus;
+    const struct suite_op *op;
+    int iter, cnt;
+    double secs[SUITE_ROUNDS], cycles[SUITE_ROUNDS];
+    double value, cpu;          /* MB/s or ns/op, cycles per byte or op */
+    double base;                /* value in the baseline or 0 */
+};
+static int
+suite_cmp(const void *a, const void *b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+static void
+suite_calibrate(struct suite_result *r)
+{
+    /* batch size of at least 20ms, which also warms up the caches */
+    double begin;
+    int i;
+    for (r->iter = 1;; r->iter *= 2) {
+        begin = bench_now();
+        for (i = 0; i < r->iter; ++i)
+            r->cnt = r->op->run((struct suite_corpus*)r->corpus);
+        if (bench_now() - begin >= 0.02) break;
+    }
+}
+static void
+suite_rounds(struct suite_result **r, int n)
+{
+    /* each round times one batch of every op, so a slow phase of the
+     machine spreads over all of them instead of hitting a few. Values
+     are taken from the median round */
+    int i, k, round;
+    for (round = 0; round < SUITE_ROUNDS; ++round) {
+        for (i = 0; i < n; ++i) {
+            struct suite_corpus *c = (struct suite_corpus*)r[i]->corpus;
+            double begin = bench_now();
+            unsigned long long begin_cycles = bench_cycles();
+            for (k = 0; k < r[i]->iter; ++k)
+                r[i]->op->run(c);
+            r[i]->cycles[round] = (double)(bench_cycles() - begin_cycles) / r[i]->iter;
+            r[i]->secs[round] = (bench_now() - begin) / r[i]->iter;
+        }
+    }
+    for (i = 0; i < n; ++i) {
+        double per = r[i]->op->per_op ? (double)(r[i]->cnt ? r[i]->cnt : 1) :
+            (double)r[i]->corpus->len;
+        double secs;
+        qsort(r[i]->secs, SUITE_ROUNDS, sizeof(r[i]->secs[0]), suite_cmp);
+        qsort(r[i]->cycles, SUITE_ROUNDS, sizeof(r[i]->cycles[0]), suite_cmp);
+        secs = r[i]->secs[SUITE_ROUNDS/2];
+        r[i]->value = r[i]->op->per_op ? secs * 1e9 / per :
+            (double)r[i]->corpus->len / (secs * 1024.0 * 1024.0);
+        r[i]->cpu = r[i]->cycles[SUITE_ROUNDS/2] / per;
+    }
+}
+static int
+suite_slower(const struct suite_result *r, double percent)
+{
+    /* same threshold in both units: throughput down by percent */
+    if (r->base <= 0) return 0;
+    if (r->op->per_op)
+        return r->value * (1.0 - percent / 100.0) > r->base;
+    return r->value < r->base * (1.0 - percent / 100.0);
+}
+static void
+suite_print(const struct suite_result *r, int csv)
+{
+    const struct suite_corpus *c = r->corpus;
+    const char *unit = r->op->per_op ? "ns/op" : "MB/s";
+    if (csv) printf("%s,%s,%d,%d,%.2f,%s,%.3f\n", c->name, r->op->name, c->len, r->cnt,
+        r->value, unit, r->cpu);
+    else printf("%-8s %-13s %8.2f MB %9d %-7s %10.1f %-6s %8.2f cycles/%s\n",
+        c->name, r->op->name, c->len / (1024.0 * 1024.0), r->cnt,
+        r->op->count, r->value, unit, r->cpu,
+        r->op->per_op ? "op" : "byte");
+}
+static int
+suite_baseline(struct suite_result *r, int n, const char *path)
+{
+    /* values of a previous --csv run, rows in another unit are ignored */
+    char line[256], corpus[32], op[32], unit[16];
+    double value;
+    int i;
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%31[^,],%31[^,],%*d,%*d,%lf,%15[^,]", corpus, op, &value, unit) != 4)
+            continue;
+        for (i = 0; i < n; ++i) {
+            if (strcmp(r[i].corpus->name, corpus) || strcmp(r[i].op->name, op)) continue;
+            if (strcmp(r[i].op->per_op ? "ns/op" : "MB/s", unit)) continue;
+            r[i].base = value;
+        }
+    } fclose(f);
+    return 1;
+}
+static int
+suite(int csv, const char *baseline, double percent)
+{
+    /* runs the suite, with a baseline from a previous --csv run it fails
+     if any throughput fell more than percent below it. Ops that look
+     slower are measured again before they count as a regression */
+    int i, k, n = 0, worse = 0;
+    struct suite_result res[SUITE_CORPORA * SUITE_OPS], *list[SUITE_CORPORA * SUITE_OPS];
+    struct suite_corpus c[SUITE_CORPORA];
+    int *offs = NULL;
+
+    memset(c, 0, sizeof(c));
+    memset(res, 0, sizeof(res));
+    c[0].name = "twitter";
+    c[1].name = "canada";
+    c[2].name = "deep";
+    c[3].name = "tiny";
+    for (i = 0; i < SUITE_CORPORA; ++i) {
+        for (k = 0; k < SUITE_OPS; ++k, ++n) {
+            res[n].corpus = &c[i];
+            res[n].op = &suite_ops[k];
+            list[n] = &res[n];
+        }
+    }
+    if (baseline && !suite_baseline(res, n, baseline)) {
+        fprintf(stderr, "cannot open baseline %s\n", baseline);
+        return 2;
+    }
+    c[0].buf = gen_twitter(&c[0].len, 4000);
+    c[0].list = "statuses";
+    c[0].path = "user.screen_name";
+    c[1].buf = gen_canada(&c[1].len, 24, 4000);
+    c[1].list = "features";
+    c[1].path = "geometry.type";
+    c[2].buf = gen_nested(&c[2].len, 600, 160);
+    c[2].path = "c.c.c.v3[1]";
+    c[3].buf = gen_tiny(&c[3].len, &offs, 60000);
+    c[3].offs = offs;
+    c[3].docs = 60000;
+    c[3].path = "tags[1]";
+
+    for (i = 0; i < SUITE_CORPORA; ++i)
+        suite_prepare(&c[i]);
+    for (i = 0; i < n; ++i)
+        suite_calibrate(&res[i]);
+    suite_rounds(list, n);
+    if (csv) printf("corpus,op,bytes,count,value,unit,cycles_per_unit\n");
+    for (i = 0; i < n; ++i)
+        suite_print(&res[i], csv);
+
+    if (baseline) {
+        for (k = 0; k < 3; ++k) {
+            /* the better of both measurements is kept */
+            double prev[SUITE_CORPORA * SUITE_OPS];
+            int cnt = 0;
+            for (i = 0; i < n; ++i)
+                if (suite_slower(&res[i], percent))
+                    list[cnt++] = &res[i];
+            if (!cnt) break;
+            printf("measuring %d ops again\n", cnt);
+            for (i = 0; i < cnt; ++i)
+                prev[i] = list[i]->value;
+            suite_rounds(list, cnt);
+            for (i = 0; i < cnt; ++i) {
+                if (list[i]->op->per_op ? prev[i] < list[i]->value : prev[i] > list[i]->value)
+                    list[i]->value = prev[i];
+            }
+        }
+        for (i = 0; i < n; ++i) {
+            const char *unit = res[i].op->per_op ? "ns/op" : "MB/s";
+            if (!suite_slower(&res[i], percent)) continue;
+            printf("regression: %s %s %.1f %s (baseline %.1f %s)\n", res[i].corpus->name,
+                res[i].op->name, res[i].value, unit, res[i].base, unit);
+            worse++;
+        }
+        printf("%d regressions beyond %.0f%%\n", worse, percent);
+    }
+    for (i = 0; i < SUITE_CORPORA; ++i) {
+        free(c[i].p.toks);
+        free(c[i].load.toks);
+        free(c[i].toff);
+        free((void*)c[i].buf);
+    }
+    free(offs);
+    return worse ? 1 : 0;
+}
+int main(int argc, char **argv)
+{
+    int i, len;
+    struct {const char *name; char *buf; int len;} inputs[2];
+    const char *fields[2][3] = {
+        {"records[0].id", "records[2].name", "records[99999].on"},
+        {"s0.v0[1]", "s1.c.c.v2[0]", "s1999.c.c.c.v3[1]"}};
+    /* json_bench --suite | --csv | --check baseline.csv [percent] */
+    if (argc > 1 && !strcmp(argv[1], "--suite"))
+        return suite(0, NULL, 0);
+    if (argc > 1 && !strcmp(argv[1], "--csv"))
+        return suite(1, NULL, 0);
+    if (argc > 2 && !strcmp(argv[1], "--check"))
+        return suite(0, argv[2], (argc > 3) ? atof(argv[3]) : 10.0);
+
+    inputs[0].name = "flat";
+    inputs[0].buf = gen_flat(&inputs[0].len, 100000);
+    inputs[1].name = "nested";
+    inputs[1].buf = gen_nested(&inputs[1].len, 2000, 48);
+
+    for (i = 0; i < 2; ++i) {
+        len = inputs[i].len;
+        bench_idx_cap = json_index(NULL, 0, inputs[i].buf, len);
+        bench_idx = (int*)malloc((size_t)bench_idx_cap * sizeof(int));
+        printf("%s: %.2f MB\n", inputs[i].name, len / (1024.0 * 1024.0));
+        bench(inputs[i].name, "json_load", inputs[i].buf, len, load_old);
+        bench(inputs[i].name, "load_tape", inputs[i].buf, len, load_tape);
+        bench(inputs[i].name, "load_index", inputs[i].buf, len, load_index);
+        bench(inputs[i].name, "load_grow", inputs[i].buf, len, load_grow);
+        bench(inputs[i].name, "load_exact", inputs[i].buf, len, load_exact);
+        bench(inputs[i].name, "load_compact", inputs[i].buf, len, load_compact);
+        bench(inputs[i].name, "load_stream", inputs[i].buf, len, load_stream);
+        bench(inputs[i].name, "parallel", inputs[i].buf, len, load_parallel);
+#ifdef JSON_BENCH_THREADS
+        bench(inputs[i].name, "parallel_mt", inputs[i].buf, len, load_parallel_mt);
+#endif
+        bench_query(inputs[i].name, inputs[i].buf, len, i ? "s1999.c.c.c.v3[1]" : "records[99999].on");
+        bench_elements(inputs[i].name, inputs[i].buf, len, i ? "s1999.c.c.c.v3[1]" : "records[99999].on");
+        bench_cursor(inputs[i].name, inputs[i].buf, len, fields[i], 3);
+        bench_reload(inputs[i].name, inputs[i].buf, len);
+        bench_validate(inputs[i].name, inputs[i].buf, len);
+        bench_image(inputs[i].name, inputs[i].buf, len, i ? "s1999.c.c.c.v3[1]" : "records[99999].on");
+        if (!i) {
+            bench_decode(inputs[i].name, inputs[i].buf, len);
+            bench_select(inputs[i].name, inputs[i].buf, len);
+        }
+        free(bench_idx);
+        free(inputs[i].buf);
+    }
+
+    bench_messages(100000);
+    bench_columns(20000);
+
+    inputs[0].buf = gen_lines(&len, 200000);
+    printf("lines: %.2f MB\n", len / (1024.0 * 1024.0));
+    bench("lines", "load_lines", inputs[0].buf, len, load_lines);
+#ifdef JSON_BENCH_THREADS
+    bench("lines", "lines_mt", inputs[0].buf, len, load_lines_mt);
+#endif
+    free(inputs[0].buf);
+
+    inputs[0].buf = gen_strings(&len, 50000);
+    printf("strings: %.2f MB\n", len / (1024.0 * 1024.0));
+    bench("strings", "json_load", inputs[0].buf, len, load_old);
+    bench("strings", "load_tape", inputs[0].buf, len, load_tape);
+    bench_unescape(inputs[0].buf, len, "naive", unescape_naive);
+    bench_unescape(inputs[0].buf, len, "json_unescape", json_unescape);
+    bench_write("strings", inputs[0].buf, len, 0);
+    free(inputs[0].buf);
+
+    inputs[0].buf = gen_numbers(&len, 200000);
+    printf("numbers: %.2f MB\n", len / (1024.0 * 1024.0));
+    bench_numbers(inputs[0].buf, len, "convert_old", convert_old);
+    bench_numbers(inputs[0].buf, len, "json_convert", convert_new);
+    bench_numbers(inputs[0].buf, len, "strtod", convert_strtod);
+    bench_write("numbers", inputs[0].buf, len, 1);
+    free(inputs[0].buf);
+
+    inputs[0].buf = gen_ids(&len, 100000);
+    printf("ids: %.2f MB\n", len / (1024.0 * 1024.0));
+    bench_ints(inputs[0].buf, len, "convert_i64", int_convert);
+    bench_ints(inputs[0].buf, len, "json_convert", int_double);
+    bench_ints(inputs[0].buf, len, "strtoll", int_strtoll);
+    free(inputs[0].buf);
+    return 0;
+}
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stddef.h>
 
 #define test_section(desc) \
     do { \
@@ -38,6 +39,108 @@
         printf("======================================================\n"); \
     } while (0)
 
+struct stream_log {char buf[512]; int len; int stop;};
+static int
+stream_record(void *usr, enum json_stream_event ev, const struct json_token *tok, int depth)
+{
+    /* appends "<event><depth>:<token>" for every callback */
+    struct stream_log *log = (struct stream_log*)usr;
+    static const char ev_names[] = "BEKV";
+    int i;
+    if (log->len + tok->len + 4 > (int)sizeof(log->buf)) return 1;
+    log->buf[log->len++] = ev_names[ev];
+    log->buf[log->len++] = (char)('0' + depth);
+    log->buf[log->len++] = ':';
+    for (i = 0; i < tok->len; ++i)
+        log->buf[log->len++] = tok->str[i];
+    log->buf[log->len++] = ' ';
+    log->buf[log->len] = 0;
+    return log->stop && log->len >= log->stop;
+}
+
+struct write_log {char buf[512]; int len; int calls; int stop;};
+static int
+write_collect(void *usr, const char *buf, int len)
+{
+    /* gathers flushed output, fails after stop calls if set */
+    struct write_log *log = (struct write_log*)usr;
+    if (log->stop && log->calls >= log->stop) return 1;
+    memcpy(log->buf + log->len, buf, (size_t)len);
+    log->len += len;
+    log->buf[log->len] = 0;
+    log->calls++;
+    return 0;
+}
+
+static void
+run_reverse(void *usr, json_task task, void *arg, int cnt)
+{
+    /* runs parts back to front to catch order dependencies */
+    int i;
+    for (i = cnt - 1; i >= 0; --i)
+        task(arg, i);
+    (*(int*)usr)++;
+}
+struct arena {char buf[1 << 15]; int used, last, allocs, grows;};
+static void*
+arena_alloc(void *usr, int size)
+{
+    struct arena *a = (struct arena*)usr;
+    size = (size + 15) & ~15;
+    if (size > (int)sizeof(a->buf) - a->used) return NULL;
+    a->last = a->used;
+    a->used += size;
+    a->allocs++;
+    return a->buf + a->last;
+}
+static void*
+arena_grow(void *usr, void *mem, int size, int new_size)
+{
+    /* only the last block grows in place */
+    struct arena *a = (struct arena*)usr;
+    char *m = (char*)arena_alloc(usr, new_size);
+    a->grows++;
+    if ((char*)mem == a->buf + a->last && m) {
+        a->used = a->last;
+        m = (char*)arena_alloc(usr, new_size);
+    } else if (m) memcpy(m, mem, (size_t)size);
+    return m;
+}
+struct select_log {char buf[512]; int len; int cnt; int stop;};
+static int
+select_record(void *usr, struct json_token *tok)
+{
+    /* appends the text of every match followed by a space */
+    struct select_log *log = (struct select_log*)usr;
+    int i;
+    if (log->len + tok->len + 2 > (int)sizeof(log->buf)) return 1;
+    for (i = 0; i < tok->len; ++i)
+        log->buf[log->len++] = tok->str[i];
+    log->buf[log->len++] = ' ';
+    log->buf[log->len] = 0;
+    return log->stop && ++log->cnt >= log->stop;
+}
+static int
+select_run(struct select_log *log, struct json_token *toks, int count, const char *query)
+{
+    struct json_select sel;
+    memset(log, 0, sizeof(*log));
+    if (!json_select_compile(&sel, query)) return -1;
+    return json_select(toks, count, &sel, select_record, log);
+}
+
+struct vec3 {float x, y, z;};
+struct entity {
+    json_int id;
+    json_uint mask;
+    int hp;
+    json_number speed;
+    int alive;
+    char name[8];
+    struct json_token tags;
+    struct vec3 pos;
+};
+
 static int run_test(void)
 {
     int pass_count = 0;
@@ -565,7 +668,7 @@ static int run_test(void)
 
     test_section("parse")
     {
-        /* Beware parser take about sizeof(struct json_iter) * JSON_MAX_DEPTH bytes of memory */
+        /* parser keeps sizeof(struct json_iter) * JSON_PARSER_DEPTH bytes of stack inline */
         const char buf[] = "{\"sub\":{\"a\": \"b\"}, \"list\":[1,2,3,4], \"a\":true, \"b\": \"0a1b2\"}";
         struct json_parser p = {0};
         while (json_load(&p, buf, sizeof(buf)))
@@ -1075,7 +1178,1402 @@ static int run_test(void)
                 elm = json_obj_next(elm);
             }}
         }}
+        {struct json_parser p = {0};
+        const char doc[] = "{\"a\":[1,2],\"b\":{\"c\":{}},\"d\":3}";
+        /* values that are objects or arrays are stepped over as a whole */
+        p.toks = toks; p.cap = 256;
+        json_load(&p, doc, sizeof(doc) - 1);
+        test_assert(p.err == JSON_OK && p.cnt == 10);
+        test_assert(json_obj_next(&toks[0]) == &toks[4]);
+        test_assert(json_obj_next(&toks[4]) == &toks[8]);
+        test_assert(json_obj_next(&toks[8]) == &toks[10]);}
+    }
+    test_section("index_load")
+    {
+        int i, n;
+        int idx[128];
+        struct json_token toks[128];
+        struct json_token ref[128];
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"te\\\"st\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"t\u00e4st\", true, false, null, 10]}";
+
+        memset(ref, 0, sizeof(ref));
+        {struct json_parser p = {0};
+        p.toks = ref; p.cap = 128;
+        json_load(&p, buf, sizeof(buf));
+        test_assert(p.err == JSON_OK);
+
+        n = json_index(idx, 128, buf, sizeof(buf));
+        test_assert(n > 0 && n <= 128);
+        test_assert(json_index(NULL, 0, buf, sizeof(buf)) == n);
+
+        {struct json_parser q = {0};
+        q.toks = toks; q.cap = 128;
+        test_assert(json_load_index(&q, buf, sizeof(buf), idx, n) == 0);
+        test_assert(q.err == JSON_OK);
+        test_assert(q.cnt == p.cnt);
+        for (i = 0; i < p.cnt && i < q.cnt; ++i) {
+            if (toks[i].str != ref[i].str || toks[i].len != ref[i].len ||
+                toks[i].type != ref[i].type || toks[i].children != ref[i].children ||
+                toks[i].sub != ref[i].sub) break;
+        } test_assert(i == p.cnt);
+        test_assert(json_query(toks, q.cnt, "a[1][3]") == &toks[31]);}}
+
+        {struct json_parser q = {0};
+        q.toks = toks; q.cap = 4;
+        test_assert(json_load_index(&q, buf, sizeof(buf), idx, n) == 1);
+        test_assert(q.err == JSON_OUT_OF_TOKEN);
+        test_assert(q.cap == 37);}
+    }
+    test_section("index_invalid")
+    {
+        int n;
+        int idx[32];
+        struct json_token toks[32];
+        const char *bufs[] = {"[\"Extra close\"]]", "{\"a\":1",
+            "{\"a\":[1,2}", "{\"a\":#}", "{\"a\":1:2}"};
+        const char *strs[] = {"{\"a\":\"\\q\"}", "{\"a\":\"\x01\"}",
+            "{\"a\":\"\xc3\"}", "{\"a\":\"\xff\"}",
+            "{\"a\":\"abc", "{\"a\":tr\"ue}"};
+        int i;
+        for (i = 0; i < (int)(sizeof(bufs)/sizeof(bufs[0])); ++i) {
+            struct json_parser p = {0};
+            p.toks = toks; p.cap = 32;
+            n = json_index(idx, 32, bufs[i], (int)strlen(bufs[i]));
+            test_assert(n > 0);
+            json_load_index(&p, bufs[i], (int)strlen(bufs[i]), idx, n);
+            test_assert(p.err == JSON_PARSING_ERROR);
+        }
+        for (i = 0; i < (int)(sizeof(strs)/sizeof(strs[0])); ++i)
+            test_assert(json_index(idx, 32, strs[i], (int)strlen(strs[i])) < 0);
+    }
+    test_section("tape_load")
+    {
+        int i;
+        struct json_token toks[128];
+        struct json_token ref[128];
+        const char buf[] =
+        "{\"map\":{"
+            "\"entity\":["
+                "{\"position\": {\"x\":1, \"y\":1}, \"size\":{\"w\":1,\"h\":1}},"
+                "{\"position\": {\"x\":2, \"y\":2}, \"size\":{\"w\":2,\"h\":2}},"
+                "{\"position\": {\"x\":3, \"y\":3}, \"size\":{\"w\":3,\"h\":3}},"
+                "{\"position\": {\"x\":4, \"y\":4}, \"size\":{\"w\":4,\"h\":4}},"
+                "{\"position\": {\"x\":5, \"y\":5}, \"size\":{\"w\":5,\"h\":5}}"
+            "]"
+        "}}";
+
+        memset(ref, 0, sizeof(ref));
+        {struct json_parser p = {0};
+        p.toks = ref; p.cap = 128;
+        json_load(&p, buf, sizeof(buf));
+        test_assert(p.err == JSON_OK);
+
+        {struct json_parser q = {0};
+        q.toks = toks; q.cap = 128;
+        test_assert(json_load_tape(&q, buf, sizeof(buf)) == 0);
+        test_assert(q.err == JSON_OK);
+        test_assert(q.cnt == p.cnt);
+        for (i = 0; i < p.cnt && i < q.cnt; ++i) {
+            if (toks[i].str != ref[i].str || toks[i].len != ref[i].len ||
+                toks[i].type != ref[i].type || toks[i].children != ref[i].children ||
+                toks[i].sub != ref[i].sub) break;
+        } test_assert(i == p.cnt);
+        test_assert(json_query(toks, q.cnt, "map.entity[4].size.w") == &toks[66]);}}
+
+        {struct json_parser q = {0};
+        while (json_load_tape(&q, buf, sizeof(buf)))
+            q.toks = (struct json_token*)realloc(q.toks, (size_t)q.cap * sizeof(struct json_token));
+        test_assert(q.err == JSON_OK);
+        test_assert(q.cnt == 69);
+        free(q.toks);}
+
+        {struct json_parser q = {0};
+        const char bad[] = "[\"Extra close\"]]";
+        q.toks = toks; q.cap = 128;
+        json_load_tape(&q, bad, sizeof(bad));
+        test_assert(q.err == JSON_PARSING_ERROR);}
+    }
+    test_section("exact_load")
+    {
+        const char buf[] =
+            "{\"sub\":{\"a\": \"b\"}, \"list\":[1,2,3,4], \"a\":true, \"b\": \"0a1b2\"}";
+        const char buf2[] = "{\"coord\":[[[1,2], [3,4], [5,6]]]}";
+        const char buf3[] = "[{\"a\":\"[\\\"]\"}, {}, [[]]] ";
+        int loops = 0;
+        struct json_parser p = {0};
+
+        test_assert(json_count(buf, sizeof(buf)) == 14);
+        test_assert(json_count(buf2, sizeof(buf2)) == 12);
+        test_assert(json_count(buf3, sizeof(buf3)) == 6);
+        test_assert(json_count("{\"a\":\"x", 7) < 0);
+
+        while (json_load_exact(&p, buf, sizeof(buf))) {
+            p.toks = (struct json_token*)realloc(p.toks, (size_t)p.cap * sizeof(struct json_token));
+            loops++;
+        }
+        test_assert(loops == 1);
+        test_assert(p.cap == 14);
+        test_assert(p.err == JSON_OK);
+        test_assert(p.cnt == 14);
+        test_token(&p.toks[5], "[1,2,3,4]", JSON_ARRAY, 4, 4);
+        free(p.toks);
+    }
+    test_section("map_query")
+    {
+        int i;
+        int mem[512];
+        json_number num;
+        struct json_map m;
+        struct json_token toks[128];
+        const char buf[] =
+        "{\"map\":{"
+            "\"entity\":["
+                "{\"position\": {\"x\":1, \"y\":1}, \"size\":{\"w\":1,\"h\":1}},"
+                "{\"position\": {\"x\":2, \"y\":2}, \"size\":{\"w\":2,\"h\":2}},"
+                "{\"position\": {\"x\":3, \"y\":3}, \"size\":{\"w\":3,\"h\":3}},"
+                "{\"position\": {\"x\":4, \"y\":4}, \"size\":{\"w\":4,\"h\":4}},"
+                "{\"position\": {\"x\":5, \"y\":5}, \"size\":{\"w\":5,\"h\":5}}"
+            "],"
+            "\"list\": [[1,2],[3,[4,5]]], \"x\":1, \"x\":2"
+        "}}";
+
+        memset(toks, 0,  sizeof(toks));
+        {struct json_parser p = {0};
+        p.toks = toks; p.cap = 128;
+        json_load(&p, buf, sizeof(buf));
+        test_assert(p.err == JSON_OK);
+
+        test_assert(json_map_size(toks, p.cnt) <= 512);
+        test_assert(!json_map_build(&m, toks, p.cnt, mem, 8));
+        test_assert(json_map_build(&m, toks, p.cnt, mem, 512));
+        test_assert(json_map_query(&m, "map") == &toks[1]);
+        test_assert(json_map_query(&m, "map.entity") == &toks[3]);
+        for (i = 0; i < 5; ++i) {
+            char path[48];
+            sprintf(path, "map.entity[%d].position.x", i);
+            test_assert(json_map_query(&m, path) == json_query(toks, p.cnt, path));
+            test_assert(json_map_query_number(&num, &m, path) == JSON_NUMBER);
+            test_assert(num == (json_number)(i + 1));
+            sprintf(path, "map.entity[%d].size.h", i);
+            test_assert(json_map_query(&m, path) == json_query(toks, p.cnt, path));
+        }
+        test_assert(json_map_query(&m, "map.list[1][1][0]") == json_query(toks, p.cnt, "map.list[1][1][0]"));
+        test_assert(json_map_query(&m, "map.x") == json_query(toks, p.cnt, "map.x"));
+        test_assert(json_map_query(&m, "map.entity[5]") == NULL);
+        test_assert(json_map_query(&m, "map.entity[]") == json_query(toks, p.cnt, "map.entity[]"));
+        test_assert(json_map_query(&m, "map.entity[]") == NULL);
+        test_assert(json_map_query(&m, "map.entity[4294967297]") == NULL);
+        test_assert(json_map_query(&m, "map.entity[99999999999999999999]") == NULL);
+        test_assert(json_map_query(&m, "map.test") == NULL);
+        test_assert(json_map_query(&m, "map[0]") == NULL);
+        test_assert(json_map_query_number(&num, &m, "map.entity") == JSON_ARRAY);
+        {struct json_token *e = json_map_query(&m, "map.entity[2]");
+        test_assert(json_map_find(&m, e, "size", 4) == &toks[38]);
+        test_assert(json_map_at(&m, &toks[3], 4) == &toks[56]);}}
+        {struct json_token t[16];
+        struct json_parser q;
+        struct json_map em;
+        int emem[64];
+        const char doc[] = "{\"\": 1, \"o\": {\"x\": 2, \"\": 3}}";
+        /* empty keys are valid keys */
+        memset(&q, 0, sizeof(q));
+        q.toks = t; q.cap = 16;
+        json_load(&q, doc, sizeof(doc) - 1);
+        test_assert(q.err == JSON_OK && q.cnt == 8);
+        test_assert(json_map_build(&em, t, q.cnt, emem, 64));
+        test_assert(json_map_find(&em, NULL, "", 0) == &t[1]);
+        test_assert(json_map_find(&em, &t[3], "", 0) == &t[7]);
+        test_assert(json_map_find(&em, &t[3], "x", 1) == &t[5]);}
+    }
+    test_section("query_compiled")
+    {
+        int i, mem[256];
+        char buffer[64];
+        int size;
+        json_number num;
+        struct json_map m;
+        struct json_path path;
+        struct json_token toks[128];
+        const char *paths[] = {"b", "b.a", "b.a.b", "b.b", "b.b[3]", "b.c", "b.d",
+            "b.g", "a[0]", "a[0].b", "a[1]", "a[1][0]", "a[1][3]", "a[2]", "a[6]",
+            "a[7]", "b.h", "c", "a.b", "b[0]", "b.b[4]"};
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+
+        memset(toks, 0,  sizeof(toks));
+        {struct json_parser p = {0};
+        p.toks = toks; p.cap = 128;
+        json_load(&p, buf, sizeof(buf));
+        test_assert(p.err == JSON_OK);
+        test_assert(json_map_build(&m, toks, p.cnt, mem, 256));
+
+        for (i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i) {
+            struct json_token *ref = json_query(toks, p.cnt, paths[i]);
+            test_assert(json_path_compile(&path, paths[i]));
+            test_assert(json_query_compiled(toks, p.cnt, &path) == ref);
+            test_assert(json_map_query_compiled(&m, &path) == ref);
+        }
+        test_assert(json_path_compile(&path, "a[1][3]"));
+        test_assert(path.cnt == 3);
+        test_assert(path.seg[1].index == 1 && path.seg[2].index == 3);
+        test_assert(json_query_compiled_number(&num, toks, p.cnt, &path) == JSON_NUMBER);
+        test_assert(num == 4.0);
+        test_assert(json_path_compile(&path, "b.c"));
+        test_assert(json_query_compiled_string(buffer, 64, &size, toks, p.cnt, &path) == JSON_STRING);
+        test_assert(!strcmp(buffer, "test"));
+        test_assert(!json_path_compile(&path, "a[x]"));
+        test_assert(!json_path_compile(&path, "a[1"));
+        test_assert(!json_path_compile(&path, "a[]"));
+        test_assert(!json_path_compile(&path, "a[4294967297]"));
+        test_assert(!json_path_compile(&path, "a[99999999999999999999]"));
+        test_assert(json_path_compile(&path, "a[2147483647]") && path.seg[1].index == 2147483647);
+        test_assert(!json_path_compile(&path, "a.b.c.d.e.f.g.h.i.j.k.l.m.n.o.p.q"));}
+    }
+    test_section("query_many")
+    {
+        int i, n;
+        struct json_path paths[70];
+        struct json_token *out[70];
+        struct json_token toks[128];
+        const char *strs[] = {"b", "b.a", "b.a.b", "b.b", "b.b[3]", "b.c", "b.d",
+            "b.g", "a[0]", "a[0].b", "a[1]", "a[1][0]", "a[1][3]", "a[2]", "a[6]",
+            "a[7]", "b.h", "c", "a.b", "b[0]", "b.b[4]", "b.b[0]", "a[1][1]"};
+        const int num = (int)(sizeof(strs)/sizeof(strs[0]));
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+
+        memset(toks, 0,  sizeof(toks));
+        {struct json_parser p = {0};
+        p.toks = toks; p.cap = 128;
+        json_load(&p, buf, sizeof(buf));
+        test_assert(p.err == JSON_OK);
 
+        for (i = 0; i < 70; ++i)
+            json_path_compile(&paths[i], strs[(i * 7) % num]);
+        n = json_query_many(out, toks, p.cnt, paths, 70);
+        for (i = 0; i < 70; ++i) {
+            if (out[i] != json_query(toks, p.cnt, strs[(i * 7) % num]))
+                break;
+            if (out[i]) n--;
+        }
+        test_assert(i == 70);
+        test_assert(n == 0);}
+    }
+    test_section("convert_exact")
+    {
+        int i;
+        json_number num;
+        struct json_token tok;
+        const char *strs[] = {"0.1", "-0.3", "1e23", "9007199254740993", "18446744073709551615",
+            "2.2250738585072011e-308", "4.9e-324", "1.7976931348623157e308", "123456789e-30",
+            "1.00000000000000011102230246251565404236316680908203125",
+            "1.00000000000000011102230246251565404236316680908203126",
+            "123456789012345678901234567890", "2.4703282292062328e-324", "0.000001e6", "1 2"};
+        const json_number vals[] = {0.1, -0.3, 1e23, 9007199254740992.0, 18446744073709551615.0,
+            2.2250738585072011e-308, 4.9e-324, 1.7976931348623157e308, 123456789e-30,
+            1.0, 1.0000000000000002, 123456789012345678901234567890.0, 4.9e-324, 1.0, 1.0};
+        for (i = 0; i < (int)(sizeof(strs)/sizeof(strs[0])); ++i) {
+            tok.str = strs[i]; tok.len = (int)strlen(strs[i]);
+            test_assert(json_convert(&num, &tok) == JSON_NUMBER && num == vals[i]);
+        }
+        tok.str = "1e400"; tok.len = 5;
+        test_assert(json_convert(&num, &tok) == JSON_NUMBER && num > 1.7976931348623157e308);
+        tok.str = "-1e-400"; tok.len = 7;
+        test_assert(json_convert(&num, &tok) == JSON_NUMBER && num == 0.0);
+        tok.str = "1.5e"; tok.len = 4;
+        test_assert(json_convert(&num, &tok) == JSON_NONE);
+        tok.str = "-"; tok.len = 1;
+        test_assert(json_convert(&num, &tok) == JSON_NONE);
+        tok.str = "1x"; tok.len = 2;
+        test_assert(json_convert(&num, &tok) == JSON_NONE);
+    }
+    test_section("convert_int")
+    {
+        json_int i;
+        json_uint u;
+        struct json_token tok;
+        tok.str = "9007199254740993"; tok.len = 16;
+        test_assert(json_convert_i64(&i, &tok) == JSON_NUMBER && i == 9007199254740993ll);
+        tok.str = "-9223372036854775808"; tok.len = 20;
+        test_assert(json_convert_i64(&i, &tok) == JSON_NUMBER && i == -9223372036854775807ll - 1);
+        tok.str = "9223372036854775808"; tok.len = 19;
+        test_assert(json_convert_i64(&i, &tok) == JSON_NONE);
+        test_assert(json_convert_u64(&u, &tok) == JSON_NUMBER && u == 9223372036854775808ull);
+        tok.str = "18446744073709551615"; tok.len = 20;
+        test_assert(json_convert_u64(&u, &tok) == JSON_NUMBER && u == 18446744073709551615ull);
+        tok.str = "18446744073709551616"; tok.len = 20;
+        test_assert(json_convert_u64(&u, &tok) == JSON_NONE);
+        tok.str = "000000000000000000000042"; tok.len = 24;
+        test_assert(json_convert_u64(&u, &tok) == JSON_NUMBER && u == 42);
+        tok.str = "-1"; tok.len = 2;
+        test_assert(json_convert_u64(&u, &tok) == JSON_NONE);
+        test_assert(json_convert_i64(&i, &tok) == JSON_NUMBER && i == -1);
+        tok.str = "12.5"; tok.len = 4;
+        test_assert(json_convert_i64(&i, &tok) == JSON_NONE);
+        tok.str = "1e3"; tok.len = 3;
+        test_assert(json_convert_i64(&i, &tok) == JSON_NONE);
+        tok.str = "-"; tok.len = 1;
+        test_assert(json_convert_i64(&i, &tok) == JSON_NONE);
+        {struct json_token toks[16];
+        struct json_parser p = {0};
+        const char buf[] = "{\"id\":1234567890123456789,\"n\":[5,-17],\"s\":\"x\",\"f\":0.5}";
+        p.toks = toks; p.cap = 16;
+        json_load(&p, buf, sizeof(buf));
+        test_assert(p.err == JSON_OK);
+        test_assert(json_query_int(&i, toks, p.cnt, "id") == JSON_NUMBER && i == 1234567890123456789ll);
+        test_assert(json_query_int(&i, toks, p.cnt, "n[1]") == JSON_NUMBER && i == -17);
+        test_assert(json_query_int(&i, toks, p.cnt, "s") == JSON_STRING);
+        test_assert(json_query_int(&i, toks, p.cnt, "f") == JSON_NONE);
+        test_assert(json_query_int(&i, toks, p.cnt, "x") == JSON_NONE);}
+    }
+    test_section("stream")
+    {
+        int i, k;
+        struct json_stream s;
+        struct stream_log log;
+        const char buf[] = "{\"name\" : \"a\\\"b\\u00e9\", \"$\xc2\xa2\xe2\x82\xac\xf0\xa4\xaa\xa4\":"
+            "[1.5e3, -12, true, null, {\"x\":[]}], \"n\":1234567}";
+        const char *expect = "B0:{ K1:name V1:a\\\"b\\u00e9 K1:$\xc2\xa2\xe2\x82\xac\xf0\xa4\xaa\xa4 "
+            "B1:[ V2:1.5e3 V2:-12 V2:true V2:null B2:{ K3:x B3:[ E3:] E2:} E1:] K1:n V1:1234567 E0:} ";
+        const int n = (int)sizeof(buf) - 1;
+        for (k = 1; k <= n; ++k) {
+            memset(&log, 0, sizeof(log));
+            json_stream_begin(&s, stream_record, &log);
+            for (i = 0; i < n; i += k)
+                json_stream_feed(&s, buf + i, (i + k > n) ? n - i : k);
+            if (json_stream_end(&s) != JSON_OK || strcmp(log.buf, expect))
+                break;
+        }
+        test_assert(k == n + 1);
+
+        memset(&log, 0, sizeof(log));
+        json_stream_begin(&s, stream_record, &log);
+        test_assert(json_stream_feed(&s, "5 [tr", 5) == JSON_OK);
+        test_assert(json_stream_feed(&s, "ue] 7", 5) == JSON_OK);
+        test_assert(json_stream_end(&s) == JSON_OK);
+        test_assert(!strcmp(log.buf, "V0:5 B0:[ V1:true E0:] V0:7 "));
+
+        json_stream_begin(&s, stream_record, &log);
+        test_assert(json_stream_feed(&s, "{\"a\":[1}", 8) == JSON_PARSING_ERROR);
+        json_stream_begin(&s, stream_record, &log);
+        test_assert(json_stream_feed(&s, "{\"a\":\"\xc2", 7) == JSON_OK);
+        test_assert(json_stream_feed(&s, "x\"}", 3) == JSON_PARSING_ERROR);
+        json_stream_begin(&s, stream_record, &log);
+        test_assert(json_stream_feed(&s, "[\"abc", 5) == JSON_OK);
+        test_assert(json_stream_end(&s) == JSON_PARSING_ERROR);
+
+        memset(&log, 0, sizeof(log));
+        log.stop = 1;
+        json_stream_begin(&s, stream_record, &log);
+        test_assert(json_stream_feed(&s, buf, n) == JSON_ABORTED);
+        test_assert(json_stream_feed(&s, buf, n) == JSON_ABORTED);
+    }
+    test_section("lines")
+    {
+        int i, n, cuts[4];
+        struct json_lines l;
+        const char buf[] = "{\"a\":1}\n\n  \r\n{\"a\":[1,2]}\r\n[\"x\"]\n{\"b\n5";
+        const int len = (int)sizeof(buf) - 1;
+
+        memset(&l, 0, sizeof(l));
+        for (i = 0; json_load_lines(&l, buf, len) && i < 4; ++i) {
+            l.recs = (struct json_record*)realloc(l.recs, (size_t)l.cap * sizeof(struct json_record));
+            l.toks = (struct json_token*)realloc(l.toks, (size_t)l.size * sizeof(struct json_token));
+        }
+        test_assert(i == 1);
+        test_assert(l.err == JSON_OK);
+        test_assert(l.cnt == 5 && l.used == 8);
+        test_assert(l.recs[0].cnt == 2 && !json_cmp(&l.recs[0].toks[1], "1"));
+        test_assert(l.recs[1].len == 12 && l.recs[1].cnt == 4);
+        test_assert(!json_cmp(json_query(l.recs[1].toks, l.recs[1].cnt, "a[1]"), "2"));
+        test_assert(l.recs[2].cnt == 1 && l.recs[2].toks[0].type == JSON_STRING);
+        test_assert(l.recs[3].err == JSON_PARSING_ERROR && l.recs[3].cnt == 0);
+        test_assert(l.recs[4].cnt == 1 && l.recs[4].toks[0].type == JSON_NUMBER);
+
+        /* parts at record boundaries load to the same records */
+        test_assert(json_lines_split(cuts, 3, buf, len) == 3);
+        for (i = 0, n = 0; i < 3; ++i) {
+            struct json_lines part;
+            memset(&part, 0, sizeof(part));
+            test_assert(cuts[i] == 0 || buf[cuts[i]-1] == '\n');
+            json_load_lines(&part, buf + cuts[i], cuts[i+1] - cuts[i]);
+            n += part.cap;
+        }
+        test_assert(n == 5);
+        free(l.recs);
+        free(l.toks);
+    }
+    test_section("compact")
+    {
+        int i, size;
+        char buffer[64];
+        json_number num;
+        struct json_compact c;
+        struct json_ctoken ctoks[64], *ct;
+        struct json_token toks[64];
+        const char *paths[] = {"b.a.b", "b.b[3]", "b.c", "a[1][2]", "a[0].b", "a[6]", "b.x", "a[9]"};
+        const char buf[] = "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"test\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}";
+        struct json_parser p;
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        json_load(&p, buf, sizeof(buf));
+        test_assert(sizeof(struct json_ctoken) == 16);
+
+        memset(&c, 0, sizeof(c));
+        test_assert(json_load_compact(&c, buf, sizeof(buf)) == 1);
+        test_assert(c.err == JSON_OUT_OF_TOKEN && c.cap == p.cnt);
+        memset(&c, 0, sizeof(c));
+        test_assert(json_load_compact(&c, "{\"a\":\"x", 7) == 0);
+        test_assert(c.err == JSON_PARSING_ERROR && c.cap == 0);
+        c.cap = p.cnt;
+        c.toks = ctoks;
+        test_assert(json_load_compact(&c, buf, sizeof(buf)) == 0);
+        test_assert(c.err == JSON_OK && c.cnt == p.cnt);
+        for (i = 0; i < c.cnt; ++i) {
+            struct json_token t = json_compact_token(&c, &ctoks[i]);
+            if (t.str != toks[i].str || t.len != toks[i].len || t.type != toks[i].type ||
+                t.children != toks[i].children || t.sub != toks[i].sub) break;
+        }
+        test_assert(i == c.cnt);
+        for (i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i) {
+            struct json_token *ref = json_query(toks, p.cnt, paths[i]);
+            ct = json_compact_query(&c, ctoks, c.cnt, paths[i]);
+            test_assert(ref ? (ct == ctoks + (ref - toks)) : !ct);
+        }
+        test_assert(json_compact_query_number(&num, &c, ctoks, c.cnt, "b.g") == JSON_NUMBER);
+        test_assert(num == 10.0);
+        test_assert(json_compact_query_string(buffer, 64, &size, &c, ctoks, c.cnt, "a[2]") == JSON_STRING);
+        test_assert(!strcmp(buffer, "test"));
+        ct = json_compact_query(&c, ctoks, c.cnt, "a");
+        test_assert(json_compact_type(ct) == JSON_ARRAY && json_compact_children(ct) == 7);
+        ct = json_compact_array_begin(ct);
+        for (i = 0; i < 6; ++i)
+            ct = json_compact_array_next(ct);
+        test_assert(json_compact_type(ct) == JSON_NUMBER && ct->len == 2);
+        ct = json_compact_obj_begin(json_compact_query(&c, ctoks, c.cnt, "b"));
+        test_assert(json_compact_obj_next(json_compact_obj_next(ct))->len == 1);
+    }
+    test_section("map_arrays")
+    {
+        int i, n, size, mem[512];
+        const int *elms;
+        struct json_map m;
+        struct json_path path;
+        struct json_token toks[256], *arr;
+        const char *paths[] = {"a[0].b", "a[1][3]", "a[6]", "b.b[2]", "b.a.b", "c[99]",
+            "c[100]", "b.x", "a[7]"};
+        char buf[1024];
+        struct json_parser p;
+        int len = sprintf(buf, "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4]},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10], \"c\":[");
+        for (i = 0; i < 100; ++i)
+            len += sprintf(buf + len, "%s%d", i ? "," : "", i * 3);
+        len += sprintf(buf + len, "]}");
+
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 256;
+        json_load(&p, buf, len);
+        test_assert(p.err == JSON_OK);
+        size = json_map_arrays_size(toks, p.cnt);
+        test_assert(size < json_map_size(toks, p.cnt));
+        test_assert(!json_map_build_arrays(&m, toks, p.cnt, mem, size - 1));
+        test_assert(json_map_build_arrays(&m, toks, p.cnt, mem, size));
+        for (i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i) {
+            struct json_token *ref = json_query(toks, p.cnt, paths[i]);
+            test_assert(json_map_query(&m, paths[i]) == ref);
+            test_assert(json_path_compile(&path, paths[i]));
+            test_assert(json_map_query_compiled(&m, &path) == ref);
+        }
+        arr = json_query(toks, p.cnt, "c");
+        elms = json_map_elements(&m, arr, &n);
+        test_assert(elms && n == 100);
+        for (i = 0; i < n; ++i)
+            if (elms[i] != (int)(arr - toks) + 1 + i) break;
+        test_assert(i == 100);
+        test_assert(!json_cmp(json_map_at(&m, arr, 99), "297"));
+        test_assert(json_map_elements(&m, json_query(toks, p.cnt, "b"), &n) == NULL);
+    }
+    test_section("cursor")
+    {
+        int i, n, len;
+        struct json_cursor c;
+        struct json_token key, val, *ref;
+        struct json_parser p;
+        struct json_token toks[1024];
+        const char *paths[] = {"a[0].b", "a[1][3]", "a[6]", "b.b[2]", "b.a.b", "c[99]",
+            "d", "e.f", "c[100]", "b.x", "a[7]", "x.y"};
+        char buf[4096];
+        len = sprintf(buf, "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4]},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"te]}\\\"st\", true, false, null, 10], \"c\":[");
+        for (i = 0; i < 100; ++i)
+            len += sprintf(buf + len, "%s[{\"s\":\"%d}\"}]", i ? "," : "", i * 3);
+        len += sprintf(buf + len, "], \"d\": \"x\", \"e\": {\"f\": -1.5e3}}");
+
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 1024;
+        json_load(&p, buf, len);
+        test_assert(p.err == JSON_OK);
+        test_assert(!json_cursor_begin(&c, buf, len));
+        for (i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i) {
+            ref = json_query(toks, p.cnt, paths[i]);
+            n = json_cursor_query(&c, &val, paths[i]);
+            test_assert(n == (ref != NULL));
+            test_assert(!n || (val.str == ref->str && val.type == ref->type));
+            test_assert(!n || val.len == ref->len || val.len == 1);
+            test_assert(c.err == JSON_OK);
+        }
+
+        /* iterate, skip and enter */
+        test_assert(json_cursor_query(&c, &val, "c") && val.type == JSON_ARRAY);
+        test_assert(!json_cursor_skip(&c, &val));
+        ref = json_query(toks, p.cnt, "c");
+        test_assert(val.str == ref->str && val.len == ref->len);
+        test_assert(json_cursor_next(&c, &key, &val) && !json_cmp(&key, "d") && !json_cmp(&val, "x"));
+        test_assert(json_cursor_query(&c, &val, "c[98]") && !json_cursor_enter(&c));
+        test_assert(json_cursor_next(&c, &key, &val) && key.type == JSON_NONE);
+        test_assert(!json_cursor_enter(&c) && json_cursor_find(&c, &val, "s", 1));
+        test_assert(!json_cmp(&val, "294}"));
+        test_assert(!json_cursor_leave(&c) && !json_cursor_leave(&c) && c.depth == 2);
+        test_assert(json_cursor_next(&c, NULL, &val) && val.type == JSON_ARRAY);
+        test_assert(!json_cursor_leave(&c) && c.depth == 1);
+        test_assert(json_cursor_next(&c, &key, &val) && !json_cmp(&key, "d"));
+        test_assert(json_cursor_next(&c, &key, &val) && !json_cmp(&key, "e"));
+        test_assert(!json_cursor_next(&c, &key, &val) && c.err == JSON_OK);
+        test_assert(!json_cursor_leave(&c) && c.depth == 0 && c.cur == buf + len);
+        test_assert(json_cursor_enter(&c) == JSON_INVAL);
+
+        /* root without brackets and malformed input */
+        strcpy(buf, "\"a\": [1, {\"x\": 2}], \"b\": 3");
+        test_assert(!json_cursor_begin(&c, buf, (int)strlen(buf)));
+        test_assert(json_cursor_find(&c, &val, "b", 1) && !json_cmp(&val, "3"));
+        test_assert(!json_cursor_next(&c, &key, &val) && c.err == JSON_OK);
+        strcpy(buf, "{\"a\": [1, \"]\"], \"b\": 3}");
+        test_assert(!json_cursor_begin(&c, buf, (int)strlen(buf)));
+        test_assert(json_cursor_find(&c, &val, "b", 1) && !json_cmp(&val, "3"));
+        strcpy(buf, "{\"a\": [1, {\"x\": 2], \"b\": 3}");
+        test_assert(!json_cursor_begin(&c, buf, (int)strlen(buf)));
+        test_assert(!json_cursor_find(&c, &val, "b", 1) && c.err == JSON_PARSING_ERROR);
+        strcpy(buf, "{\"a\": \"1, \"b\": 3");
+        test_assert(!json_cursor_begin(&c, buf, (int)strlen(buf)));
+        test_assert(!json_cursor_find(&c, &val, "b", 1) && c.err == JSON_PARSING_ERROR);
+    }
+    test_section("unescape")
+    {
+        int i, n;
+        char out[256], buf[256];
+        struct json_token tok;
+        struct json_parser p;
+        struct json_token toks[8];
+        tok.type = JSON_STRING;
+        #define UNESC(s) (tok.str = (s), tok.len = (int)strlen(s), json_unescape(out, sizeof(out), &tok))
+        test_assert(UNESC("plain") == 5 && !strcmp(out, "plain"));
+        test_assert(UNESC("a\\nb\\t\\\"c\\\\\\/") == 8 && !strcmp(out, "a\nb\t\"c\\/"));
+        test_assert(UNESC("\\u0041\\u00e9\\u20AC") == 6 && !strcmp(out, "A\xc3\xa9\xe2\x82\xac"));
+        test_assert(UNESC("\\ud83d\\ude00!") == 5 && !strcmp(out, "\xf0\x9f\x98\x80!"));
+        test_assert(UNESC("\\ud800x\\udc00") == 7 && !strcmp(out, "\xef\xbf\xbdx\xef\xbf\xbd"));
+        test_assert(UNESC("\\x") == -1 && UNESC("\\u12g4") == -1 && UNESC("ab\\") == -1);
+        test_assert(UNESC("\\u12") == -1);
+
+        /* long clean runs around the escapes and truncated output */
+        for (i = 0; i < 150; ++i)
+            buf[i] = (char)('a' + i % 26);
+        memcpy(buf + 70, "\\n", 2);
+        buf[150] = 0;
+        test_assert(UNESC(buf) == 149 && out[70] == '\n' && out[71] == 'u' && out[148] == 't');
+        test_assert(json_unescape(NULL, 0, &tok) == 149);
+        test_assert(json_unescape(out, 72, &tok) == 149 && strlen(out) == 71 && out[70] == '\n');
+        test_assert(json_unescape(out, 1, &tok) == 149 && out[0] == 0);
+        #undef UNESC
+
+        /* string tokens keep their escapes until unescaped */
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 8;
+        n = sprintf(buf, "{\"k\\\"ey\": \"caf\\u00e9 \\\"x\\\"\"}");
+        test_assert(!json_load_tape(&p, buf, n) && p.err == JSON_OK);
+        test_assert(json_unescape(out, sizeof(out), &toks[0]) == 4 && !strcmp(out, "k\"ey"));
+        test_assert(json_unescape(out, sizeof(out), &toks[1]) == 9 && !strcmp(out, "caf\xc3\xa9 \"x\""));
+    }
+    test_section("utf8_blocks")
+    {
+        /* multi-byte sequences split across scanner blocks */
+        int i, n, at;
+        char buf[256];
+        struct json_parser p;
+        struct json_token toks[8];
+        const char *seq[] = {"\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xe2\x82", "\x82", "\xf8\x80"};
+        for (i = 0; i < 6; ++i) {
+            for (at = 58; at < 66; ++at) {
+                n = sprintf(buf, "{\"k\":\"");
+                while (n < at) buf[n++] = 'a';
+                n += sprintf(buf + n, "%s\"}", seq[i]);
+                memset(&p, 0, sizeof(p));
+                p.toks = toks; p.cap = 8;
+                json_load_tape(&p, buf, n);
+                test_assert((p.err == JSON_OK) == (i < 3));
+                memset(&p, 0, sizeof(p));
+                p.toks = toks; p.cap = 8;
+                json_load(&p, buf, n);
+                test_assert((p.err == JSON_OK) == (i < 3));
+            }
+        }
+    }
+    test_section("writer")
+    {
+        int i, n;
+        char buf[512], num[32], doc[64];
+        struct json_writer w;
+        struct write_log log;
+        struct json_parser p;
+        struct json_token toks[16];
+
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        json_write_object(&w);
+        json_write_key(&w, "name", 4);
+        json_write_string(&w, "a\"b\\c\n\x01", 7);
+        json_write_key(&w, "list", 4);
+        json_write_array(&w);
+        json_write_int(&w, -42);
+        json_write_number(&w, 0.1);
+        json_write_bool(&w, 1);
+        json_write_null(&w);
+        json_write_array(&w);
+        json_write_close(&w);
+        json_write_close(&w);
+        json_write_close(&w);
+        test_assert(json_write_end(&w) == JSON_OK);
+        test_assert(w.len == 56 && !memcmp(buf,
+            "{\"name\":\"a\\\"b\\\\c\\n\\u0001\",\"list\":[-42,0.1,true,null,[]]}", 56));
+
+        /* DEL is escaped so the output loads again, in and after SIMD blocks */
+        {char str[72], out[80];
+        memset(str, 'x', sizeof(str));
+        str[3] = str[40] = str[71] = 0x7F;
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        json_write_array(&w);
+        json_write_string(&w, str, 72);
+        json_write_string(&w, "a\x7f" "b", 3);
+        json_write_close(&w);
+        test_assert(json_write_end(&w) == JSON_OK && w.len == 74 + 15 + 3 + 9 + 1);
+        test_assert(!memcmp(buf, "[\"xxx\\u007fxx", 13) && !memchr(buf, 0x7F, (size_t)w.len));
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 16;
+        test_assert(!json_load(&p, buf, w.len) && p.err == JSON_OK && p.cnt == 2);
+        test_assert(json_unescape(out, sizeof(out), &toks[0]) == 72 && !memcmp(out, str, 72));
+        test_assert(json_unescape(out, sizeof(out), &toks[1]) == 3 && !memcmp(out, "a\x7f" "b", 3));
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 16;
+        test_assert(!json_load_tape(&p, buf, w.len) && p.err == JSON_OK && p.cnt == 2);}
+
+        /* shortest round trip formatting */
+        #define FMT(v) (json_write_begin(&w, num, sizeof(num), 0, 0), json_write_number(&w, v), num[w.len] = 0, num)
+        test_assert(!strcmp(FMT(0.0), "0") && !strcmp(FMT(-0.0), "-0"));
+        test_assert(!strcmp(FMT(1e23), "1e23") && !strcmp(FMT(1e21), "1e21"));
+        test_assert(!strcmp(FMT(1e20), "100000000000000000000"));
+        test_assert(!strcmp(FMT(1e-7), "1e-7") && !strcmp(FMT(1e-6), "0.000001"));
+        test_assert(!strcmp(FMT(5e-324), "5e-324"));
+        test_assert(!strcmp(FMT(1.7976931348623157e308), "1.7976931348623157e308"));
+        test_assert(!strcmp(FMT(-123.456), "-123.456") && !strcmp(FMT(9007199254740992.0), "9007199254740992"));
+        test_assert(!strcmp(FMT(HUGE_VAL), "null"));
+        for (i = 0, n = 0; i < 10000; ++i) {
+            double v = (double)(i * 7919 % 10007) / (double)(i % 97 + 1) * pow(10.0, i % 41 - 20);
+            n += strtod(FMT(v), 0) == v && strlen(num) <= 24;
+        }
+        test_assert(n == 10000);
+        #undef FMT
+
+        /* flushing through a buffer smaller than the output */
+        memset(&log, 0, sizeof(log));
+        json_write_begin(&w, buf, 8, write_collect, &log);
+        json_write_array(&w);
+        for (i = 0; i < 10; ++i)
+            json_write_string(&w, "0123456789abcdefghijklmnopqrstuvwxyz\t", 37);
+        json_write_close(&w);
+        test_assert(json_write_end(&w) == JSON_OK && log.len == 411 && log.calls > 40);
+        test_assert(!memcmp(log.buf, "[\"0123456789abcdefghijklmnopqrstuvwxyz\\t\",", 42));
+        test_assert(!memcmp(log.buf + 369, ",\"0123456789abcdefghijklmnopqrstuvwxyz\\t\"]", 42));
+
+        /* misuse and errors */
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        json_write_object(&w);
+        test_assert(json_write_int(&w, 1) == JSON_INVAL && json_write_close(&w) == JSON_INVAL);
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        test_assert(json_write_key(&w, "a", 1) == JSON_INVAL);
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        test_assert(json_write_close(&w) == JSON_INVAL);
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        json_write_array(&w);
+        test_assert(json_write_end(&w) == JSON_INVAL);
+        json_write_begin(&w, buf, 4, 0, 0);
+        test_assert(json_write_string(&w, "abcd", 4) == JSON_BUFFER_OVERFLOW);
+        memset(&log, 0, sizeof(log));
+        log.stop = 1;
+        json_write_begin(&w, buf, 4, write_collect, &log);
+        test_assert(json_write_string(&w, "abcdefgh", 8) == JSON_ABORTED);
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        for (i = 0; i < JSON_MAX_DEPTH; ++i)
+            json_write_array(&w);
+        test_assert(json_write_array(&w) == JSON_STACK_OVERFLOW);
+
+        /* root values and tokens re-emitted verbatim */
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        json_write_int(&w, 1);
+        json_write_int(&w, 2);
+        test_assert(w.len == 3 && !memcmp(buf, "1\n2", 3));
+
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 16;
+        n = sprintf(doc, "{\"a\\n\": [1, {\"b\": 2.50}], \"c\": \"x\\\"y\"}");
+        test_assert(!json_load_tape(&p, doc, n) && p.err == JSON_OK);
+        json_write_begin(&w, buf, sizeof(buf), 0, 0);
+        json_write_object(&w);
+        for (i = 0; i < p.cnt; i += toks[i].sub + 1)
+            json_write_token(&w, &toks[i]);
+        json_write_close(&w);
+        test_assert(json_write_end(&w) == JSON_OK);
+        test_assert(w.len == 35 && !memcmp(buf, "{\"a\\n\":[1, {\"b\": 2.50}],\"c\":\"x\\\"y\"}", 35));
+    }
+    test_section("parallel")
+    {
+        int i, k, n, rounds, same;
+        static char buf[2048];
+        static struct json_chunk parts[16];
+        static struct json_token toks[1024], ref[256];
+        struct json_parser p, q;
+
+        /* strings, escapes and containers crossing every kind of cut */
+        n = sprintf(buf, "{\"list\": [1, 2.5, \"a, \\\"b]\\\\\", {\"x\": [true, {}]}], \"text\": \"");
+        for (i = 0; i < 300; ++i)
+            buf[n++] = (i % 7) ? (char)('a' + i % 26) : (i % 2) ? ',' : '}';
+        n += sprintf(buf + n, "\", \"deep\": [[[[{\"k\": null}]]]], \"end\": -1}");
+        memset(&p, 0, sizeof(p));
+        p.toks = ref; p.cap = 256;
+        test_assert(!json_load_tape(&p, buf, n) && p.err == JSON_OK);
+        for (same = 0, k = 1; k <= 16; ++k) {
+            memset(&q, 0, sizeof(q));
+            rounds = 0;
+            if (json_load_parallel(&q, buf, n, parts, k, run_reverse, &rounds) != 1 ||
+                q.cap != p.cnt || q.err != JSON_OUT_OF_TOKEN) continue;
+            memset(toks, 0, sizeof(toks));
+            q.toks = toks;
+            if (json_load_parallel(&q, buf, n, parts, k, 0, 0) || q.err != JSON_OK ||
+                q.cnt != p.cnt) continue;
+            for (i = 0; i < p.cnt; ++i) {
+                if (toks[i].str != ref[i].str || toks[i].len != ref[i].len ||
+                    toks[i].type != ref[i].type || toks[i].children != ref[i].children ||
+                    toks[i].sub != ref[i].sub) break;
+            } same += (i == p.cnt && rounds >= 1 && rounds <= 2);
+        }
+        test_assert(same == 16);
+
+        /* errors found by a part or only when merging */
+        memset(&q, 0, sizeof(q));
+        q.toks = toks; q.cap = 256;
+        n = sprintf(buf, "[1, {\"a\": [2, 3}, 4]");
+        test_assert(!json_load_parallel(&q, buf, n, parts, 4, 0, 0) && q.err == JSON_PARSING_ERROR);
+        n = sprintf(buf, "[\"open, [1, 2, 3, 4, 5, 6]");
+        test_assert(!json_load_parallel(&q, buf, n, parts, 4, 0, 0) && q.err == JSON_PARSING_ERROR);
+        n = sprintf(buf, "[1, 2]], [3, 4, 5, 6, 7]");
+        test_assert(!json_load_parallel(&q, buf, n, parts, 4, 0, 0) && q.err == JSON_PARSING_ERROR);
+        for (n = 0; n < JSON_MAX_DEPTH + 1; ++n) buf[n] = '[';
+        for (i = 0; i < JSON_MAX_DEPTH + 1; ++i) buf[n++] = ']';
+        q.cap = 1024;
+        test_assert(!json_load_parallel(&q, buf, n, parts, 4, 0, 0) && q.err == JSON_STACK_OVERFLOW);
+    }
+    test_section("reload")
+    {
+        int i, n, m, same;
+        char old[256], buf[256];
+        struct json_token toks[64], ref[64];
+        struct json_parser p, q;
+
+        /* value edited inside a nested array, text copied */
+        n = sprintf(old, "{\"a\": [1, 2, {\"b\": \"x\"}], \"c\": [true], \"d\": 4}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load_tape(&p, old, n) && p.err == JSON_OK);
+        m = sprintf(buf, "{\"a\": [1, 2, {\"b\": \"x\", \"e\": [5, 6]}], \"c\": [true], \"d\": 4}");
+        test_assert(!json_reload(&p, old, buf, m, 22, 0, 15) && p.err == JSON_OK);
+        memset(&q, 0, sizeof(q));
+        q.toks = ref; q.cap = 64;
+        test_assert(!json_load_tape(&q, buf, m) && q.cnt == p.cnt);
+        for (i = 0, same = 0; i < q.cnt; ++i)
+            same += toks[i].str == ref[i].str && toks[i].len == ref[i].len &&
+                toks[i].type == ref[i].type && toks[i].children == ref[i].children &&
+                toks[i].sub == ref[i].sub;
+        test_assert(same == q.cnt);
+
+        /* edit in place that changes the structure falls back to the parent */
+        n = sprintf(old, "[[1, 2], [3]]");
+        p.err = JSON_OK; p.cap = 64;
+        test_assert(!json_load_tape(&p, old, n));
+        memcpy(old, "[[1], [2], [3]]", 16);
+        test_assert(!json_reload(&p, old, old, 15, 3, 2, 4) && p.err == JSON_OK);
+        test_assert(p.cnt == 6 && toks[0].len == 3 && toks[2].len == 3 && toks[4].children == 1);
+
+        /* not enough tokens leaves them untouched until the next call */
+        n = sprintf(old, "[[1], [2]]");
+        p.cap = 64;
+        test_assert(!json_load_tape(&p, old, n) && p.cnt == 4);
+        p.cap = 4;
+        memcpy(old, "[[1, 2, 3], [2]]", 17);
+        test_assert(json_reload(&p, old, old, 16, 3, 0, 6) == 1 && p.cap == 6 && p.cnt == 4);
+        test_assert(!json_reload(&p, old, old, 16, 3, 0, 6) && p.err == JSON_OK);
+        test_assert(p.cnt == 6 && toks[0].children == 3 && toks[4].str == old + 12);
+    }
+    test_section("decode_struct")
+    {
+        int n;
+        char buf[512];
+        struct entity e;
+        struct json_token toks[64];
+        struct json_parser p;
+        struct json_schema vs, es, ds;
+        const struct json_field vec[] = {
+            {"x", offsetof(struct vec3, x), JSON_FIELD_FLOAT, 0, NULL},
+            {"y", offsetof(struct vec3, y), JSON_FIELD_FLOAT, 0, NULL},
+            {"z", offsetof(struct vec3, z), JSON_FIELD_FLOAT, 0, NULL}};
+        const struct json_field ent[] = {
+            {"id", offsetof(struct entity, id), JSON_FIELD_INT, 0, NULL},
+            {"mask", offsetof(struct entity, mask), JSON_FIELD_UINT, 0, NULL},
+            {"hp", offsetof(struct entity, hp), JSON_FIELD_INT32, 0, NULL},
+            {"speed", offsetof(struct entity, speed), JSON_FIELD_NUMBER, 0, NULL},
+            {"alive", offsetof(struct entity, alive), JSON_FIELD_BOOL, 0, NULL},
+            {"name", offsetof(struct entity, name), JSON_FIELD_STRING, 8, NULL},
+            {"tags", offsetof(struct entity, tags), JSON_FIELD_TOKEN, 0, NULL},
+            {"position", offsetof(struct entity, pos), JSON_FIELD_OBJECT, 0, &vs}};
+        const struct json_field dup[] = {
+            {"hp", 0, JSON_FIELD_INT32, 0, NULL},
+            {"hp", 4, JSON_FIELD_INT32, 0, NULL}};
+        /* same length and first, second and last byte */
+        const struct json_field alike[] = {
+            {"abcd", 0, JSON_FIELD_INT32, 0, NULL},
+            {"abxd", 4, JSON_FIELD_INT32, 0, NULL}};
+
+        test_assert(json_schema_build(&vs, vec, 3));
+        test_assert(json_schema_build(&es, ent, 8));
+        test_assert(!es.full);
+        test_assert(!json_schema_build(&ds, dup, 2));
+        test_assert(json_schema_build(&ds, alike, 2) && ds.full);
+
+        n = sprintf(buf, "{\"entities\": [{\"id\": -9007199254740993, \"mask\": 18446744073709551615,"
+            " \"skip\": {\"id\": 1}, \"hp\": 75, \"speed\": 2.5e1, \"alive\": true,"
+            " \"name\": \"ab\\u00e9cdefg\", \"tags\": [1, 2], \"position\": {\"y\": 2, \"x\": -1.5, \"w\": 0},"
+            " \"id2\": 5, \"speed\": null}]}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        memset(&e, 0, sizeof(e));
+        e.pos.z = 7;
+        test_assert(json_decode_struct(&e, &es, &toks[2], toks[2].sub) == 8);
+        test_assert(e.id == -9007199254740993ll && e.mask == 18446744073709551615ull);
+        test_assert(e.hp == 75 && e.speed == 25.0 && e.alive == 1);
+        test_assert(!strcmp(e.name, "ab\xc3\xa9" "cde"));
+        test_assert(e.tags.type == JSON_ARRAY && e.tags.children == 2);
+        test_assert(e.pos.x == -1.5f && e.pos.y == 2.0f && e.pos.z == 7.0f);
+
+        /* root pairs and mismatched values */
+        n = sprintf(buf, "{\"hp\": 3, \"alive\": false, \"id\": 1.5}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        test_assert(json_decode_struct(&e, &es, toks, p.cnt) == -1);
+        test_assert(e.hp == 3 && e.alive == 0);
+        test_assert(json_decode_struct(&e, &es, toks, 4) == 2);
+        n = sprintf(buf, "{\"hp\": 4294967296}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        test_assert(json_decode_struct(&e, &es, toks, p.cnt) == -1);
+        n = sprintf(buf, "{\"abxd\": 1, \"abcd\": 2, \"abd\": 3}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        test_assert(json_decode_struct(&e, &ds, toks, p.cnt) == 2);
+        test_assert(((int*)(void*)&e)[0] == 2 && ((int*)(void*)&e)[1] == 1);
+    }
+    test_section("decode_struct_full_schema")
+    {
+        int i, n, same;
+        char names[JSON_SCHEMA_MAX_FIELDS][8];
+        char buf[JSON_SCHEMA_MAX_FIELDS * 16];
+        int vals[JSON_SCHEMA_MAX_FIELDS];
+        int ids[JSON_SCHEMA_MAX_FIELDS * 2];
+        int mem[JSON_SCHEMA_MAX_FIELDS * 8];
+        struct json_field fields[JSON_SCHEMA_MAX_FIELDS];
+        struct json_token toks[JSON_SCHEMA_MAX_FIELDS * 2];
+        struct json_parser p;
+        struct json_schema s;
+        struct json_dict d;
+
+        /* as many fields as the schema holds must always find a table */
+        for (i = 0, n = 0; i < JSON_SCHEMA_MAX_FIELDS; ++i) {
+            sprintf(names[i], "f%d", i);
+            fields[i].name = names[i];
+            fields[i].offset = (int)(i * sizeof(int));
+            fields[i].type = JSON_FIELD_INT32;
+            fields[i].size = 0;
+            fields[i].sub = NULL;
+            n += sprintf(buf + n, "%c\"f%d\": %d", i ? ',' : '{', i, i + 1);
+        }
+        buf[n++] = '}';
+        test_assert(json_schema_build(&s, fields, JSON_SCHEMA_MAX_FIELDS));
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = JSON_SCHEMA_MAX_FIELDS * 2;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        memset(vals, 0, sizeof(vals));
+        test_assert(json_decode_struct(vals, &s, toks, p.cnt) == JSON_SCHEMA_MAX_FIELDS);
+        for (i = 0, same = 0; i < JSON_SCHEMA_MAX_FIELDS; ++i)
+            same += vals[i] == i + 1;
+        test_assert(same == JSON_SCHEMA_MAX_FIELDS);
+
+        test_assert(json_dict_init(&d, mem, JSON_SCHEMA_MAX_FIELDS * 8, JSON_SCHEMA_MAX_FIELDS, JSON_SCHEMA_MAX_FIELDS * 4));
+        test_assert(json_schema_bind(&s, &d));
+        test_assert(json_intern(&d, ids, toks, p.cnt, 1) == 0);
+        memset(vals, 0, sizeof(vals));
+        test_assert(json_decode_ids(vals, &s, toks, ids, p.cnt) == JSON_SCHEMA_MAX_FIELDS);
+        for (i = 0, same = 0; i < JSON_SCHEMA_MAX_FIELDS; ++i)
+            same += vals[i] == i + 1;
+        test_assert(same == JSON_SCHEMA_MAX_FIELDS);
+    }
+    test_section("arena")
+    {
+        int i, n, allocs;
+        char buf[1024];
+        struct json_token toks[128];
+        struct json_parser p, q;
+        static struct arena a;
+        const char doc[] = "{\"sub\":{\"a\": \"b\"}, \"list\":[1,2,3,4], \"a\":true}";
+
+        /* tokens come from the arena instead of the caller */
+        memset(&a, 0, sizeof(a));
+        json_parser_init(&p, arena_alloc, arena_grow, &a);
+        test_assert(!json_load(&p, doc, sizeof(doc)-1) && p.err == JSON_OK);
+        test_assert(p.cnt == 12 && (char*)p.toks >= a.buf && (char*)p.toks < a.buf + sizeof(a.buf));
+        test_token(&p.toks[5], "[1,2,3,4]", JSON_ARRAY, 4, 4);
+        test_assert(p.stk == p.base);
+
+        /* reset reuses tokens and stack without asking the arena */
+        allocs = a.allocs;
+        for (i = 0; i < 3; ++i) {
+            json_parser_reset(&p);
+            test_assert(!json_load(&p, doc, sizeof(doc)-1) && p.cnt == 12);
+            json_parser_reset(&p);
+            test_assert(!json_load_tape(&p, doc, sizeof(doc)-1) && p.cnt == 12);
+        } test_assert(a.allocs == allocs);
+
+        /* more tokens than taken so far grow the block */
+        for (n = 0, i = 0; i < 60; ++i)
+            n += sprintf(buf + n, "%s%d", i ? "," : "[", i);
+        buf[n++] = ']';
+        json_parser_reset(&p);
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK && p.cnt == 60);
+        json_parser_reset(&p);
+        test_assert(!json_load_exact(&p, buf, n) && p.cnt == 60 && p.toks[59].str[0] == '5');
+
+        /* deep documents move the stack into the arena */
+        for (n = 0; n < 40; ++n) buf[n] = '[';
+        for (i = 0; i < 40; ++i) buf[n++] = ']';
+        json_parser_reset(&p);
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK && p.cnt == 39);
+        test_assert(p.stk != p.base && p.depth >= 40);
+        test_assert(p.toks[0].sub == 38 && p.toks[38].children == 0);
+
+        /* without arena they are handed to the single pass loader */
+        memset(&q, 0, sizeof(q));
+        q.toks = toks; q.cap = 128;
+        test_assert(!json_load(&q, buf, n) && q.err == JSON_OK && q.cnt == 39);
+        test_assert(q.toks[0].sub == 38 && q.toks[38].children == 0);
+        memset(&q, 0, sizeof(q));
+        while (json_load(&q, buf, n))
+            q.toks = (struct json_token*)realloc(q.toks, (size_t)q.cap * sizeof(struct json_token));
+        test_assert(q.err == JSON_OK && q.cnt == 39);
+        free(q.toks);
+
+        /* exhausted arena */
+        memset(&a, 0, sizeof(a));
+        a.used = (int)sizeof(a.buf) - 64;
+        json_parser_init(&p, arena_alloc, arena_grow, &a);
+        test_assert(json_load(&p, doc, sizeof(doc)-1) == 1 && !p.toks);
+        json_parser_init(&p, arena_alloc, 0, &a);
+        test_assert(json_load_tape(&p, doc, sizeof(doc)-1) == 1 && !p.toks);
+        a.used = (int)sizeof(a.buf) - 8192;
+        for (n = 0, i = 0; i < 300; ++i)
+            buf[n++] = (char)(i ? ',' : '['), buf[n++] = '0';
+        buf[n++] = ']';
+        json_parser_init(&p, arena_alloc, arena_grow, &a);
+        test_assert(json_load(&p, buf, n) == 1 && p.err == JSON_OUT_OF_TOKEN && p.cap == 512);
+        json_parser_reset(&p);
+        test_assert(json_load_tape(&p, buf, n) == 1 && p.err == JSON_OUT_OF_TOKEN && p.cap == 300);
+    }
+    test_section("columns")
+    {
+        int n;
+        char buf[512];
+        json_number t[5] = {-1, -1, -1, -1, -1};
+        json_int id[5] = {0, 0, 0, 0, 0};
+        json_number x[5] = {0, 0, 0, 0, 0};
+        struct json_span tag[5];
+        struct json_token toks[96];
+        struct json_parser p;
+        struct json_column cols[4];
+
+        n = sprintf(buf, "{\"samples\": [{\"t\": 0.5, \"id\": 1, \"tag\": \"a\", \"pos\": {\"x\": 1}},"
+            " {\"t\": 1.5, \"id\": 2, \"tag\": \"b\\\"\", \"pos\": {\"x\": 2}},"
+            " {\"pos\": {\"y\": 0, \"x\": 3}, \"tag\": 5, \"id\": 3.5, \"t\": 2.5},"
+            " 7, {\"t\": null, \"id\": -4, \"t2\": 9}]}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 96;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        memset(cols, 0, sizeof(cols));
+        cols[0].path = "t"; cols[0].type = JSON_COLUMN_NUMBER; cols[0].out = t;
+        cols[1].path = "id"; cols[1].type = JSON_COLUMN_INT; cols[1].out = id;
+        cols[2].path = "tag"; cols[2].type = JSON_COLUMN_SPAN; cols[2].out = tag;
+        cols[3].path = "pos.x"; cols[3].type = JSON_COLUMN_NUMBER; cols[3].out = x;
+        test_assert(json_columns(cols, 4, &toks[1]) == 5);
+        test_assert(cols[0].found == 3 && t[0] == 0.5 && t[1] == 1.5 && t[2] == 2.5);
+        test_assert(t[3] == -1 && t[4] == -1);
+        test_assert(cols[1].found == 3 && id[0] == 1 && id[1] == 2 && id[2] == 0 && id[4] == -4);
+        test_assert(cols[2].found == 2 && tag[1].len == 3 && !memcmp(tag[1].str, "b\\\"", 3));
+        test_assert(cols[3].found == 3 && x[0] == 1 && x[1] == 2 && x[2] == 3);
+        test_assert(cols[0].hint[0] == 0 && cols[3].hint[0] == 0 && cols[3].hint[1] == 1);
+
+        /* invalid paths and non array tokens */
+        cols[0].path = "a..b";
+        test_assert(json_columns(cols, 1, &toks[1]) == -1);
+        cols[0].path = "t";
+        test_assert(json_columns(cols, 1, &toks[2]) == -1);
+        test_assert(json_columns(cols, 0, &toks[1]) == 5);
+    }
+    test_section("image")
+    {
+        int i, n, size, mem[512], moved[512];
+        char buf[256], copy[256], str[64];
+        json_number num;
+        struct json_token toks[64], *ref;
+        struct json_ctoken *ct;
+        struct json_compact c;
+        struct json_parser p;
+        struct json_image_header *h = (struct json_image_header*)(void*)mem;
+        const char *paths[] = {"b.a.b", "b.b[3]", "b.c", "a[1][2]", "a[0].b", "a[6]", "b.x", "a[9]"};
+
+        n = sprintf(buf, "{\"b\": {\"a\": {\"b\":5}, \"b\":[1,2,3,4],"
+            "\"c\":\"te\\\"st\", \"d\":true, \"e\":false, \"f\":null, \"g\":10},"
+            "\"a\": [{\"b\":5}, [1,2,3,4], \"test\", true, false, null, 10]}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+
+        memset(mem, 0, sizeof(mem));
+        size = json_image_write(NULL, 0, toks, p.cnt, buf, n);
+        test_assert(size == (int)sizeof(struct json_image_header) + p.cnt * 16);
+        test_assert(json_image_write(mem, size - 1, toks, p.cnt, buf, n) == size && !mem[0]);
+        test_assert(json_image_write(mem, (int)sizeof(mem), toks, p.cnt, buf, n) == size);
+        test_assert(json_image_write(mem, (int)sizeof(mem), toks, p.cnt, buf, 8) == 0);
+
+        /* image and source moved elsewhere still resolve to the same tokens */
+        memcpy(moved, mem, (size_t)size);
+        memcpy(copy, buf, (size_t)n);
+        test_assert(json_image_open(&c, moved, size, copy, n) == 1);
+        test_assert(c.err == JSON_OK && c.cnt == p.cnt && c.src == copy);
+        for (i = 0; i < c.cnt; ++i) {
+            struct json_token t = json_compact_token(&c, &c.toks[i]);
+            if (t.str - copy != toks[i].str - buf || t.len != toks[i].len ||
+                t.type != toks[i].type || t.children != toks[i].children ||
+                t.sub != toks[i].sub) break;
+        }
+        test_assert(i == c.cnt);
+        for (i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i) {
+            ref = json_query(toks, p.cnt, paths[i]);
+            ct = json_compact_query(&c, c.toks, c.cnt, paths[i]);
+            test_assert(ref ? (ct == c.toks + (ref - toks)) : !ct);
+        }
+        test_assert(json_compact_query_number(&num, &c, c.toks, c.cnt, "b.g") == JSON_NUMBER && num == 10.0);
+        test_assert(json_compact_query_string(str, 64, &i, &c, c.toks, c.cnt, "b.c") == JSON_STRING);
+        test_assert(!strcmp(str, "te\\\"st"));
+        ct = json_compact_array_begin(json_compact_query(&c, c.toks, c.cnt, "a"));
+        for (i = 0; i < 6; ++i)
+            ct = json_compact_array_next(ct);
+        test_assert(json_compact_type(ct) == JSON_NUMBER && ct->len == 2);
+
+        /* stale source, truncated image and foreign headers */
+        copy[n - 3] = '1';
+        test_assert(json_image_open(&c, moved, size, copy, n) == 0);
+        test_assert(c.err == JSON_INVAL && !c.toks && !c.cnt);
+        test_assert(json_image_open(&c, mem, size, buf, n - 1) == 0);
+        test_assert(json_image_open(&c, mem, size - 16, buf, n) == 0);
+        test_assert(json_image_open(&c, mem, 8, buf, n) == 0);
+        h->version++;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 0);
+        h->version--; h->magic = 0x4D49534Au;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 0);
+        h->magic = JSON_IMAGE_MAGIC;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 1);
+
+        /* corrupted tokens are rejected instead of walked */
+        ct = (struct json_ctoken*)(void*)(h + 1);
+        ct[1].sub += 1;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 0);
+        ct[1].sub -= 1; ct[1].info += 16;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 0);
+        ct[1].info -= 16; ct[2].off = n;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 0);
+        ct[2].off = (int)(toks[2].str - buf); ct[2].info = JSON_NUMBER;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 0);
+        ct[2].info = JSON_STRING;
+        test_assert(json_image_open(&c, mem, size, buf, n) == 1);
+
+        /* documents without tokens and a root array */
+        test_assert(json_image_write(mem, (int)sizeof(mem), toks, 0, "{}", 2) == (int)sizeof(*h));
+        test_assert(json_image_open(&c, mem, (int)sizeof(*h), "{}", 2) == 1 && c.cnt == 0);
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        json_load(&p, "[1,[2,3],4]", 11);
+        size = json_image_write(mem, (int)sizeof(mem), toks, p.cnt, "[1,[2,3],4]", 11);
+        test_assert(size > 0 && json_image_write(mem, (int)sizeof(mem), toks, p.cnt, buf, n) == 0);
+        test_assert(json_image_open(&c, mem, size, "[1,[2,3],4]", 11) == 1 && c.cnt == 5);
+    }
+    test_section("dict")
+    {
+        int i, n, len, ids[64], other[64], mem[256];
+        const char *key;
+        char buf[512], name[16];
+        struct entity e, ref;
+        struct json_token toks[64], *obj;
+        struct json_parser p;
+        struct json_dict d;
+        struct json_schema vs, es, ns;
+        const struct json_field speed[] = {
+            {"speed", offsetof(struct entity, speed), JSON_FIELD_NUMBER, 0, NULL}};
+        const struct json_field vec[] = {
+            {"x", offsetof(struct vec3, x), JSON_FIELD_FLOAT, 0, NULL},
+            {"y", offsetof(struct vec3, y), JSON_FIELD_FLOAT, 0, NULL},
+            {"z", offsetof(struct vec3, z), JSON_FIELD_FLOAT, 0, NULL}};
+        const struct json_field ent[] = {
+            {"id", offsetof(struct entity, id), JSON_FIELD_INT, 0, NULL},
+            {"hp", offsetof(struct entity, hp), JSON_FIELD_INT32, 0, NULL},
+            {"name", offsetof(struct entity, name), JSON_FIELD_STRING, 8, NULL},
+            {"position", offsetof(struct entity, pos), JSON_FIELD_OBJECT, 0, &vs}};
+
+        test_assert(json_dict_size(16, 64) == 32 + 48 + 16);
+        test_assert(!json_dict_init(&d, mem, 95, 16, 64));
+        test_assert(json_dict_init(&d, mem, 256, 16, 64));
+        test_assert(json_dict_add(&d, "id", 2) == 0 && json_dict_add(&d, "name", 4) == 1);
+        test_assert(json_dict_add(&d, "id", 2) == 0 && d.cnt == 2 && d.used == 6);
+        test_assert(json_dict_find(&d, "name", 4) == 1 && json_dict_find(&d, "nam", 3) == -1);
+        key = json_dict_key(&d, 1, &len);
+        test_assert(key && len == 4 && !memcmp(key, "name", 4) && !json_dict_key(&d, 2, &len));
+        test_assert(json_dict_add(&d, "", 0) == 2 && json_dict_find(&d, "", 0) == 2);
+
+        /* ids of the same keys match across documents and key orders */
+        n = sprintf(buf, "{\"id\": 1, \"name\": \"a\", \"sub\": {\"name\": \"b\", \"id\": 2},"
+            " \"list\": [{\"id\": 3}, {\"name\": \"id\"}, \"id\"]}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        test_assert(json_intern(&d, ids, toks, p.cnt, 1) == 0);
+        test_assert(ids[0] == 0 && ids[1] == -1 && ids[2] == 1 && ids[3] == -1);
+        test_assert(ids[4] == 3 && ids[5] == -1 && ids[6] == 1 && ids[8] == 0);
+        test_assert(ids[10] == 4 && ids[11] == -1 && ids[13] == 0 && ids[14] == -1);
+        test_assert(ids[16] == 1 && ids[17] == -1 && ids[18] == -1 && d.cnt == 5);
+        test_assert(json_find_id(toks, ids, p.cnt, 1) == &toks[3]);
+        test_assert(json_find_id(toks, ids, p.cnt, 4) == &toks[11]);
+        test_assert(json_find_id(&toks[5], ids + 5, toks[5].sub + 1, 0) == &toks[9]);
+        test_assert(!json_find_id(&toks[5], ids + 5, toks[5].sub + 1, 3));
+        obj = json_query(toks, p.cnt, "list[1]");
+        test_assert(json_find_id(obj, ids + (obj - toks), obj->sub + 1, 1) == obj + 2);
+
+        n = sprintf(buf, "{\"sub\": {}, \"name\": 1, \"extra\": 2, \"id\": 3}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        d.frozen = 1;
+        test_assert(json_intern(&d, other, toks, p.cnt, 1) == 1 && d.cnt == 5);
+        test_assert(other[0] == 3 && other[2] == 1 && other[4] == -1 && other[6] == 0);
+        test_assert(json_dict_add(&d, "extra", 5) == -1);
+        d.frozen = 0;
+
+        /* full dictionaries hand out no more ids */
+        for (i = 0; i < 32; ++i) {
+            sprintf(name, "k%02d", i);
+            if (json_dict_add(&d, name, 3) < 0) break;
+        }
+        test_assert(d.cnt == d.max && i == d.max - 5);
+        test_assert(json_dict_find(&d, "k00", 3) == 5 && json_dict_find(&d, "k10", 3) == 15);
+
+        /* root array elements are values, only keys of nested objects get ids */
+        test_assert(json_dict_init(&d, mem, 256, 16, 64));
+        n = sprintf(buf, "[\"x\", 17, {\"a\": 1}, {\"b\": 2}]");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK && p.cnt == 8);
+        test_assert(json_intern(&d, ids, toks, p.cnt, 0) == 0 && d.cnt == 2);
+        test_assert(ids[0] == -1 && ids[1] == -1 && ids[2] == -1 && ids[5] == -1);
+        test_assert(ids[3] == 0 && ids[6] == 1 && json_dict_find(&d, "x", 1) == -1);
+        /* same tokens as {"p":"q"}, only the caller knows the root */
+        n = sprintf(buf, "[\"p\", \"q\"]");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK && p.cnt == 2);
+        test_assert(json_intern(&d, ids, toks, p.cnt, 0) == 0 && d.cnt == 2);
+        test_assert(ids[0] == -1 && ids[1] == -1 && json_dict_find(&d, "p", 1) == -1);
+        test_assert(json_intern(&d, ids, toks, p.cnt, 1) == 0 && ids[0] == 2 && ids[1] == -1);
+
+        /* schema dispatch by id matches dispatch by name */
+        test_assert(json_dict_init(&d, mem, 256, 16, 64));
+        test_assert(json_schema_build(&vs, vec, 3) && json_schema_build(&es, ent, 4));
+        test_assert(json_schema_bind(&es, &d) && json_schema_bind(&vs, &d) && d.cnt == 7);
+        test_assert(es.id[0] == 0 && es.id[3] == 3 && vs.id[2] == 6);
+        n = sprintf(buf, "{\"e\": {\"name\": \"orc\", \"skip\": {\"id\": 7},"
+            " \"position\": {\"z\": 3, \"x\": -1.5}, \"hp\": 75, \"id\": 12}}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 64;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+        test_assert(json_intern(&d, ids, toks, p.cnt, 1) == 0);
+        memset(&e, 0, sizeof(e));
+        memset(&ref, 0, sizeof(ref));
+        test_assert(json_decode_ids(&e, &es, &toks[1], ids + 1, toks[1].sub + 1) == 4);
+        test_assert(json_decode_struct(&ref, &es, &toks[1], toks[1].sub + 1) == 4);
+        test_assert(!memcmp(&e, &ref, sizeof(e)));
+        test_assert(e.id == 12 && e.hp == 75 && !strcmp(e.name, "orc"));
+        test_assert(e.pos.x == -1.5f && e.pos.y == 0 && e.pos.z == 3);
+        test_assert(json_decode_ids(&e, &es, toks + 2, ids + 2, p.cnt - 2) == 4);
+        toks[15].str = "1.5"; toks[15].len = 3;
+        test_assert(json_decode_ids(&e, &es, &toks[1], ids + 1, toks[1].sub + 1) == -1);
+        d.frozen = 1;
+        test_assert(json_schema_bind(&es, &d));
+        test_assert(json_schema_build(&ns, speed, 1) && !json_schema_bind(&ns, &d) && !ns.dict);
+        test_assert(json_schema_build(&es, ent, 4) && !es.dict);
+        test_assert(json_decode_ids(&e, &es, &toks[1], ids + 1, toks[1].sub + 1) == -1);
+    }
+    test_section("select")
+    {
+        int i, n;
+        char buf[512];
+        struct json_token toks[96];
+        struct json_parser p;
+        struct json_select sel;
+        struct select_log log;
+        const char *bad[] = {"", "a.", "a..", ".a", "...a", "[?]", "[?a=1]", "[?a==]",
+            "[x]", "a[1", "[?a==\"x]", "a[*", "[?a==xyz]", "[*]x", "[?@<]",
+            "a[]", "items[4294967297]", "items[99999999999999999999]"};
+
+        n = sprintf(buf, "{\"entities\": ["
+            "{\"type\": \"npc\", \"name\": \"orc\", \"hp\": 5, \"pos\": {\"x\": 1}},"
+            " {\"type\": \"player\", \"name\": \"hero\", \"hp\": 20},"
+            " {\"type\": \"npc\", \"name\": \"e\\\"lf\", \"hp\": 12e0, \"alive\": true,"
+            " \"items\": [{\"name\": \"bow\", \"hp\": 3}]}],"
+            " \"name\": \"level\", \"scores\": [3, 9, 1, 12, null]}");
+        memset(&p, 0, sizeof(p));
+        p.toks = toks; p.cap = 96;
+        test_assert(!json_load(&p, buf, n) && p.err == JSON_OK);
+
+        test_assert(select_run(&log, toks, p.cnt, "entities[*].name") == 3);
+        test_assert(!strcmp(log.buf, "orc hero e\\\"lf "));
+        test_assert(select_run(&log, toks, p.cnt, "entities.*.name") == 3);
+        test_assert(select_run(&log, toks, p.cnt, "entities[?type==\"npc\"].name") == 2);
+        test_assert(!strcmp(log.buf, "orc e\\\"lf "));
+        test_assert(select_run(&log, toks, p.cnt, "entities[?type!=\"npc\"].hp") == 1);
+        test_assert(!strcmp(log.buf, "20 "));
+        test_assert(select_run(&log, toks, p.cnt, "entities[?name==\"e\\\"lf\"].hp") == 1);
+        test_assert(!strcmp(log.buf, "12e0 "));
+        test_assert(select_run(&log, toks, p.cnt, "..name") == 5);
+        test_assert(!strcmp(log.buf, "orc hero e\\\"lf bow level "));
+        test_assert(select_run(&log, toks, p.cnt, "..[?hp<10].name") == 2);
+        test_assert(!strcmp(log.buf, "orc bow "));
+        test_assert(select_run(&log, toks, p.cnt, "..[?hp==12].type") == 1);
+        test_assert(select_run(&log, toks, p.cnt, "entities[?hp>=12][?alive==true].name") == 0);
+        test_assert(select_run(&log, toks, p.cnt, "entities[?hp>=12].name") == 2);
+        test_assert(!strcmp(log.buf, "hero e\\\"lf "));
+        test_assert(select_run(&log, toks, p.cnt, "entities[?alive==true].items[0].name") == 1);
+        test_assert(select_run(&log, toks, p.cnt, "entities[?pos].pos.x") == 1);
+        test_assert(!strcmp(log.buf, "1 "));
+        test_assert(select_run(&log, toks, p.cnt, "scores[?@>5]") == 2);
+        test_assert(!strcmp(log.buf, "9 12 "));
+        test_assert(select_run(&log, toks, p.cnt, "scores[?@==null]") == 1);
+        test_assert(select_run(&log, toks, p.cnt, "scores[?@!=3]") == 4);
+        test_assert(select_run(&log, toks, p.cnt, "scores[3]") == 1 && !strcmp(log.buf, "12 "));
+        test_assert(select_run(&log, toks, p.cnt, "entities[1].*") == 3);
+        test_assert(!strcmp(log.buf, "player hero 20 "));
+        test_assert(select_run(&log, toks, p.cnt, "*") == 3);
+        test_assert(select_run(&log, toks, p.cnt, "..items..hp") == 1);
+        test_assert(select_run(&log, toks, p.cnt, "..[0]..x") == 1 && !strcmp(log.buf, "1 "));
+        test_assert(select_run(&log, toks, p.cnt, "entities[?name==\"hero\"].hp.x") == 0);
+        test_assert(select_run(&log, toks, p.cnt, "missing[*]") == 0);
+
+        /* exact paths find what json_query finds */
+        test_assert(select_run(&log, toks, p.cnt, "entities[2].items[0].hp") == 1);
+        test_assert(log.buf[0] == '3');
+        test_assert(json_select_compile(&sel, "entities[0]"));
+        test_assert(json_select(toks, p.cnt, &sel, NULL, NULL) == 1);
+
+        /* nonzero from the callback stops the walk */
+        test_assert(json_select_compile(&sel, "..hp"));
+        memset(&log, 0, sizeof(log));
+        log.stop = 2;
+        test_assert(json_select(toks, p.cnt, &sel, select_record, &log) == 2);
+        test_assert(!strcmp(log.buf, "5 20 "));
+        test_assert(json_select(toks, p.cnt, &sel, NULL, NULL) == 4);
+        for (i = 0; i < (int)(sizeof(bad)/sizeof(bad[0])); ++i)
+            test_assert(!json_select_compile(&sel, bad[i]));
+    }
+    test_section("validate")
+    {
+        int i, n;
+        char deep[1200];
+        const char *good[] = {"{}", "[]", "0", "-0.5e+10", "\"\"", " true ", "null",
+            "{\"a\": [1, -2.25E-3, {\"b\": null}], \"c\": \"\\u00e9\\n\\/\"}",
+            "[\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\x7f\"]", "\t[\r\n1 ,2 ]\n",
+            "\"\\ud83d\\ude00\"", "{\"\":{\"\":[[],{}]}}", "123456789012345678901234567890"};
+        const char *bad[] = {"", " ", "{", "}", "[1,]", "{\"a\":1,}", "[1 2]", "{\"a\" 1}",
+            "{\"a\"=1}", "{a:1}", "[01]", "[1.]", "[.5]", "[1e]", "[+1]", "[-]", "[tru]",
+            "[truex]", "[nul]", "[NaN]", "[1]x", "1 2", "[]]", "[\"\\x\"]", "[\"\\u12g4\"]",
+            "[\"\\u12\"]", "[\"a\tb\"]", "[\"\xc0\xaf\"]", "[\"\xed\xa0\x80\"]",
+            "[\"\xf4\x90\x80\x80\"]", "[\"\xe0\x80\xaf\"]", "[\"\xc3\"]", "[\"abc]",
+            "{\"a\":1}{}", "[1,,2]", "{,}", "{\"a\":1 \"b\":2}", "[1]]", "\xef\xbb\xbf{}"};
+
+        for (i = 0; i < (int)(sizeof(good)/sizeof(good[0])); ++i)
+            test_assert(json_validate(good[i], (int)strlen(good[i])) == 1);
+        for (i = 0; i < (int)(sizeof(bad)/sizeof(bad[0])); ++i)
+            test_assert(json_validate(bad[i], (int)strlen(bad[i])) == 0);
+
+        /* the terminator is not part of the document */
+        test_assert(json_validate("[1]", 4) == 0);
+        test_assert(json_validate("[1]\0[2]", 7) == 0);
+        test_assert(json_validate("[1]", 3) == 1 && json_validate("[1]", 2) == 0);
+
+        /* nesting up to JSON_MAX_DEPTH, also across 64 byte blocks */
+        for (n = 0; n < JSON_MAX_DEPTH; ++n) {
+            deep[n] = '[';
+            deep[2 * JSON_MAX_DEPTH - 1 - n] = ']';
+        }
+        test_assert(json_validate(deep, 2 * JSON_MAX_DEPTH) == 1);
+        test_assert(json_validate(deep, 2 * JSON_MAX_DEPTH - 1) == 0);
+        memmove(deep + 1, deep, 2 * JSON_MAX_DEPTH);
+        deep[0] = '[';
+        deep[2 * JSON_MAX_DEPTH + 1] = ']';
+        test_assert(json_validate(deep, 2 * JSON_MAX_DEPTH + 2) == 0);
+
+        /* escapes and UTF-8 sequences split over block boundaries */
+        n = sprintf(deep, "[%60s\"\\u00e9 \xf0\x9f\x98\x80\"]", "");
+        test_assert(json_validate(deep, n) == 1);
+        for (i = 60; i < 66; ++i) {
+            n = sprintf(deep, "[%*s\"\\u00e9\"]", i, "");
+            test_assert(json_validate(deep, n) == 1);
+            n = sprintf(deep, "[%*s\"\\u0z\"]", i, "");
+            test_assert(json_validate(deep, n) == 0);
+            n = sprintf(deep, "[%*s\"\xe2\x82\xac\"]", i, "");
+            test_assert(json_validate(deep, n) == 1);
+            n = sprintf(deep, "[%*s\"\xed\xbf\xbf\"]", i, "");
+            test_assert(json_validate(deep, n) == 0);
+            n = sprintf(deep, "[%*s-12.5e-1]", i, "");
+            test_assert(json_validate(deep, n) == 1);
+        }
     }
     test_result();
     return fail_count;